@@ -14,9 +14,16 @@ public class Cloth : ModuleRules
 		string includePath = Path.Combine(OnnxRuntimePath, "include");
 		PublicIncludePaths.AddRange(new string[] { includePath });
 
+		// 只有 Win64 随插件提供了 ONNX Runtime 与 DirectML 的库，其他平台只编译原生推理后端 (头文件仍用于类型定义)
+		bool bWithOrt = Target.Platform == UnrealTargetPlatform.Win64;
+		PublicDefinitions.Add("WITH_CLOTH_ORT=" + (bWithOrt ? "1" : "0"));
+
 		// 链接ONNX Runtime库文件
 		string libPath = Path.Combine(OnnxRuntimePath, "lib");
-		PublicAdditionalLibraries.Add(Path.Combine(libPath, "onnxruntime.lib"));
+		if (bWithOrt)
+		{
+			PublicAdditionalLibraries.Add(Path.Combine(libPath, "onnxruntime.lib"));
+		}
 
 		//// 配置运行时DLL依赖
 		//RuntimeDependencies.Add(Path.Combine(libPath, "onnxruntime.dll"));
@@ -38,11 +45,11 @@ public class Cloth : ModuleRules
                 "ComputeFramework",
                 "RenderCore",
                 "RHI",
-                "OptimusCore"
+                "OptimusCore",
+                "DeveloperSettings"
 
             }
 			);
-		PublicSystemLibraries.AddRange(new string[] { "dxcore.lib", "directml.lib" });	
 		
 		PrivateDependencyModuleNames.AddRange(
 			new string[]
@@ -62,9 +69,12 @@ public class Cloth : ModuleRules
 				// ... add any modules that your module loads dynamically here ...
 			}
 			);
-        PublicSystemLibraries.Add("dxcore.lib");
-        PublicSystemLibraries.Add("d3d12.lib");
-        PublicSystemLibraries.Add("DirectML.lib");
+		if (bWithOrt)
+		{
+			PublicSystemLibraries.AddRange(new string[] { "dxcore.lib", "directml.lib" });
+			PublicSystemLibraries.Add("d3d12.lib");
+			PublicSystemLibraries.Add("DirectML.lib");
+		}
     }
 
 }
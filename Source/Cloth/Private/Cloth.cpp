@@ -1,6 +1,7 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "Cloth.h"
+#include "OnnxSessionRegistry.h"
 #include "Interfaces/IPluginManager.h"
 #include "HAL/PlatformFilemanager.h"
 
@@ -18,6 +19,7 @@
 
 void FClothModule::StartupModule()
 {
+#if WITH_CLOTH_ORT
 	UE_LOG(LogTemp, Log, TEXT("Cloth module starting - testing ONNX Runtime initialization..."));
 	
 	// 测试ONNX Runtime初始化
@@ -49,13 +51,8 @@ void FClothModule::StartupModule()
 			const OrtApi* ortApi = apiBase->GetApi(ORT_API_VERSION);
 			if (ortApi)
 			{
+				// Env 由 FOnnxSessionRegistry 在第一次创建会话时创建，整个进程共享一个
 				UE_LOG(LogTemp, Log, TEXT("ONNX Runtime API %d available"), ORT_API_VERSION);
-				
-				// 测试环境和会话选项创建
-				Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "ClothModule");
-				Ort::SessionOptions sessionOptions;
-				
-				UE_LOG(LogTemp, Log, TEXT("ONNX Runtime initialization successful!"));
 			}
 			else
 			{
@@ -79,11 +76,17 @@ void FClothModule::StartupModule()
 	{
 		UE_LOG(LogTemp, Error, TEXT("Unknown exception in ONNX Runtime initialization"));
 	}
-
+#else
+	UE_LOG(LogTemp, Log, TEXT("Cloth module starting - ONNX Runtime is not available on this platform, models run on the native backend."));
+#endif
 }
 
 void FClothModule::ShutdownModule()
 {
+#if WITH_CLOTH_ORT
+	FOnnxSessionRegistry::Get().Shutdown();
+#endif
+
 	// 不需要释放DLL句柄 - NNERuntimeORT负责管理
 }
 #undef LOCTEXT_NAMESPACE
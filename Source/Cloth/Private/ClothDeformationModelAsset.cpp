@@ -1,9 +1,72 @@
 // ClothDeformationModelAsset.cpp
 
 #include "ClothDeformationModelAsset.h"
+
+namespace
+{
+    bool IsRecurrentStateName(const FString& Name)
+    {
+        return Name.Contains(TEXT("state"), ESearchCase::IgnoreCase) ||
+               Name.Contains(TEXT("hidden"), ESearchCase::IgnoreCase) ||
+               Name.Contains(TEXT("hx"), ESearchCase::IgnoreCase);
+    }
+}
+
+TArray<FRecurrentStatePair> UClothDeformationModelAsset::GuessRecurrentStatePairs(const TArray<FString>& InputNames, const TArray<FString>& OutputNames)
+{
+    TArray<FString> stateInputs = InputNames.FilterByPredicate(IsRecurrentStateName);
+    TArray<FString> stateOutputs = OutputNames.FilterByPredicate(IsRecurrentStateName);
+
+    TArray<FRecurrentStatePair> pairs;
+    for (int32 i = 0; i < FMath::Min(stateInputs.Num(), stateOutputs.Num()); ++i)
+    {
+        FRecurrentStatePair& pair = pairs.AddDefaulted_GetRef();
+        pair.InputName = stateInputs[i];
+        pair.OutputName = stateOutputs[i];
+    }
+    return pairs;
+}
+
+const TArray<uint8>& UClothDeformationModelAsset::GetModelData(EClothModelPrecision Precision) const
+{
+    switch (Precision)
+    {
+    case EClothModelPrecision::FP16: return fp16ModelData_;
+    case EClothModelPrecision::INT8: return int8ModelData_;
+    default: return modelData_;
+    }
+}
+
+EClothModelPrecision UClothDeformationModelAsset::GetRuntimePrecision() const
+{
+    return GetModelData(runtimePrecision_).Num() > 0 ? runtimePrecision_ : EClothModelPrecision::FP32;
+}
+
+void UClothDeformationModelAsset::Serialize(FArchive& Ar)
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_ModelData);
+    Super::Serialize(Ar);
+}
+
+EClothInferenceBackend UClothDeformationModelAsset::GetInferenceBackend() const
+{
+#if WITH_CLOTH_ORT
+    return inferenceBackend_;
+#else
+    return EClothInferenceBackend::Native;
+#endif
+}
+
 #if WITH_EDITOR
+#include "OnnxSessionRegistry.h"
+#include "OnnxModelInstance.h"
+#include "NativeClothModel.h"
+#include "ClothDeformerStats.h"
+#include "Math/RandomStream.h"
 #include "Misc/Paths.h"
 #include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
 
 // 必须包含ONNX Runtime API才能解析模型。
 #if PLATFORM_WINDOWS && PLATFORM_64BITS
@@ -38,7 +101,11 @@ void UClothDeformationModelAsset::PostEditChangeProperty(FPropertyChangedEvent&
         // 1. Reset State
         inputNodeNames_.Empty();
         outputNodeNames_.Empty();
+        recurrentStatePairs_.Empty();
         modelData_.Empty();
+        fp16ModelData_.Empty();
+        int8ModelData_.Empty();
+        variantAccuracy_.Empty();
 
         if (modelFile_.FilePath.IsEmpty())
         {
@@ -69,7 +136,20 @@ void UClothDeformationModelAsset::PostEditChangeProperty(FPropertyChangedEvent&
         {
             inputNodeNames_ = Metadata.InputNames;
             outputNodeNames_ = Metadata.OutputNames;
-            UE_LOG(LogTemp, Log, TEXT("Metadata parsed. Inputs: %d, Outputs: %d"), inputNodeNames_.Num(), outputNodeNames_.Num());
+            recurrentStatePairs_ = GuessRecurrentStatePairs(inputNodeNames_, outputNodeNames_);
+            UE_LOG(LogTemp, Log, TEXT("Metadata parsed. Inputs: %d, Outputs: %d, Recurrent pairs: %d"), inputNodeNames_.Num(), outputNodeNames_.Num(), recurrentStatePairs_.Num());
+
+#if WITH_CLOTH_ORT
+            // 导入时就生成优化模型缓存，运行时创建会话不再做图优化
+            FOnnxSessionRegistry::Get().WarmOptimizedModelCache(this);
+#endif
+
+            // 精度变体与 FP32 共用输入输出名，导入后立即报告它们的误差
+            LoadVariantModels(AbsolutePath);
+            if (fp16ModelData_.Num() > 0 || int8ModelData_.Num() > 0)
+            {
+                ValidateModelVariants();
+            }
         }
 
         // 标记资产已修改 (Dirty)，这样左上角会有小星号，提示保存
@@ -95,6 +175,7 @@ void UClothDeformationModelAsset::LoadModelData()
     }
 
     // 读取文件
+    LLM_SCOPE_BYTAG(ClothDeformer_ModelData);
     TArray<uint8> TempData;
     if (FFileHelper::LoadFileToArray(TempData, *AbsolutePath))
     {
@@ -116,6 +197,7 @@ void UClothDeformationModelAsset::LoadModelData()
 }
 TArray<uint8> UClothDeformationModelAsset::LoadModelBytes(const FString& FilePath)
 {
+    LLM_SCOPE_BYTAG(ClothDeformer_ModelData);
     TArray<uint8> ResultData;
     if (!FFileHelper::LoadFileToArray(ResultData, *FilePath))
     {
@@ -126,6 +208,206 @@ TArray<uint8> UClothDeformationModelAsset::LoadModelBytes(const FString& FilePat
     return ResultData;
 }
 
+void UClothDeformationModelAsset::LoadVariantModels(const FString& ModelFilePath)
+{
+    // FP16 与动态量化 INT8 变体由离线工具生成 (如 onnxconverter_common.float16 与 onnxruntime.quantization.quantize_dynamic)
+    const FString basePath = FPaths::Combine(FPaths::GetPath(ModelFilePath), FPaths::GetBaseFilename(ModelFilePath));
+    const FString fp16Path = basePath + TEXT(".fp16.onnx");
+    const FString int8Path = basePath + TEXT(".int8.onnx");
+
+    fp16ModelData_ = FPaths::FileExists(fp16Path) ? LoadModelBytes(fp16Path) : TArray<uint8>();
+    int8ModelData_ = FPaths::FileExists(int8Path) ? LoadModelBytes(int8Path) : TArray<uint8>();
+    UE_LOG(LogTemp, Log, TEXT("Model variants: FP16 %d bytes, INT8 %d bytes"), fp16ModelData_.Num(), int8ModelData_.Num());
+}
+
+void UClothDeformationModelAsset::ValidateModelVariants()
+{
+    variantAccuracy_.Reset();
+
+    FOnnxModelInstance reference(this, EClothModelPrecision::FP32);
+    if (!reference.IsInitialized())
+    {
+        UE_LOG(LogTemp, Error, TEXT("ValidateModelVariants: Failed to create the FP32 reference instance"));
+        return;
+    }
+
+    // 固定种子生成验证输入集，符号维度都取 1，FP32 与各变体使用完全相同的数据
+    constexpr int32 NumSamples = 32;
+    FRandomStream random(0x5EED);
+    const int32 numInputs = reference.GetInputSlots().Num();
+    const int32 numOutputs = reference.GetOutputSlots().Num();
+
+    TArray<TArray<TArray<float>>> samples;
+    samples.SetNum(NumSamples);
+    for (TArray<TArray<float>>& sample : samples)
+    {
+        sample.SetNum(numInputs);
+        for (int32 i = 0; i < numInputs; ++i)
+        {
+            sample[i].SetNumUninitialized(static_cast<int32>(reference.GetDefaultElementCount(i)));
+            for (float& value : sample[i])
+            {
+                value = random.FRandRange(-0.5f, 0.5f);
+            }
+        }
+    }
+
+    // 依次运行所有样本，返回每个样本的平均耗时 (毫秒)，失败时返回负数
+    auto RunSamples = [&samples, numOutputs](FOnnxModelInstance& Instance, TArray<TArray<TArray<float>>>& OutOutputs) -> float
+    {
+        for (int32 symbol = 0; symbol < Instance.GetDimSymbols().Num(); ++symbol)
+        {
+            Instance.BindDimSymbol(symbol, 1);
+        }
+
+        OutOutputs.SetNum(samples.Num());
+        TArray<TConstArrayView<float>, TInlineAllocator<8>> views;
+        double elapsedSeconds = 0.0;
+        for (int32 s = 0; s < samples.Num(); ++s)
+        {
+            views.Reset();
+            for (const TArray<float>& input : samples[s])
+            {
+                views.Add(input);
+            }
+            OutOutputs[s].SetNum(numOutputs);
+
+            // 第一个样本同时作为预热，不计时
+            const double startSeconds = FPlatformTime::Seconds();
+            if (!Instance.Run(views, OutOutputs[s]))
+            {
+                return -1.0f;
+            }
+            elapsedSeconds += s > 0 ? FPlatformTime::Seconds() - startSeconds : 0.0;
+        }
+        return samples.Num() > 1 ? static_cast<float>(elapsedSeconds * 1000.0 / (samples.Num() - 1)) : 0.0f;
+    };
+
+    TArray<TArray<TArray<float>>> referenceOutputs;
+    const float referenceMs = RunSamples(reference, referenceOutputs);
+    if (referenceMs < 0.0f)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ValidateModelVariants: FP32 reference failed on the validation inputs"));
+        return;
+    }
+
+    for (EClothModelPrecision precision : { EClothModelPrecision::FP16, EClothModelPrecision::INT8 })
+    {
+        if (GetModelData(precision).Num() == 0)
+        {
+            continue;
+        }
+
+        const FString precisionName = StaticEnum<EClothModelPrecision>()->GetNameStringByValue(static_cast<int64>(precision));
+        FOnnxModelInstance variant(this, precision);
+        TArray<TArray<TArray<float>>> variantOutputs;
+        const float variantMs = variant.IsInitialized() ? RunSamples(variant, variantOutputs) : -1.0f;
+        if (variantMs < 0.0f)
+        {
+            UE_LOG(LogTemp, Error, TEXT("ValidateModelVariants: %s variant failed on the validation inputs"), *precisionName);
+            continue;
+        }
+
+        double maxAbsError = 0.0;
+        double sumSquaredError = 0.0;
+        int64 numElements = 0;
+        for (int32 s = 0; s < NumSamples; ++s)
+        {
+            for (int32 o = 0; o < numOutputs; ++o)
+            {
+                const TArray<float>& expected = referenceOutputs[s][o];
+                const TArray<float>& actual = variantOutputs[s][o];
+                if (expected.Num() != actual.Num())
+                {
+                    UE_LOG(LogTemp, Error, TEXT("ValidateModelVariants: %s output %d has %d elements, FP32 has %d"), *precisionName, o, actual.Num(), expected.Num());
+                    return;
+                }
+                for (int32 k = 0; k < expected.Num(); ++k)
+                {
+                    const double error = FMath::Abs(static_cast<double>(actual[k]) - expected[k]);
+                    maxAbsError = FMath::Max(maxAbsError, error);
+                    sumSquaredError += error * error;
+                }
+                numElements += expected.Num();
+            }
+        }
+
+        FModelVariantAccuracy& accuracy = variantAccuracy_.AddDefaulted_GetRef();
+        accuracy.Precision = precision;
+        accuracy.MaxAbsError = static_cast<float>(maxAbsError);
+        accuracy.RmsError = numElements > 0 ? static_cast<float>(FMath::Sqrt(sumSquaredError / numElements)) : 0.0f;
+        accuracy.Fp32Milliseconds = referenceMs;
+        accuracy.VariantMilliseconds = variantMs;
+        UE_LOG(LogTemp, Log, TEXT("%s vs FP32 on %d samples: max abs error %g, RMS error %g, %.3f ms vs %.3f ms (%.2fx)"),
+            *precisionName, NumSamples, accuracy.MaxAbsError, accuracy.RmsError, variantMs, referenceMs, variantMs > 0.0f ? referenceMs / variantMs : 0.0f);
+    }
+
+    MarkPackageDirty();
+}
+
+void UClothDeformationModelAsset::GenerateNativeEvaluator()
+{
+    FString error;
+    TSharedPtr<const FNativeClothModel, ESPMode::ThreadSafe> model = FNativeClothModel::Acquire(modelData_, error);
+    if (!model)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GenerateNativeEvaluator: %s cannot be imported by the native backend: %s"), *GetName(), *error);
+        return;
+    }
+
+    // 动态维度取 1，与验证输入集和实例的默认元素数一致
+    TArray<TArray<int64>> inputShapes;
+    for (const FNativeTensorInfo& input : model->GetInputs())
+    {
+        TArray<int64>& shape = inputShapes.AddDefaulted_GetRef();
+        for (int64 dim : input.Shape)
+        {
+            shape.Add(dim > 0 ? dim : 1);
+        }
+    }
+
+    FString name = GetName();
+    for (TCHAR& character : name)
+    {
+        character = FChar::IsAlnum(character) ? character : TEXT('_');
+    }
+    const FString className = FString::Printf(TEXT("FClothEvaluator_%s_%08X"), *name, model->GetDataCrc());
+
+    FString source;
+    if (!model->GenerateEvaluatorSource(className, inputShapes, source, error))
+    {
+        UE_LOG(LogTemp, Error, TEXT("GenerateNativeEvaluator: Failed to generate an evaluator for %s: %s"), *GetName(), *error);
+        return;
+    }
+
+    const TSharedPtr<IPlugin> plugin = IPluginManager::Get().FindPlugin(TEXT("Cloth"));
+    if (!plugin)
+    {
+        UE_LOG(LogTemp, Error, TEXT("GenerateNativeEvaluator: Cloth plugin not found"));
+        return;
+    }
+    // 同一资产只保留一份，模型数据变化后旧文件按名字被覆盖
+    const FString directory = FPaths::Combine(plugin->GetBaseDir(), TEXT("Source"), TEXT("Cloth"), TEXT("Private"), TEXT("Generated"));
+    TArray<FString> staleFiles;
+    IFileManager::Get().FindFiles(staleFiles, *FPaths::Combine(directory, FString::Printf(TEXT("FClothEvaluator_%s_*.cpp"), *name)), true, false);
+    for (const FString& staleFile : staleFiles)
+    {
+        // 名字相同、只有 CRC 不同的文件 (前缀相同的其他资产名字更长)
+        if (staleFile.Len() == className.Len() + 4)
+        {
+            IFileManager::Get().Delete(*FPaths::Combine(directory, staleFile));
+        }
+    }
+
+    const FString filePath = FPaths::Combine(directory, className + TEXT(".cpp"));
+    if (!FFileHelper::SaveStringToFile(source, *filePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+    {
+        UE_LOG(LogTemp, Error, TEXT("GenerateNativeEvaluator: Failed to write %s"), *filePath);
+        return;
+    }
+    UE_LOG(LogTemp, Log, TEXT("GenerateNativeEvaluator: Wrote %s (model CRC %08X), rebuild the Cloth module to use it"), *filePath, model->GetDataCrc());
+}
+
 UClothDeformationModelAsset::FOnnxMetadata UClothDeformationModelAsset::ParseModelMetadata(const TArray<uint8>& InModelData)
 {
     FOnnxMetadata Metadata;
@@ -134,17 +416,19 @@ UClothDeformationModelAsset::FOnnxMetadata UClothDeformationModelAsset::ParseMod
         return Metadata;
     }
 
+#if WITH_CLOTH_ORT
     try
     {
-        // 创建临时环境和会话
-        Ort::Env TempEnv(ORT_LOGGING_LEVEL_WARNING, "ModelAsset_Editor_Parse");
+        // 使用进程共享的环境创建临时会话
+        Ort::Env& SharedEnv = FOnnxSessionRegistry::Get().GetEnv();
         Ort::SessionOptions SessionOptions;
+        FOnnxSessionRegistry::Get().ApplyThreadingOptions(SessionOptions, nullptr);
 
         // 从内存创建 Session
         // 注意：Ort::Session 构造函数不接受 const void*，只接受 void* (虽然它可能只读)
         // 我们需要 const_cast，这是安全的，因为我们只读元数据
         void* DataPtr = const_cast<uint8*>(InModelData.GetData());
-        Ort::Session TempSession(TempEnv, DataPtr, InModelData.Num(), SessionOptions);
+        Ort::Session TempSession(SharedEnv, DataPtr, InModelData.Num(), SessionOptions);
         Ort::AllocatorWithDefaultOptions Allocator;
 
         // 输入节点
@@ -172,6 +456,27 @@ UClothDeformationModelAsset::FOnnxMetadata UClothDeformationModelAsset::ParseMod
     {
          UE_LOG(LogTemp, Error, TEXT("Standard exception parsing ONNX metadata: %s"), UTF8_TO_TCHAR(e.what()));
     }
+#else
+    // 没有 ONNX Runtime 时直接读取图的签名
+    TArray<FNativeTensorInfo> Inputs;
+    TArray<FNativeTensorInfo> Outputs;
+    FString Error;
+    if (!FNativeClothModel::ReadGraphSignature(InModelData, Inputs, Outputs, Error))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to parse ONNX metadata. ERROR: %s"), *Error);
+        return Metadata;
+    }
+    for (const FNativeTensorInfo& Input : Inputs)
+    {
+        Metadata.InputNames.Add(Input.Name);
+    }
+    for (const FNativeTensorInfo& Output : Outputs)
+    {
+        Metadata.OutputNames.Add(Output.Name);
+    }
+    Metadata.bIsValid = true;
+    UE_LOG(LogTemp, Log, TEXT("Successfully parsed metadata."));
+#endif
 
     return Metadata;
 }
@@ -1,9 +1,14 @@
 #include "ClothDeformerComponent.h"
 #include "OnnxModelInstance.h"
+#include "OnnxBatchRunner.h"
 #include "MeshMappingAsset.h"
+#include "ClothDeformerSubsystem.h"
+#include "SnugInputAdapter.h"
+#include "ClothDeformerStats.h"
 #include "Interfaces/IPluginManager.h"
 #include "HAL/PlatformFilemanager.h"
 #include "Components/DynamicMeshComponent.h"
+#include "Misc/ScopeExit.h"
 
 
 // 包含ONNX Runtime头文件用于测试
@@ -23,17 +28,70 @@
 // (included from OnnxModelInstance.h) before it tries to generate the code to destroy the modelInstance_ member.
 UClothDeformerComponent::~UClothDeformerComponent()
 {
-    // Intentionally empty. The key is that this definition exists here in the .cpp file.
+    // 后台推理仍在使用模型实例时先等它结束
+    WaitForAsyncInference();
 }
 
 UClothDeformerComponent::UClothDeformerComponent()
 {
     // 启用Tick，以便每帧运行
     PrimaryComponentTick.bCanEverTick = true;
+
+    // AsyncSameFrame 模式在本帧较晚的 Tick 组中取回推理结果
+    InferenceCompleteTick.bCanEverTick = true;
+    InferenceCompleteTick.bStartWithTickEnabled = true;
+    InferenceCompleteTick.TickGroup = TG_PostUpdateWork;
+}
+
+void UClothDeformerComponent::RegisterComponentTickFunctions(bool bRegister)
+{
+    Super::RegisterComponentTickFunctions(bRegister);
+
+    if (bRegister)
+    {
+        if (SetupActorComponentTickFunction(&InferenceCompleteTick))
+        {
+            InferenceCompleteTick.Target = this;
+            InferenceCompleteTick.AddPrerequisite(this, PrimaryComponentTick);
+        }
+    }
+    else if (InferenceCompleteTick.IsTickFunctionRegistered())
+    {
+        InferenceCompleteTick.UnRegisterTickFunction();
+    }
+}
+
+void UClothDeformerComponent::BeginDestroy()
+{
+    Super::BeginDestroy();
+
+    // 后台推理会继续提交渲染命令，先等它结束再插入栅栏
+    WaitForAsyncInference();
+    ReleaseFence.BeginFence();
+}
+
+bool UClothDeformerComponent::IsReadyForFinishDestroy()
+{
+    return Super::IsReadyForFinishDestroy() && ReleaseFence.IsFenceComplete();
+}
+
+void FClothInferenceCompleteTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+    if (Target && IsValid(Target) && Target->InferenceMode == EClothInferenceMode::AsyncSameFrame)
+    {
+        Target->CompleteAsyncInference(true);
+    }
+}
+
+FString FClothInferenceCompleteTickFunction::DiagnosticMessage()
+{
+    return Target ? Target->GetFullName() + TEXT("[CompleteInference]") : TEXT("<NULL>[CompleteInference]");
 }
 void UClothDeformerComponent::BeginPlay()
 {
     Super::BeginPlay();
+    BeginPlaySeconds = FPlatformTime::Seconds();
+    FirstInferenceLatencyMs = -1.0f;
 
     // 尝试初始化ONNX模型
     UE_LOG(LogTemp, Log, TEXT("Cloth Deformer Component BeginPlay - attempting to initialize model..."));
@@ -50,6 +108,7 @@ void UClothDeformerComponent::BeginPlay()
 void UClothDeformerComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
     // 清理资源
+    WaitForAsyncInference();
     modelInstance_.Reset();
 
     Super::EndPlay(EndPlayReason);
@@ -65,6 +124,7 @@ uint32 UClothDeformerComponent::GetVertexCount() const
 }
 bool UClothDeformerComponent::Initialize()
 {
+    WaitForAsyncInference();
     try
     {
         if (modelAsset_)
@@ -82,6 +142,12 @@ bool UClothDeformerComponent::Initialize()
         if (modelInstance_ && modelInstance_->IsInitialized())
         {
             UE_LOG(LogTemp, Log, TEXT("ONNX Model Instance created successfully"));
+            if (!BindModelSlots())
+            {
+                modelInstance_.Reset();
+                bIsInitialized = false;
+                return false;
+            }
             bIsInitialized = true;
             return true;
         }
@@ -112,6 +178,8 @@ bool UClothDeformerComponent::RunInference(const TArray<float> &InputData, TArra
 
     if (!modelInstance_)
         return false;
+    // 模型实例的复用缓冲不能与后台推理同时使用
+    WaitForAsyncInference();
     return modelInstance_->Run(InputData, OutputData);
 }
 bool UClothDeformerComponent::RunInference(const TMap<FString, TArray<float>>& InputData, TArray<float>& HiddenState, TMap<FString, TArray<float>>& OutputData)
@@ -124,8 +192,15 @@ bool UClothDeformerComponent::RunInference(const TMap<FString, TArray<float>>& I
 
     if (!modelInstance_)
         return false;
+    // 模型实例的复用缓冲不能与后台推理同时使用
+    WaitForAsyncInference();
     return modelInstance_->Run(InputData,HiddenState, OutputData);
 }
+int64 UClothDeformerComponent::GetInferenceAllocationCount() const
+{
+    return (modelInstance_ ? static_cast<int64>(modelInstance_->GetAllocationCount()) : 0) + HandoffAllocationCount;
+}
+
 bool UClothDeformerComponent::IsInitialized() const
 {
     return bIsInitialized && modelInstance_ && modelInstance_->IsInitialized();
@@ -133,6 +208,7 @@ bool UClothDeformerComponent::IsInitialized() const
 
 void UClothDeformerComponent::Reset()
 {
+    WaitForAsyncInference();
     modelInstance_.Reset();
     bIsInitialized = false;
     UE_LOG(LogTemp, Log, TEXT("ONNX Component reset"));
@@ -159,93 +235,356 @@ void UClothDeformerComponent::TickComponent(float DeltaTime, ELevelTick TickType
     //    }
     //}
 
-    // 1. 获取输入
-    TMap<FString, TArray<float>> ModelInputs = InputAdapter->ExtractInputs(DeltaTime);
+    if (!IsInitialized() || !InputAdapter)
+    {
+        return;
+    }
+
+    CLOTH_DEFORMER_SCOPE(Tick);
+    ClothDeformerStats::AddCharacter();
 
+    // 流水线：先取回上一帧发起的后台推理 (通常已经完成)，之后才能覆写它使用的输入输出缓冲
+    CompleteAsyncInference();
 
-    // 2. 运行推理 (拿到低模偏移)
-    TMap<FString, TArray<float>> ModelOutputs; // 也可以是称为 低模映射
-    if (!RunInference(ModelInputs, CurrentHiddenState, ModelOutputs))
+    // 1. 获取输入：直接写入模型实例的持久输入缓冲，否则按槽位写入复用的数组
+    const bool bInputsReady = bAdapterWritesModelBuffers
+        ? InputAdapter->WriteInputs(DeltaTime, AdapterInputViews)
+        : InputAdapter->ExtractInputs(DeltaTime, AdapterInputs);
+    if (!bInputsReady)
+    {
+        return;
+    }
+
+    // 异步模式：游戏线程到此为止，推理在后台进行，结果在下一帧 Tick 或本帧 TG_PostUpdateWork 中应用
+    if (InferenceMode != EClothInferenceMode::Synchronous)
+    {
+        LaunchAsyncInference();
+        return;
+    }
+
+    // 共享模型资产的组件交给子系统，在本帧 TG_PostUpdateWork 之前沿 batch 维合并为一次推理
+    if (bBatchInferenceWithSharedAsset && FOnnxBatchRunner::SupportsBatching(*modelInstance_))
+    {
+        if (UClothDeformerSubsystem* subsystem = GetWorld() ? GetWorld()->GetSubsystem<UClothDeformerSubsystem>() : nullptr)
+        {
+            subsystem->QueueInference(this);
+            return;
+        }
+    }
+
+    TArray<TConstArrayView<float>, TInlineAllocator<8>> modelInputs;
+    GatherModelInputs(modelInputs);
+
+    // 2. 运行推理 (拿到低模偏移)：输入输出都通过 IoBinding 绑定到持久缓冲，稳态下不做堆分配
+    if (!modelInstance_->RunWithBinding(modelInputs, ModelOutputs))
     {
         // 推理失败，保持当前姿态，直接退出
         return;
     }
 
-    TArray<float> lowResRawOffsets;
+    ApplyModelOutputs();
+}
+
+void UClothDeformerComponent::LaunchAsyncInference()
+{
+    check(!InferenceTask.IsValid());
+
+    GatherModelInputs(AsyncModelInputs);
+    bAsyncInferenceSucceeded = false;
+
+    // 共享会话可以被多个线程同时 Run，IoBinding 与输出缓冲属于本组件的实例，任务之间互不干扰
+    InferenceTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+        {
+            bAsyncInferenceSucceeded = modelInstance_->RunWithBinding(AsyncModelInputs, ModelOutputs);
+        });
+}
 
-    for (const auto& pair : ModelOutputs)
+void UClothDeformerComponent::CompleteAsyncInference(bool bAfterSubsystemTick)
+{
+    if (!InferenceTask.IsValid())
     {
-        lowResRawOffsets = pair.Value;
-        break;
+        return;
     }
 
-    int32 numLowResVerts = lowResRawOffsets.Num() / 3;
-    TArray<FVector> lowResVectors;
-    lowResVectors.SetNumUninitialized(numLowResVerts);
+    InferenceTask.Wait();
+    InferenceTask = UE::Tasks::FTask();
+
+    // 映射与上传仍经由 UpdateMesh 交给渲染线程；子系统本帧已 Tick 时不再进它的批量映射队列，否则要到下一帧才提交
+    if (bAsyncInferenceSucceeded)
+    {
+        ApplyModelOutputs(!bAfterSubsystemTick);
+    }
+}
+
+void UClothDeformerComponent::WaitForAsyncInference()
+{
+    if (InferenceTask.IsValid())
+    {
+        InferenceTask.Wait();
+        InferenceTask = UE::Tasks::FTask();
+    }
+}
+
+FOnnxBatchItem UClothDeformerComponent::MakeBatchInferenceItem(TArray<TConstArrayView<float>, TInlineAllocator<8>>& OutInputViews)
+{
+    GatherModelInputs(OutInputViews);
+    return { modelInstance_.Get(), OutInputViews, ModelOutputs };
+}
+
+void UClothDeformerComponent::CompleteBatchedInference(const FOnnxBatchItem& Item, bool bBatched)
+{
+    if (bBatched || modelInstance_->RunWithBinding(Item.Inputs, ModelOutputs))
+    {
+        ApplyModelOutputs();
+    }
+}
+
+void UClothDeformerComponent::GatherModelInputs(TArray<TConstArrayView<float>, TInlineAllocator<8>>& OutInputs) const
+{
+    // 循环状态由模型实例自己持有并轮换，对应槽位传空视图
+    OutInputs.Reset();
+    for (const int32 source : ModelInputSources)
+    {
+        if (source == INDEX_NONE)
+        {
+            OutInputs.Add(TConstArrayView<float>());
+        }
+        else
+        {
+            OutInputs.Add(bAdapterWritesModelBuffers ? TConstArrayView<float>(AdapterInputViews[source]) : TConstArrayView<float>(AdapterInputs[source]));
+        }
+    }
+}
 
-    for (int32 i = 0; i < numLowResVerts; ++i)
+void UClothDeformerComponent::ApplyModelOutputs(bool bAllowBatchedMapping)
+{
+    if (FirstInferenceLatencyMs < 0.0f && BeginPlaySeconds > 0.0)
     {
-        // 可能需要在这里做坐标系转换
-        lowResVectors[i] = FVector(
-            lowResRawOffsets[i * 3 + 0], // X
-            lowResRawOffsets[i * 3 + 1], // Y
-            lowResRawOffsets[i * 3 + 2]  // Z
-        );
+        FirstInferenceLatencyMs = static_cast<float>((FPlatformTime::Seconds() - BeginPlaySeconds) * 1000.0);
+        UE_LOG(LogTemp, Log, TEXT("%s: BeginPlay to first inference took %.2f ms"), *GetOwner()->GetName(), FirstInferenceLatencyMs);
     }
 
-    // 3. 映射到高模
-    TArray<FVector> HighResOffsets;
-    
-    if (!MappingAsset->MappingData.ApplyMapping(lowResVectors,HighResOffsets))
+    if (!MappingAsset || OffsetOutputSlot == INDEX_NONE)
     {
-        UE_LOG(LogTemp, Error, TEXT("Tick: ApplyMapping 失败"));
         return;
     }
-    
+
+    // 3. 映射到高模：在渲染线程上直接写入上传缓冲。
+    // 模型输出即交错的 float3 低模偏移，直接交给单精度映射路径；输出缓冲绑定在模型上，由 UpdateMesh 拷入交接缓冲
     USkeletalMeshComponent* targetMesh = GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
     if (targetMesh)
     {
-        UpdateMesh(targetMesh, HighResOffsets);
+        UpdateMesh(targetMesh, ModelOutputs[OffsetOutputSlot], bAllowBatchedMapping);
+    }
+}
+
+bool UClothDeformerComponent::BindModelSlots()
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+    if (!InputAdapter)
+    {
+        InputAdapter = MakeUnique<FSnugInputAdapter>();
+    }
+    InputAdapter->Initialize(GetOwner() ? GetOwner()->FindComponentByClass<USkeletalMeshComponent>() : nullptr);
+
+    const TArray<FString>& adapterNames = InputAdapter->GetInputNames();
+    AdapterInputs.SetNum(adapterNames.Num());
+
+    // 模型输入按名字绑定到适配器槽位，循环状态输入由模型实例提供
+    ModelInputSources.Reset();
+    for (const FOnnxTensorSlot& slot : modelInstance_->GetInputSlots())
+    {
+        const int32 source = adapterNames.IndexOfByKey(slot.Name);
+        if (source == INDEX_NONE && slot.RecurrentPair == INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Model input %s is neither provided by the input adapter nor declared as recurrent state"), *slot.Name);
+            return false;
+        }
+        ModelInputSources.Add(source);
+    }
+
+    // 模型输入都是定长时，适配器直接写入模型实例的持久输入缓冲，张量在第一次推理时包装一次后每帧沿用
+    AdapterInputViews.Reset();
+    AdapterInputViews.SetNum(adapterNames.Num());
+    bAdapterWritesModelBuffers = true;
+    for (int32 i = 0; i < ModelInputSources.Num(); ++i)
+    {
+        const int32 source = ModelInputSources[i];
+        if (source != INDEX_NONE)
+        {
+            AdapterInputViews[source] = modelInstance_->GetInputBuffer(i);
+            bAdapterWritesModelBuffers &= !AdapterInputViews[source].IsEmpty();
+        }
+    }
+
+    const TArray<FOnnxTensorSlot>& outputSlots = modelInstance_->GetOutputSlots();
+    OffsetOutputSlot = outputSlots.IndexOfByPredicate([](const FOnnxTensorSlot& Slot) { return Slot.RecurrentPair == INDEX_NONE; });
+    ModelOutputs.SetNum(outputSlots.Num());
+    return true;
+}
+
+FVector3f* UClothDeformerComponent::LockOffsetBuffer_RenderThread(FRHICommandListImmediate& RHICmdList, int32 NumVertices)
+{
+    check(IsInRenderingThread());
+
+    const uint32 BufferSize = NumVertices * sizeof(FVector3f);
+    if (!OffsetBuffer.IsValid() || OffsetBuffer->GetSize() != BufferSize)
+    {
+        LLM_SCOPE_BYTAG(ClothDeformer_GpuBuffers);
+        FRHIBufferCreateDesc BufferDesc = FRHIBufferCreateDesc::Create(TEXT("MLClothOffsetBuffer"), BufferSize, sizeof(FVector3f), BUF_ShaderResource | BUF_Dynamic | BUF_StructuredBuffer);
+        BufferDesc.SetInitialState(ERHIAccess::SRVMask);
+        // BUF_ShaderResource 允许 Shader 读取，BUF_Dynamic 表示我们会频繁(每帧)更新它
+
+        OffsetBuffer = RHICmdList.CreateBuffer(BufferDesc);
+        // 为这块内存创建 SRV 视图
+        OffsetBufferSRV = RHICmdList.CreateShaderResourceView(OffsetBuffer, FRHIViewDesc::CreateBufferSRV()
+            .SetTypeFromBuffer(OffsetBuffer));
     }
+
+    INC_DWORD_STAT_BY(STAT_ClothDeformer_BytesUploaded, BufferSize);
+
+    // Dynamic 缓冲以 WriteOnly 锁定时，RHI 从其上传池中分配一块 CPU 可写内存，解锁后由 GPU 直接读取
+    return static_cast<FVector3f*>(RHICmdList.LockBuffer(OffsetBuffer, 0, BufferSize, RLM_WriteOnly));
 }
 
-void UClothDeformerComponent::UpdateMesh(USkeletalMeshComponent* targetMesh, const TArray<FVector>& HighResOffsets)
+int32 UClothDeformerComponent::AcquireLowResHandoff(TConstArrayView<float> LowResOffsets)
 {
-    
-    if (HighResOffsets.Num() == 0 || !targetMesh)
+    const int32 slotIndex = NextLowResHandoffSlot;
+    FLowResHandoffSlot& slot = LowResHandoffSlots[slotIndex];
+    if (slot.bInFlight.load(std::memory_order_acquire))
+    {
+        return INDEX_NONE;
+    }
+    NextLowResHandoffSlot = (slotIndex + 1) % NumLowResHandoffSlots;
+
+    const float* previousData = slot.Offsets.GetData();
+    {
+        LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+        slot.Offsets.SetNumUninitialized(LowResOffsets.Num(), EAllowShrinking::No);
+    }
+    if (slot.Offsets.GetData() != previousData)
+    {
+        ++HandoffAllocationCount;
+    }
+    FMemory::Memcpy(slot.Offsets.GetData(), LowResOffsets.GetData(), LowResOffsets.Num() * sizeof(float));
+
+    // 之后提交的渲染命令 (或子系统的批量命令) 负责归还
+    slot.bInFlight.store(true, std::memory_order_relaxed);
+    return slotIndex;
+}
+
+void UClothDeformerComponent::CancelQueuedMapping(int32 HandoffSlot)
+{
+    ReleaseLowResHandoff(HandoffSlot);
+}
+
+FMappingBatchItem UClothDeformerComponent::BeginBatchedUpload_RenderThread(FRHICommandListImmediate& RHICmdList, const FSparseMappingMatrix& MappingData, int32 HandoffSlot)
+{
+    const int32 numVertices = MappingData.NumRow;
+    FVector3f* lockedData = LockOffsetBuffer_RenderThread(RHICmdList, numVertices);
+    return { MappingData.PermuteLowResOffsets(LowResHandoffSlots[HandoffSlot].Offsets, PermutedLowResOffsets), MakeArrayView(lockedData, numVertices) };
+}
+
+void UClothDeformerComponent::EndBatchedUpload_RenderThread(FRHICommandListImmediate& RHICmdList, const FMappingBatchItem& Item, int32 HandoffSlot, bool bMapped)
+{
+    check(IsInRenderingThread());
+
+    if (!bMapped)
+    {
+        // 锁定的内存内容未定义，失败时清零，避免显示垃圾数据
+        FMemory::Memzero(Item.HighResOffsets.GetData(), Item.HighResOffsets.Num() * sizeof(FVector3f));
+    }
+    LastMappedRowCount.store(bMapped ? Item.HighResOffsets.Num() : 0, std::memory_order_relaxed);
+    RHICmdList.UnlockBuffer(OffsetBuffer);
+
+    // 批量路径不维护增量状态，下次启用增量时重新做完整映射
+    AppliedLowResOffsets.Reset();
+    ReleaseLowResHandoff(HandoffSlot);
+}
+
+void UClothDeformerComponent::UpdateMesh(USkeletalMeshComponent* targetMesh, TConstArrayView<float> LowResOffsets, bool bAllowBatchedMapping)
+{
+    if (!targetMesh || !MappingAsset)
     {
         return;
     }
 
-    // GPU 使用float, 而FVector是Double, 需要转换, 
-    // TODO 优化移除转换, 需要修改相关函数声明
-    TArray<FVector3f> FloatData;
-    FloatData.SetNumUninitialized(HighResOffsets.Num());
-    for (int32 i = 0; i < HighResOffsets.Num(); ++i)
+    const FSparseMappingMatrix* mappingData = &MappingAsset->MappingData;
+    if (mappingData->NumRow == 0 || LowResOffsets.Num() != mappingData->NumCol * 3)
     {
-        FloatData[i] = (FVector3f)HighResOffsets[i];
+        UE_LOG(LogTemp, Error, TEXT("UpdateMesh: 低模偏移数量 %d 与映射矩阵列数 %d 不匹配"), LowResOffsets.Num() / 3, mappingData->NumCol);
+        return;
+    }
+
+    // 渲染线程落后超过交接缓冲的容量时丢弃本帧结果
+    const int32 handoffSlot = AcquireLowResHandoff(LowResOffsets);
+    if (handoffSlot == INDEX_NONE)
+    {
+        return;
     }
-    ENQUEUE_RENDER_COMMAND(UploadClothOffsets)([this,GPUData=MoveTemp(FloatData)](FRHICommandListImmediate& RHICmdList)
+
+    // 共享映射资产的组件交给子系统，在本帧 TG_PostUpdateWork 之前合并为一次批量映射 (增量模式依赖逐组件状态，不参与合并)
+    if (bAllowBatchedMapping && bBatchMappingWithSharedAsset && !bIncrementalMapping)
+    {
+        if (UClothDeformerSubsystem* subsystem = GetWorld() ? GetWorld()->GetSubsystem<UClothDeformerSubsystem>() : nullptr)
         {
-            uint32 BufferSize = GPUData.Num() * sizeof(FVector3f);
+            subsystem->QueueMapping(this, MappingAsset, handoffSlot);
+            return;
+        }
+    }
 
-            if (!OffsetBuffer.IsValid() || OffsetBuffer->GetSize() != BufferSize)
+    // 只把低模偏移 (几千个顶点) 交给渲染线程，映射内核把高模偏移直接写进锁定的上传缓冲，
+    // 高模数据只写一次，不再经过中间数组和 Memcpy
+    ENQUEUE_RENDER_COMMAND(UploadClothOffsets)([this, mappingData, handoffSlot, MinRowsPerTask = MappingMinRowsPerTask,
+                                                bIncremental = bIncrementalMapping, ChangeThreshold = IncrementalChangeThreshold](FRHICommandListImmediate& RHICmdList)
+        {
+            CLOTH_DEFORMER_SCOPE(Upload);
+            LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+            ON_SCOPE_EXIT { ReleaseLowResHandoff(handoffSlot); };
+            const int32 numVertices = mappingData->NumRow;
+
+            // 烘焙时若重排过低模列，先把模型输出按矩阵列顺序重排一次
+            const TConstArrayView<float> lowResOffsets = mappingData->PermuteLowResOffsets(LowResHandoffSlots[handoffSlot].Offsets, PermutedLowResOffsets);
+
+            if (bIncremental)
             {
-                FRHIBufferCreateDesc BufferDesc = FRHIBufferCreateDesc::Create(TEXT("MLClothOffsetBuffer"), BufferSize, sizeof(FVector3f), BUF_ShaderResource | BUF_Dynamic | BUF_StructuredBuffer);
-                BufferDesc.SetInitialState(ERHIAccess::SRVMask);
-                // BUF_ShaderResource 允许 Shader 读取，BUF_Dynamic 表示我们会频繁(每帧)更新它
-                
-                OffsetBuffer = RHICmdList.CreateBuffer(BufferDesc);
-                // 为这块内存创建 SRV 视图
-                OffsetBufferSRV = RHICmdList.CreateShaderResourceView(OffsetBuffer, FRHIViewDesc::CreateBufferSRV()
-                    .SetTypeFromBuffer(OffsetBuffer));
+                // 增量模式需要读回上一帧结果，而 WriteOnly 锁定的内存内容未定义，
+                // 因此在 CPU 侧保留一份高模偏移，只重算受影响的行后整体拷贝
+                if (IncrementalHighResOffsets.Num() != numVertices)
+                {
+                    IncrementalHighResOffsets.SetNumUninitialized(numVertices);
+                    AppliedLowResOffsets.Reset();
+                }
+
+                const int32 mappedRows = mappingData->ApplyMappingIncremental(lowResOffsets, AppliedLowResOffsets, ChangeThreshold, IncrementalHighResOffsets, IncrementalRowScratch);
+                // 与其他路径一致，失败时记为 0 行，不把 INDEX_NONE 暴露给蓝图
+                LastMappedRowCount.store(FMath::Max(mappedRows, 0), std::memory_order_relaxed);
+                if (mappedRows == INDEX_NONE)
+                {
+                    return;
+                }
+                INC_DWORD_STAT_BY(STAT_ClothDeformer_VerticesMapped, mappedRows);
+
+                FVector3f* LockedData = LockOffsetBuffer_RenderThread(RHICmdList, numVertices);
+                FMemory::Memcpy(LockedData, IncrementalHighResOffsets.GetData(), numVertices * sizeof(FVector3f));
+                RHICmdList.UnlockBuffer(OffsetBuffer);
+                return;
             }
 
-            // CPU GPU 拷贝
-            void* LockedData = RHICmdList.LockBuffer(OffsetBuffer, 0, BufferSize, RLM_WriteOnly);
-            FMemory::Memcpy(LockedData, GPUData.GetData(), BufferSize);
+            FVector3f* LockedData = LockOffsetBuffer_RenderThread(RHICmdList, numVertices);
+            if (mappingData->ApplyMappingParallel(lowResOffsets, MakeArrayView(LockedData, numVertices), MinRowsPerTask))
+            {
+                LastMappedRowCount.store(numVertices, std::memory_order_relaxed);
+                INC_DWORD_STAT_BY(STAT_ClothDeformer_VerticesMapped, numVertices);
+            }
+            else
+            {
+                // 锁定的内存内容未定义，失败时清零，避免显示垃圾数据
+                FMemory::Memzero(LockedData, numVertices * sizeof(FVector3f));
+            }
             RHICmdList.UnlockBuffer(OffsetBuffer);
 
+            // 切回非增量模式后，下次启用增量时重新做完整映射
+            AppliedLowResOffsets.Reset();
         });
-  
-}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include "ClothDeformerStats.h"
+#include <atomic>
+
+DEFINE_STAT(STAT_ClothDeformer_Tick);
+DEFINE_STAT(STAT_ClothDeformer_InputExtraction);
+DEFINE_STAT(STAT_ClothDeformer_Inference);
+DEFINE_STAT(STAT_ClothDeformer_Mapping);
+DEFINE_STAT(STAT_ClothDeformer_Upload);
+
+DEFINE_STAT(STAT_ClothDeformer_NumModelInstances);
+DEFINE_STAT(STAT_ClothDeformer_NumCharacters);
+DEFINE_STAT(STAT_ClothDeformer_VerticesMapped);
+DEFINE_STAT(STAT_ClothDeformer_BytesUploaded);
+DEFINE_STAT(STAT_ClothDeformer_OrtAllocated);
+
+DEFINE_STAT(STAT_ClothDeformer_AvgTickMs);
+DEFINE_STAT(STAT_ClothDeformer_AvgInputExtractionMs);
+DEFINE_STAT(STAT_ClothDeformer_AvgInferenceMs);
+DEFINE_STAT(STAT_ClothDeformer_AvgMappingMs);
+DEFINE_STAT(STAT_ClothDeformer_AvgUploadMs);
+
+LLM_DEFINE_TAG(ClothDeformer);
+LLM_DEFINE_TAG(ClothDeformer_ModelData);
+LLM_DEFINE_TAG(ClothDeformer_Sessions);
+LLM_DEFINE_TAG(ClothDeformer_Mapping);
+LLM_DEFINE_TAG(ClothDeformer_InstanceBuffers);
+LLM_DEFINE_TAG(ClothDeformer_GpuBuffers);
+LLM_DEFINE_TAG(ClothDeformer_OrtArena);
+
+#if STATS
+namespace ClothDeformerStats
+{
+    namespace
+    {
+        std::atomic<uint64> GStageCycles[static_cast<int32>(EStage::Num)];
+        std::atomic<int32> GNumCharacters{0};
+    }
+
+    void AddStageCycles(EStage Stage, uint64 Cycles)
+    {
+        GStageCycles[static_cast<int32>(Stage)].fetch_add(Cycles, std::memory_order_relaxed);
+    }
+
+    void AddCharacter()
+    {
+        GNumCharacters.fetch_add(1, std::memory_order_relaxed);
+        INC_DWORD_STAT(STAT_ClothDeformer_NumCharacters);
+    }
+
+    void PublishFrameAverages()
+    {
+        const int32 numCharacters = GNumCharacters.exchange(0, std::memory_order_relaxed);
+        double averageMs[static_cast<int32>(EStage::Num)];
+        for (int32 i = 0; i < static_cast<int32>(EStage::Num); ++i)
+        {
+            const uint64 cycles = GStageCycles[i].exchange(0, std::memory_order_relaxed);
+            averageMs[i] = numCharacters > 0 ? FPlatformTime::ToMilliseconds64(cycles) / numCharacters : 0.0;
+        }
+
+        SET_FLOAT_STAT(STAT_ClothDeformer_AvgTickMs, averageMs[static_cast<int32>(EStage::Tick)]);
+        SET_FLOAT_STAT(STAT_ClothDeformer_AvgInputExtractionMs, averageMs[static_cast<int32>(EStage::InputExtraction)]);
+        SET_FLOAT_STAT(STAT_ClothDeformer_AvgInferenceMs, averageMs[static_cast<int32>(EStage::Inference)]);
+        SET_FLOAT_STAT(STAT_ClothDeformer_AvgMappingMs, averageMs[static_cast<int32>(EStage::Mapping)]);
+        SET_FLOAT_STAT(STAT_ClothDeformer_AvgUploadMs, averageMs[static_cast<int32>(EStage::Upload)]);
+    }
+}
+#endif
@@ -0,0 +1,104 @@
+// ClothDeformerStats.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * stat clothdeformer：逐阶段的周期计数、实例数、上传字节与映射顶点数。
+ * 每个阶段同时带 Insights 的 CPU trace 作用域，Shipping 等关闭 STATS 的配置中仍可在 trace 中区分各阶段。
+ * 各阶段的耗时另外累加，由 UClothDeformerSubsystem 每帧除以本帧运行的角色数，得到逐角色平均值。
+ * 内存按 ClothDeformer/* 的 LLM 标签归类 (stat LLMFULL 与 Memory Insights)
+ */
+DECLARE_STATS_GROUP(TEXT("ClothDeformer"), STATGROUP_ClothDeformer, STATCAT_Advanced);
+
+// 阶段耗时 (Upload 包含渲染线程上的映射)
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Component Tick"), STAT_ClothDeformer_Tick, STATGROUP_ClothDeformer, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Input Extraction"), STAT_ClothDeformer_InputExtraction, STATGROUP_ClothDeformer, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Inference"), STAT_ClothDeformer_Inference, STATGROUP_ClothDeformer, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Mapping"), STAT_ClothDeformer_Mapping, STATGROUP_ClothDeformer, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Upload"), STAT_ClothDeformer_Upload, STATGROUP_ClothDeformer, );
+
+// 数量
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Model Instances"), STAT_ClothDeformer_NumModelInstances, STATGROUP_ClothDeformer, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Characters Ticked"), STAT_ClothDeformer_NumCharacters, STATGROUP_ClothDeformer, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Vertices Mapped"), STAT_ClothDeformer_VerticesMapped, STATGROUP_ClothDeformer, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes Uploaded"), STAT_ClothDeformer_BytesUploaded, STATGROUP_ClothDeformer, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("ORT Allocated"), STAT_ClothDeformer_OrtAllocated, STATGROUP_ClothDeformer, );
+
+// 逐角色平均 (毫秒)
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Avg Tick per Character (ms)"), STAT_ClothDeformer_AvgTickMs, STATGROUP_ClothDeformer, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Avg Input per Character (ms)"), STAT_ClothDeformer_AvgInputExtractionMs, STATGROUP_ClothDeformer, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Avg Inference per Character (ms)"), STAT_ClothDeformer_AvgInferenceMs, STATGROUP_ClothDeformer, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Avg Mapping per Character (ms)"), STAT_ClothDeformer_AvgMappingMs, STATGROUP_ClothDeformer, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Avg Upload per Character (ms)"), STAT_ClothDeformer_AvgUploadMs, STATGROUP_ClothDeformer, );
+
+// LLM 标签：模型数据、会话 (ORT 会话与原生模型的权重)、映射矩阵、逐实例输入输出缓冲、GPU 偏移缓冲，
+// 以及会话创建之外经 UE 分配器的 ORT 分配 (中间结果与内存模式块)；设置了内存上限时改为每帧采样的限额 arena 增长
+LLM_DECLARE_TAG(ClothDeformer);
+LLM_DECLARE_TAG(ClothDeformer_ModelData);
+LLM_DECLARE_TAG(ClothDeformer_Sessions);
+LLM_DECLARE_TAG(ClothDeformer_Mapping);
+LLM_DECLARE_TAG(ClothDeformer_InstanceBuffers);
+LLM_DECLARE_TAG(ClothDeformer_GpuBuffers);
+LLM_DECLARE_TAG(ClothDeformer_OrtArena);
+
+namespace ClothDeformerStats
+{
+    enum class EStage : uint8
+    {
+        Tick,
+        InputExtraction,
+        Inference,
+        Mapping,
+        Upload,
+        Num
+    };
+
+#if STATS
+    // 累加某阶段的耗时，任意线程可调用
+    void AddStageCycles(EStage Stage, uint64 Cycles);
+
+    // 组件每帧运行一次流水线时调用，计入本帧角色数
+    void AddCharacter();
+
+    // 游戏线程每帧调用一次：按本帧运行的角色数发布逐角色平均值并清零累加。
+    // 渲染线程上的阶段 (映射、上传) 通常落后一帧计入
+    void PublishFrameAverages();
+
+    // 作用域内的耗时计入 Stage
+    struct FStageTimer
+    {
+        explicit FStageTimer(EStage InStage)
+            : Stage(InStage)
+            , StartCycles(FPlatformTime::Cycles64())
+        {
+        }
+        ~FStageTimer()
+        {
+            AddStageCycles(Stage, FPlatformTime::Cycles64() - StartCycles);
+        }
+
+        EStage Stage;
+        uint64 StartCycles;
+    };
+#else
+    inline void AddCharacter() {}
+    inline void PublishFrameAverages() {}
+#endif
+}
+
+#if STATS
+#define CLOTH_DEFORMER_STAGE_TIMER(Stage) ClothDeformerStats::FStageTimer PREPROCESSOR_JOIN(ClothStageTimer_, __LINE__)(ClothDeformerStats::EStage::Stage)
+#else
+#define CLOTH_DEFORMER_STAGE_TIMER(Stage)
+#endif
+
+// 标记一个流水线阶段：stat 周期计数、Insights trace 作用域与逐角色平均的累加
+#define CLOTH_DEFORMER_SCOPE(Stage) \
+    TRACE_CPUPROFILER_EVENT_SCOPE(ClothDeformer_##Stage); \
+    SCOPE_CYCLE_COUNTER(STAT_ClothDeformer_##Stage); \
+    CLOTH_DEFORMER_STAGE_TIMER(Stage)
@@ -0,0 +1,190 @@
+#include "ClothDeformerSubsystem.h"
+#include "ClothDeformerComponent.h"
+#include "MeshMappingAsset.h"
+#include "ClothDeformerStats.h"
+#include "OnnxSessionRegistry.h"
+#include "Algo/Sort.h"
+
+void UClothDeformerSubsystem::QueueInference(UClothDeformerComponent* Component)
+{
+    PendingInferences.Add(Component);
+}
+
+void UClothDeformerSubsystem::QueueMapping(UClothDeformerComponent* Component, UMeshMappingAsset* MappingAsset, int32 HandoffSlot)
+{
+    PendingMappings.Add({ Component, MappingAsset, HandoffSlot });
+}
+
+void UClothDeformerSubsystem::Tick(float DeltaTime)
+{
+    Super::Tick(DeltaTime);
+
+    // 推理结果经 UpdateMesh 进入映射队列，因此先推理再映射
+    FlushPendingInferences();
+    FlushPendingMappings();
+
+    // 默认 Tick 组的组件已 Tick，发布逐角色平均耗时 (AsyncSameFrame 在 TG_PostUpdateWork 中的映射计入下一帧)
+    ClothDeformerStats::PublishFrameAverages();
+#if WITH_CLOTH_ORT
+    FOnnxSessionRegistry::Get().PublishArenaUsage();
+#endif
+}
+
+TStatId UClothDeformerSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UClothDeformerSubsystem, STATGROUP_Tickables);
+}
+
+void UClothDeformerSubsystem::Deinitialize()
+{
+    PendingInferences.Empty();
+    BatchRunners.Empty();
+    for (const FPendingMapping& pending : PendingMappings)
+    {
+        if (pending.Component.IsValid())
+        {
+            pending.Component->CancelQueuedMapping(pending.HandoffSlot);
+        }
+    }
+    PendingMappings.Empty();
+
+    Super::Deinitialize();
+}
+
+void UClothDeformerSubsystem::FlushPendingInferences()
+{
+    // 丢弃已销毁或已重置的组件，再按模型资产排序，使共享资产的组件相邻
+    PendingInferences.RemoveAll([](const TWeakObjectPtr<UClothDeformerComponent>& Pending)
+        {
+            return !Pending.IsValid() || !Pending->IsInitialized();
+        });
+    Algo::SortBy(PendingInferences, [](const TWeakObjectPtr<UClothDeformerComponent>& Pending)
+        {
+            return reinterpret_cast<UPTRINT>(Pending->modelAsset_);
+        });
+
+    // 资产被卸载后不再需要它的打包缓冲
+    for (auto It = BatchRunners.CreateIterator(); It; ++It)
+    {
+        if (!It.Key().ResolveObjectPtr())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    // 各组件的输入视图在整组推理期间保持有效
+    TArray<TArray<TConstArrayView<float>, TInlineAllocator<8>>> inputViews;
+    TArray<FOnnxBatchItem> items;
+
+    for (int32 groupBegin = 0; groupBegin < PendingInferences.Num();)
+    {
+        UClothDeformationModelAsset* modelAsset = PendingInferences[groupBegin]->modelAsset_;
+        int32 groupEnd = groupBegin + 1;
+        while (groupEnd < PendingInferences.Num() && PendingInferences[groupEnd]->modelAsset_ == modelAsset)
+        {
+            ++groupEnd;
+        }
+        const int32 groupSize = groupEnd - groupBegin;
+
+        inputViews.SetNum(groupSize, EAllowShrinking::No);
+        items.Reset();
+        for (int32 i = 0; i < groupSize; ++i)
+        {
+            items.Add(PendingInferences[groupBegin + i]->MakeBatchInferenceItem(inputViews[i]));
+        }
+
+        // 只有一个组件时沿用它自己的 IoBinding 路径，不做打包拷贝
+        bool bBatched = false;
+        if (groupSize > 1)
+        {
+            TUniquePtr<FOnnxBatchRunner>& runner = BatchRunners.FindOrAdd(modelAsset);
+            if (!runner)
+            {
+                runner = MakeUnique<FOnnxBatchRunner>();
+            }
+            bBatched = runner->Run(items);
+        }
+
+        for (int32 i = 0; i < groupSize; ++i)
+        {
+            PendingInferences[groupBegin + i]->CompleteBatchedInference(items[i], bBatched);
+        }
+
+        groupBegin = groupEnd;
+    }
+
+    PendingInferences.Reset();
+}
+
+void UClothDeformerSubsystem::FlushPendingMappings()
+{
+    // 丢弃已销毁的组件与已卸载的映射资产，再按登记时的映射资产排序，使共享资产的组件相邻。
+    // 低模偏移的长度是按登记时的资产校验的，因此始终用它映射，而不是组件当前的 MappingAsset
+    PendingMappings.RemoveAll([](const FPendingMapping& Pending)
+        {
+            if (!Pending.Component.IsValid())
+            {
+                return true;
+            }
+            if (!Pending.MappingAsset.IsValid())
+            {
+                Pending.Component->CancelQueuedMapping(Pending.HandoffSlot);
+                return true;
+            }
+            return false;
+        });
+    Algo::SortBy(PendingMappings, [](const FPendingMapping& Pending)
+        {
+            return reinterpret_cast<UPTRINT>(Pending.MappingAsset.Get());
+        });
+
+    struct FRenderJob
+    {
+        UClothDeformerComponent* Component;
+        int32 HandoffSlot;
+    };
+
+    for (int32 groupBegin = 0; groupBegin < PendingMappings.Num();)
+    {
+        UMeshMappingAsset* mappingAsset = PendingMappings[groupBegin].MappingAsset.Get();
+        int32 groupEnd = groupBegin + 1;
+        while (groupEnd < PendingMappings.Num() && PendingMappings[groupEnd].MappingAsset.Get() == mappingAsset)
+        {
+            ++groupEnd;
+        }
+
+        // 低模偏移留在各组件的交接缓冲中，命令只携带组件与缓冲索引，常见的组规模不做堆分配
+        TArray<FRenderJob, TInlineAllocator<16>> jobs;
+        for (int32 i = groupBegin; i < groupEnd; ++i)
+        {
+            jobs.Add({ PendingMappings[i].Component.Get(), PendingMappings[i].HandoffSlot });
+        }
+        const int32 minRowsPerTask = jobs[0].Component->MappingMinRowsPerTask;
+
+        // 与单组件路径相同：映射内核把高模偏移直接写进各组件锁定的上传缓冲
+        ENQUEUE_RENDER_COMMAND(UploadClothOffsetsBatched)([mappingData = &mappingAsset->MappingData, Jobs = MoveTemp(jobs), minRowsPerTask](FRHICommandListImmediate& RHICmdList)
+            {
+                CLOTH_DEFORMER_SCOPE(Upload);
+                LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+                const int32 numVertices = mappingData->NumRow;
+
+                TArray<FMappingBatchItem, TInlineAllocator<16>> items;
+                items.Reserve(Jobs.Num());
+                for (const FRenderJob& job : Jobs)
+                {
+                    items.Add(job.Component->BeginBatchedUpload_RenderThread(RHICmdList, *mappingData, job.HandoffSlot));
+                }
+
+                const bool bMapped = mappingData->ApplyMappingBatched(items, minRowsPerTask);
+                INC_DWORD_STAT_BY(STAT_ClothDeformer_VerticesMapped, bMapped ? numVertices * Jobs.Num() : 0);
+                for (int32 i = 0; i < Jobs.Num(); ++i)
+                {
+                    Jobs[i].Component->EndBatchedUpload_RenderThread(RHICmdList, items[i], Jobs[i].HandoffSlot, bMapped);
+                }
+            });
+
+        groupBegin = groupEnd;
+    }
+
+    PendingMappings.Reset();
+}
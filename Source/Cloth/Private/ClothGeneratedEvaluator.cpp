@@ -0,0 +1,36 @@
+#include "ClothGeneratedEvaluator.h"
+#include "NativeClothModel.h"
+#include "Misc/ScopeLock.h"
+
+bool IClothGeneratedEvaluator::BindConstant(const FNativeClothModel& Model, int32 ValueIndex, int64 ExpectedNum, const float*& OutData)
+{
+    const TConstArrayView<float> data = Model.GetConstantData(ValueIndex);
+    OutData = data.GetData();
+    return data.Num() == ExpectedNum;
+}
+
+FClothGeneratedEvaluatorRegistry& FClothGeneratedEvaluatorRegistry::Get()
+{
+    // 函数内静态对象，保证生成文件的静态登记先于注册表使用时也已构造
+    static FClothGeneratedEvaluatorRegistry Registry;
+    return Registry;
+}
+
+void FClothGeneratedEvaluatorRegistry::Register(uint32 ModelCrc, FFactory Factory)
+{
+    FScopeLock lock(&Mutex);
+    Factories.Add(ModelCrc, Factory);
+}
+
+TUniquePtr<IClothGeneratedEvaluator> FClothGeneratedEvaluatorRegistry::Create(uint32 ModelCrc) const
+{
+    FFactory factory = nullptr;
+    {
+        FScopeLock lock(&Mutex);
+        if (const FFactory* found = Factories.Find(ModelCrc))
+        {
+            factory = *found;
+        }
+    }
+    return factory ? factory() : nullptr;
+}
@@ -0,0 +1,252 @@
+#include "ClothInferenceConformanceCommandlet.h"
+#include "ClothDeformationModelAsset.h"
+#include "OnnxModelInstance.h"
+#include "Math/RandomStream.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+    // 一个后端的实例与它逐帧复用的输入输出缓冲
+    struct FBackendRun
+    {
+        const TCHAR* Name;
+        TUniquePtr<FOnnxModelInstance> Instance;
+        TArray<TArray<float>> Outputs;
+
+        bool Create(UClothDeformationModelAsset* Asset, EClothInferenceBackend Backend)
+        {
+            Instance = MakeUnique<FOnnxModelInstance>(Asset, EClothModelPrecision::FP32, Backend);
+            if (!Instance->IsInitialized())
+            {
+                return false;
+            }
+            // 符号维度都取 1
+            for (int32 symbol = 0; symbol < Instance->GetDimSymbols().Num(); ++symbol)
+            {
+                Instance->BindDimSymbol(symbol, 1);
+            }
+            Outputs.SetNum(Instance->GetOutputSlots().Num());
+            return true;
+        }
+
+        bool Step(TConstArrayView<TConstArrayView<float>> Inputs)
+        {
+            return Instance->RunWithBinding(Inputs, Outputs);
+        }
+    };
+
+    float MaxAbsError(TConstArrayView<float> Actual, TConstArrayView<float> Expected)
+    {
+        if (Actual.Num() != Expected.Num())
+        {
+            return MAX_flt;
+        }
+        float maxError = 0.0f;
+        for (int32 i = 0; i < Actual.Num(); ++i)
+        {
+            maxError = FMath::Max(maxError, FMath::Abs(Actual[i] - Expected[i]));
+        }
+        return maxError;
+    }
+
+    // 两个实例第 OutputIndex 个输出的最大误差，循环状态输出比较实例持有的状态
+    float OutputError(const FBackendRun& Actual, const FBackendRun& Expected, int32 OutputIndex)
+    {
+        const int32 pair = Actual.Instance->GetOutputSlots()[OutputIndex].RecurrentPair;
+        return pair != INDEX_NONE
+            ? MaxAbsError(Actual.Instance->GetRecurrentState(pair), Expected.Instance->GetRecurrentState(pair))
+            : MaxAbsError(Actual.Outputs[OutputIndex], Expected.Outputs[OutputIndex]);
+    }
+
+    // 预热一次后执行 Iterations 次，返回每帧耗时的中位数 (秒)
+    double MeasureMedianSeconds(FBackendRun& Run, TConstArrayView<TConstArrayView<float>> Inputs, int32 Iterations)
+    {
+        Run.Step(Inputs);
+
+        TArray<double> samples;
+        samples.Reserve(Iterations);
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            const double startTime = FPlatformTime::Seconds();
+            Run.Step(Inputs);
+            samples.Add(FPlatformTime::Seconds() - startTime);
+        }
+        Algo::Sort(samples);
+        return samples[samples.Num() / 2];
+    }
+}
+
+UClothInferenceConformanceCommandlet::UClothInferenceConformanceCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UClothInferenceConformanceCommandlet::Main(const FString& Params)
+{
+    FString modelPath;
+    if (!FParse::Value(*Params, TEXT("Model="), modelPath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 需要 -Model=<模型资产路径>"));
+        return 1;
+    }
+    UClothDeformationModelAsset* asset = LoadObject<UClothDeformationModelAsset>(nullptr, *modelPath);
+    if (!asset)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 无法加载模型资产 %s"), *modelPath);
+        return 1;
+    }
+
+    int32 numSequences = 8;
+    int32 numSteps = 16;
+    int32 iterations = 200;
+    float tolerance = 1e-4f;
+    int32 seed = 1;
+    FParse::Value(*Params, TEXT("Sequences="), numSequences);
+    FParse::Value(*Params, TEXT("Steps="), numSteps);
+    FParse::Value(*Params, TEXT("Iterations="), iterations);
+    FParse::Value(*Params, TEXT("Tolerance="), tolerance);
+    FParse::Value(*Params, TEXT("Seed="), seed);
+    numSequences = FMath::Max(1, numSequences);
+    numSteps = FMath::Max(1, numSteps);
+    iterations = FMath::Max(1, iterations);
+
+    FBackendRun native{TEXT("Native")};
+    if (!native.Create(asset, EClothInferenceBackend::Native))
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 原生后端无法导入 %s (见上方日志中不支持的算子)"), *modelPath);
+        return 1;
+    }
+    native.Instance->SetUseGeneratedEvaluator(false);
+    const TArray<FOnnxTensorSlot>& inputSlots = native.Instance->GetInputSlots();
+    const TArray<FOnnxTensorSlot>& outputSlots = native.Instance->GetOutputSlots();
+
+    // 有为该模型生成的求值器时，同样的输入再与解释执行逐帧比较
+    FBackendRun generated{TEXT("Generated")};
+    const bool bHasGenerated = generated.Create(asset, EClothInferenceBackend::Native) && generated.Instance->HasGeneratedEvaluator();
+
+#if WITH_CLOTH_ORT
+    FBackendRun reference{TEXT("ONNX Runtime")};
+    if (!reference.Create(asset, EClothInferenceBackend::OnnxRuntime))
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 无法创建 ONNX Runtime 参考实例"));
+        return 1;
+    }
+#endif
+
+    // 每个序列从零状态开始逐帧运行，循环状态由两个实例各自在帧间传递
+    FRandomStream random(seed);
+    TArray<TArray<float>> inputs;
+    inputs.SetNum(inputSlots.Num());
+    TArray<TConstArrayView<float>> inputViews;
+    inputViews.SetNum(inputSlots.Num());
+
+#if WITH_CLOTH_ORT
+    float maxError = 0.0f;
+#endif
+    int32 numFailures = 0;
+    for (int32 sequence = 0; sequence < numSequences; ++sequence)
+    {
+        native.Instance->ResetRecurrentState();
+        if (bHasGenerated)
+        {
+            generated.Instance->ResetRecurrentState();
+        }
+#if WITH_CLOTH_ORT
+        reference.Instance->ResetRecurrentState();
+#endif
+        for (int32 step = 0; step < numSteps; ++step)
+        {
+            for (int32 i = 0; i < inputSlots.Num(); ++i)
+            {
+                inputs[i].SetNumUninitialized(inputSlots[i].RecurrentPair != INDEX_NONE ? 0 : static_cast<int32>(native.Instance->GetDefaultElementCount(i)));
+                for (float& value : inputs[i])
+                {
+                    value = random.FRandRange(-1.0f, 1.0f);
+                }
+                inputViews[i] = inputs[i];
+            }
+
+            if (!native.Step(inputViews))
+            {
+                UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 原生后端在序列 %d 第 %d 帧运行失败"), sequence, step);
+                return 1;
+            }
+            for (const TArray<float>& output : native.Outputs)
+            {
+                for (float value : output)
+                {
+                    numFailures += FMath::IsFinite(value) ? 0 : 1;
+                }
+            }
+
+            if (bHasGenerated)
+            {
+                if (!generated.Step(inputViews))
+                {
+                    UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 生成的求值器在序列 %d 第 %d 帧运行失败"), sequence, step);
+                    return 1;
+                }
+                for (int32 o = 0; o < outputSlots.Num(); ++o)
+                {
+                    const float error = OutputError(generated, native, o);
+                    if (error > tolerance)
+                    {
+                        ++numFailures;
+                        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 序列 %d 第 %d 帧生成求值器的输出 %s 与解释执行相差 %.3e"), sequence, step, *outputSlots[o].Name, error);
+                    }
+                }
+            }
+
+#if WITH_CLOTH_ORT
+            if (!reference.Step(inputViews))
+            {
+                UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: ONNX Runtime 在序列 %d 第 %d 帧运行失败"), sequence, step);
+                return 1;
+            }
+            for (int32 o = 0; o < outputSlots.Num(); ++o)
+            {
+                const float error = OutputError(native, reference, o);
+                maxError = FMath::Max(maxError, error);
+                if (error > tolerance)
+                {
+                    ++numFailures;
+                    UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: 序列 %d 第 %d 帧输出 %s 误差 %.3e 超出容差 %.1e"), sequence, step, *outputSlots[o].Name, error, tolerance);
+                }
+            }
+#endif
+        }
+    }
+
+    // 最后一帧的输入上比较各后端每帧的耗时
+    const double nativeSeconds = MeasureMedianSeconds(native, inputViews, iterations);
+    const double generatedSeconds = bHasGenerated ? MeasureMedianSeconds(generated, inputViews, iterations) : 0.0;
+#if WITH_CLOTH_ORT
+    const double referenceSeconds = MeasureMedianSeconds(reference, inputViews, iterations);
+    UE_LOG(LogTemp, Display, TEXT("%s: %d x %d frames, max abs error %.3e (tolerance %.1e), native %.2f us/frame, ONNX Runtime %.2f us/frame (x%.2f)"),
+           *asset->GetName(), numSequences, numSteps, maxError, tolerance, nativeSeconds * 1e6, referenceSeconds * 1e6, referenceSeconds / nativeSeconds);
+    if (bHasGenerated)
+    {
+        UE_LOG(LogTemp, Display, TEXT("%s: generated evaluator %.2f us/frame (x%.2f vs native, x%.2f vs ONNX Runtime)"),
+               *asset->GetName(), generatedSeconds * 1e6, nativeSeconds / generatedSeconds, referenceSeconds / generatedSeconds);
+    }
+#else
+    UE_LOG(LogTemp, Display, TEXT("%s: %d x %d frames on the native backend, %.2f us/frame (no ONNX Runtime reference on this platform)"),
+           *asset->GetName(), numSequences, numSteps, nativeSeconds * 1e6);
+    if (bHasGenerated)
+    {
+        UE_LOG(LogTemp, Display, TEXT("%s: generated evaluator %.2f us/frame (x%.2f vs native)"),
+               *asset->GetName(), generatedSeconds * 1e6, nativeSeconds / generatedSeconds);
+    }
+#endif
+
+    if (numFailures > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothInferenceConformance: %d 项一致性检查失败"), numFailures);
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("ClothInferenceConformance: 全部一致性检查通过"));
+    return 0;
+}
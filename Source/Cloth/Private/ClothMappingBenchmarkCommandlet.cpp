@@ -0,0 +1,380 @@
+#include "ClothMappingBenchmarkCommandlet.h"
+#include "SparseMappingMatrix.h"
+#include "Math/RandomStream.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+    struct FSyntheticMatrixDesc
+    {
+        const TCHAR* Name;
+        int32 MinRowWidth;
+        int32 MaxRowWidth;
+    };
+
+    // 与烘焙结果一致的行宽分布：定宽 KNN (走 ELL 内核)、变宽 KNN (走 CSR 内核)、表面投影的重心坐标
+    const FSyntheticMatrixDesc SyntheticMatrices[] =
+    {
+        { TEXT("KNN K=4"), 4, 4 },
+        { TEXT("KNN K=1..8"), 1, 8 },
+        { TEXT("Barycentric"), 3, 3 },
+    };
+
+    // 低模顶点数取高模的 1/LowResRatio，邻居取自 ±NeighborWindow 的局部窗口
+    constexpr int32 LowResRatio = 8;
+    constexpr int32 NeighborWindow = 32;
+    // 批量映射基准的实例数
+    constexpr int32 BatchInstances = 4;
+    // 增量映射基准中每帧变化的低模顶点比例
+    constexpr float IncrementalChangeRatio = 0.01f;
+    // 单精度内核与双精度参考之间允许的误差 (权重和为 1，输入在 [-1,1])
+    constexpr float FloatTolerance = 1e-5f;
+
+    /**
+     * 生成合成映射矩阵，每行的权重为正且和为 1
+     * 列编号随机打乱，模拟导入网格的顶点编号与空间位置无关，使列重排的收益可以被测出
+     */
+    FSparseMappingMatrix BuildSyntheticMatrix(const FSyntheticMatrixDesc& Desc, int32 NumRow, FRandomStream& Random)
+    {
+        const int32 numCol = FMath::Max(NumRow / LowResRatio, 2 * NeighborWindow + 1);
+        TArray<int32> colLabels;
+        colLabels.SetNumUninitialized(numCol);
+        for (int32 i = 0; i < numCol; ++i)
+        {
+            colLabels[i] = i;
+        }
+        for (int32 i = numCol - 1; i > 0; --i)
+        {
+            colLabels.Swap(i, Random.RandRange(0, i));
+        }
+
+        FSparseMappingMatrix matrix(NumRow, numCol);
+        matrix.BeginBuild(NumRow * Desc.MaxRowWidth);
+
+        TArray<int32, TInlineAllocator<FSparseMappingMatrix::MaxFixedRowWidth>> cols;
+        TArray<float, TInlineAllocator<FSparseMappingMatrix::MaxFixedRowWidth>> weights;
+        for (int32 row = 0; row < NumRow; ++row)
+        {
+            const int32 center = static_cast<int32>(static_cast<int64>(row) * numCol / NumRow);
+            const int32 windowBegin = FMath::Clamp(center - NeighborWindow, 0, numCol - 2 * NeighborWindow - 1);
+            const int32 width = Random.RandRange(Desc.MinRowWidth, Desc.MaxRowWidth);
+
+            cols.Reset();
+            weights.Reset();
+            float weightSum = 0.0f;
+            while (cols.Num() < width)
+            {
+                const int32 col = colLabels[windowBegin + Random.RandRange(0, 2 * NeighborWindow)];
+                if (!cols.Contains(col))
+                {
+                    const float weight = Random.FRandRange(0.05f, 1.0f);
+                    cols.Add(col);
+                    weights.Add(weight);
+                    weightSum += weight;
+                }
+            }
+
+            matrix.BeginRow(row);
+            for (int32 i = 0; i < cols.Num(); ++i)
+            {
+                matrix.AddEntry(cols[i], weights[i] / weightSum);
+            }
+            matrix.EndRow();
+        }
+        matrix.EndBuild();
+        return matrix;
+    }
+
+    // 预热一次后执行 Iterations 次，返回耗时中位数 (秒)
+    template <typename FuncType>
+    double MeasureMedianSeconds(int32 Iterations, FuncType&& Func)
+    {
+        Func();
+
+        TArray<double> samples;
+        samples.Reserve(Iterations);
+        for (int32 i = 0; i < Iterations; ++i)
+        {
+            const double startTime = FPlatformTime::Seconds();
+            Func();
+            samples.Add(FPlatformTime::Seconds() - startTime);
+        }
+        Algo::Sort(samples);
+        return samples[samples.Num() / 2];
+    }
+
+    float MaxAbsError(TConstArrayView<FVector3f> Result, TConstArrayView<FVector> Reference)
+    {
+        float maxError = 0.0f;
+        for (int32 i = 0; i < Result.Num(); ++i)
+        {
+            maxError = FMath::Max(maxError, static_cast<float>((FVector(Result[i]) - Reference[i]).GetAbsMax()));
+        }
+        return maxError;
+    }
+
+    // 矩阵数组每次映射流经内存的字节数，批量映射时由各实例分摊
+    int64 GetMatrixBytes(const FSparseMappingMatrix& Matrix)
+    {
+        const int64 numNonZeros = Matrix.RowPtr.Num() > Matrix.NumRow ? Matrix.RowPtr[Matrix.NumRow] : 0;
+        int64 entryBytes = sizeof(int32) + sizeof(float);
+        if (Matrix.StorageMode == EMappingStorageMode::Compact16)
+        {
+            entryBytes = sizeof(uint16) + sizeof(uint16);
+        }
+        else if (Matrix.StorageMode == EMappingStorageMode::Compact8)
+        {
+            entryBytes = sizeof(uint16) + sizeof(uint8);
+        }
+        // 定宽内核不读取 RowPtr
+        const int64 rowPtrBytes = Matrix.FixedRowWidth > 0 ? 0 : Matrix.RowPtr.Num() * sizeof(int32);
+        return rowPtrBytes + numNonZeros * entryBytes;
+    }
+
+    // 每个实例按非零元 gather 的低模偏移与写出的高模偏移
+    int64 GetInstanceBytes(const FSparseMappingMatrix& Matrix)
+    {
+        const int64 numNonZeros = Matrix.RowPtr.Num() > Matrix.NumRow ? Matrix.RowPtr[Matrix.NumRow] : 0;
+        return numNonZeros * 3 * sizeof(float) + Matrix.NumRow * sizeof(FVector3f);
+    }
+
+    struct FBenchmarkReport
+    {
+        const TCHAR* MatrixName;
+        int32 NumRow;
+        double ReferenceSeconds{0.0};
+        int32 NumFailures{0};
+
+        void Add(const FString& Variant, double Seconds, int64 Bytes, float MaxError, float Tolerance)
+        {
+            const bool bPassed = MaxError <= Tolerance;
+            NumFailures += bPassed ? 0 : 1;
+            UE_LOG(LogTemp, Display, TEXT("%-12s rows=%-7d %-24s %9.2f ns/row %7.2f GB/s  x%-6.2f err=%.2e %s"),
+                   MatrixName, NumRow, *Variant, Seconds * 1e9 / NumRow, Bytes / Seconds / 1e9,
+                   ReferenceSeconds / Seconds, MaxError, bPassed ? TEXT("OK") : TEXT("FAILED"));
+        }
+    };
+
+    // 从 CSR 还原三元组，用于对比 SetFromTriplet 与流式构建
+    TArray<FTriplet> ExtractTriplets(const FSparseMappingMatrix& Matrix)
+    {
+        TArray<FTriplet> triplets;
+        triplets.Reserve(Matrix.ColIndice.Num());
+        for (int32 row = 0; row < Matrix.NumRow; ++row)
+        {
+            for (int32 i = Matrix.RowPtr[row]; i < Matrix.RowPtr[row + 1]; ++i)
+            {
+                // 定宽布局补齐的零权重不是原始数据
+                if (Matrix.Value[i] != 0.0f)
+                {
+                    triplets.Emplace(row, Matrix.ColIndice[i], Matrix.Value[i]);
+                }
+            }
+        }
+        return triplets;
+    }
+
+    int32 RunMatrixBenchmark(const FSyntheticMatrixDesc& Desc, int32 NumRow, int32 Iterations, FRandomStream& Random)
+    {
+        FBenchmarkReport report{Desc.Name, NumRow};
+
+        const double buildStart = FPlatformTime::Seconds();
+        const FSparseMappingMatrix matrix = BuildSyntheticMatrix(Desc, NumRow, Random);
+        const double streamedBuildSeconds = FPlatformTime::Seconds() - buildStart;
+        const int32 numCol = matrix.NumCol;
+
+        // --- 构建：SetFromTriplet 与流式构建的结果必须一致 ---
+        {
+            const TArray<FTriplet> triplets = ExtractTriplets(matrix);
+            FSparseMappingMatrix tripletMatrix(NumRow, numCol);
+            const double tripletStart = FPlatformTime::Seconds();
+            tripletMatrix.SetFromTriplet(triplets);
+            const double tripletSeconds = FPlatformTime::Seconds() - tripletStart;
+
+            const bool bSame = tripletMatrix.RowPtr == matrix.RowPtr && tripletMatrix.ColIndice == matrix.ColIndice && tripletMatrix.Value == matrix.Value;
+            report.NumFailures += bSame ? 0 : 1;
+            UE_LOG(LogTemp, Display, TEXT("%-12s rows=%-7d build: streamed %.2f ms (incl. generation), SetFromTriplet %.2f ms, layout %s %s"),
+                   Desc.Name, NumRow, streamedBuildSeconds * 1e3, tripletSeconds * 1e3,
+                   matrix.FixedRowWidth > 0 ? *FString::Printf(TEXT("ELL K=%d"), matrix.FixedRowWidth) : TEXT("CSR"),
+                   bSame ? TEXT("OK") : TEXT("FAILED"));
+        }
+
+        TArray<float> lowRes;
+        lowRes.SetNumUninitialized(numCol * 3);
+        for (float& value : lowRes)
+        {
+            value = Random.FRandRange(-1.0f, 1.0f);
+        }
+        TArray<FVector> lowResDouble;
+        lowResDouble.SetNumUninitialized(numCol);
+        for (int32 col = 0; col < numCol; ++col)
+        {
+            lowResDouble[col] = FVector(lowRes[col * 3], lowRes[col * 3 + 1], lowRes[col * 3 + 2]);
+        }
+
+        // --- 参考：双精度标量路径 ---
+        const int64 streamedBytes = GetMatrixBytes(matrix) + GetInstanceBytes(matrix);
+
+        TArray<FVector> reference;
+        report.ReferenceSeconds = MeasureMedianSeconds(Iterations, [&]() { matrix.ApplyMapping(lowResDouble, reference); });
+        report.Add(TEXT("Reference (double)"), report.ReferenceSeconds, streamedBytes, 0.0f, 0.0f);
+        TArray<FVector3f> highRes;
+        highRes.SetNumZeroed(NumRow);
+
+        // --- 单精度串行 (按布局选择 ELL 特化内核或 CSR 内核) ---
+        {
+            bool bOk = true;
+            const double seconds = MeasureMedianSeconds(Iterations, [&]() { bOk &= matrix.ApplyMapping(lowRes, highRes); });
+            const FString variant = matrix.FixedRowWidth > 0 ? FString::Printf(TEXT("Float ELL K=%d"), matrix.FixedRowWidth) : FString(TEXT("Float CSR"));
+            report.Add(variant, seconds, streamedBytes, bOk ? MaxAbsError(highRes, reference) : MAX_flt, FloatTolerance);
+        }
+
+        // --- 并行 ---
+        {
+            bool bOk = true;
+            FMemory::Memzero(highRes.GetData(), highRes.Num() * sizeof(FVector3f));
+            const double seconds = MeasureMedianSeconds(Iterations, [&]() { bOk &= matrix.ApplyMappingParallel(lowRes, highRes); });
+            report.Add(TEXT("Parallel"), seconds, streamedBytes, bOk ? MaxAbsError(highRes, reference) : MAX_flt, FloatTolerance);
+        }
+
+        // --- 批量：各实例输入相同，耗时按单个实例折算 ---
+        {
+            TArray<TArray<FVector3f>> batchOutputs;
+            batchOutputs.SetNum(BatchInstances);
+            TArray<FMappingBatchItem> items;
+            for (TArray<FVector3f>& output : batchOutputs)
+            {
+                output.SetNumZeroed(NumRow);
+                items.Add({ lowRes, output });
+            }
+
+            bool bOk = true;
+            const double seconds = MeasureMedianSeconds(Iterations, [&]() { bOk &= matrix.ApplyMappingBatched(items); }) / BatchInstances;
+            float maxError = 0.0f;
+            for (const TArray<FVector3f>& output : batchOutputs)
+            {
+                maxError = FMath::Max(maxError, MaxAbsError(output, reference));
+            }
+            const int64 perInstanceBytes = GetMatrixBytes(matrix) / BatchInstances + GetInstanceBytes(matrix);
+            report.Add(FString::Printf(TEXT("Batched x%d (per inst.)"), BatchInstances), seconds, perInstanceBytes, bOk ? maxError : MAX_flt, FloatTolerance);
+        }
+
+        // --- 增量：每帧 1% 的低模顶点变化，阈值为 0 时结果必须与完整映射一致 ---
+        {
+            TArray<float> changedLowRes = lowRes;
+            TArray<FVector> changedLowResDouble = lowResDouble;
+            const int32 numChanged = FMath::Max(1, static_cast<int32>(numCol * IncrementalChangeRatio));
+            for (int32 i = 0; i < numChanged; ++i)
+            {
+                const int32 col = Random.RandRange(0, numCol - 1);
+                const FVector delta(Random.FRandRange(-0.1f, 0.1f), Random.FRandRange(-0.1f, 0.1f), Random.FRandRange(-0.1f, 0.1f));
+                changedLowResDouble[col] += delta;
+                for (int32 axis = 0; axis < 3; ++axis)
+                {
+                    changedLowRes[col * 3 + axis] = static_cast<float>(changedLowResDouble[col][axis]);
+                    changedLowResDouble[col][axis] = changedLowRes[col * 3 + axis];
+                }
+            }
+            TArray<FVector> changedReference;
+            matrix.ApplyMapping(changedLowResDouble, changedReference);
+
+            TArray<float> applied;
+            TBitArray<> rowScratch;
+            bool bUseChanged = false;
+            int32 totalMappedRows = 0;
+            int32 numCalls = 0;
+            matrix.ApplyMappingIncremental(lowRes, applied, 0.0f, highRes, rowScratch);
+            const double seconds = MeasureMedianSeconds(Iterations, [&]()
+                {
+                    bUseChanged = !bUseChanged;
+                    totalMappedRows += FMath::Max(0, matrix.ApplyMappingIncremental(bUseChanged ? changedLowRes : lowRes, applied, 0.0f, highRes, rowScratch));
+                    ++numCalls;
+                });
+            const int32 mappedRows = matrix.ApplyMappingIncremental(changedLowRes, applied, 0.0f, highRes, rowScratch);
+            const float maxError = mappedRows == INDEX_NONE ? MAX_flt : MaxAbsError(highRes, changedReference);
+            report.Add(FString::Printf(TEXT("Incremental %.0f%% (%d rows)"), IncrementalChangeRatio * 100.0f, totalMappedRows / FMath::Max(1, numCalls)),
+                       seconds, streamedBytes, maxError, FloatTolerance);
+        }
+
+        // --- 烘焙时列重排，含每帧重排模型输出的开销 ---
+        {
+            FSparseMappingMatrix reordered = matrix;
+            reordered.ReorderColumnsForLocality();
+            TArray<float> permuteScratch;
+            bool bOk = true;
+            const double seconds = MeasureMedianSeconds(Iterations, [&]()
+                {
+                    bOk &= reordered.ApplyMapping(reordered.PermuteLowResOffsets(lowRes, permuteScratch), highRes);
+                });
+            report.Add(TEXT("Reordered columns"), seconds, GetMatrixBytes(reordered) + GetInstanceBytes(reordered), bOk ? MaxAbsError(highRes, reference) : MAX_flt, FloatTolerance);
+        }
+
+        // --- 压缩存储，容差为压缩时测得的误差上界 ---
+        for (EMappingStorageMode mode : { EMappingStorageMode::Compact16, EMappingStorageMode::Compact8 })
+        {
+            FSparseMappingMatrix compressed = matrix;
+            const FString variant = StaticEnum<EMappingStorageMode>()->GetNameStringByValue(static_cast<int64>(mode));
+            if (!compressed.Compress(mode))
+            {
+                report.Add(variant, 1.0, 0, MAX_flt, 0.0f);
+                continue;
+            }
+
+            bool bOk = true;
+            const double seconds = MeasureMedianSeconds(Iterations, [&]() { bOk &= compressed.ApplyMapping(lowRes, highRes); });
+            report.Add(variant, seconds, GetMatrixBytes(compressed) + GetInstanceBytes(compressed), bOk ? MaxAbsError(highRes, reference) : MAX_flt,
+                       compressed.QuantizationErrorBound + FloatTolerance);
+        }
+
+        return report.NumFailures;
+    }
+}
+
+UClothMappingBenchmarkCommandlet::UClothMappingBenchmarkCommandlet()
+{
+    IsClient = false;
+    IsServer = false;
+    IsEditor = false;
+    LogToConsole = true;
+}
+
+int32 UClothMappingBenchmarkCommandlet::Main(const FString& Params)
+{
+    TArray<int32> rowCounts = { 10000, 50000, 250000 };
+    FString rowsParam;
+    if (FParse::Value(*Params, TEXT("Rows="), rowsParam))
+    {
+        TArray<FString> rowStrings;
+        rowsParam.ParseIntoArray(rowStrings, TEXT(","));
+        rowCounts.Reset();
+        for (const FString& rowString : rowStrings)
+        {
+            rowCounts.Add(FMath::Max(1, FCString::Atoi(*rowString)));
+        }
+    }
+
+    int32 iterations = 20;
+    FParse::Value(*Params, TEXT("Iterations="), iterations);
+    iterations = FMath::Max(1, iterations);
+
+    int32 seed = 1;
+    FParse::Value(*Params, TEXT("Seed="), seed);
+    FRandomStream random(seed);
+
+    int32 numFailures = 0;
+    for (const int32 numRow : rowCounts)
+    {
+        for (const FSyntheticMatrixDesc& desc : SyntheticMatrices)
+        {
+            numFailures += RunMatrixBenchmark(desc, numRow, iterations, random);
+        }
+    }
+
+    if (numFailures > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ClothMappingBenchmark: %d 项一致性检查失败"), numFailures);
+        return 1;
+    }
+    UE_LOG(LogTemp, Display, TEXT("ClothMappingBenchmark: 全部一致性检查通过"));
+    return 0;
+}
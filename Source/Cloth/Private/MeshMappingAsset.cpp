@@ -0,0 +1,41 @@
+#include "MeshMappingAsset.h"
+#include "ClothDeformerStats.h"
+#include "RenderingThread.h"
+
+void UMeshMappingAsset::PostLoad()
+{
+    Super::PostLoad();
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
+
+    // 旧资产没有序列化布局信息，加载时重新选择一次 (已是定宽布局时结果不变)
+    MappingData.UpdateStorageLayout();
+    if (MappingData.ColPtr.Num() != MappingData.NumCol + 1)
+    {
+        MappingData.BuildTranspose();
+    }
+}
+
+void UMeshMappingAsset::Serialize(FArchive& Ar)
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
+    Super::Serialize(Ar);
+}
+
+void UMeshMappingAsset::BeginDestroy()
+{
+    Super::BeginDestroy();
+    ReleaseFence.BeginFence();
+}
+
+bool UMeshMappingAsset::IsReadyForFinishDestroy()
+{
+    return Super::IsReadyForFinishDestroy() && ReleaseFence.IsFenceComplete();
+}
+
+#if WITH_EDITOR
+void UMeshMappingAsset::PreEditChange(FProperty* PropertyAboutToChange)
+{
+    Super::PreEditChange(PropertyAboutToChange);
+    FlushRenderingCommands();
+}
+#endif
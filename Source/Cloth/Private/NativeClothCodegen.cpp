@@ -0,0 +1,567 @@
+#include "NativeClothModel.h"
+
+#if WITH_EDITOR
+
+namespace
+{
+    // 生成代码中 Run 函数体的缩进
+    const TCHAR* const Indent = TEXT("            ");
+
+    int64 NumElements(TConstArrayView<int64> Shape)
+    {
+        int64 count = 1;
+        for (int64 dim : Shape)
+        {
+            count *= dim;
+        }
+        return count;
+    }
+
+    FString ShapeToString(TConstArrayView<int64> Shape)
+    {
+        TArray<FString> dims;
+        for (int64 dim : Shape)
+        {
+            dims.Add(FString::Printf(TEXT("%lld"), dim));
+        }
+        return FString::Printf(TEXT("[%s]"), *FString::Join(dims, TEXT(", ")));
+    }
+
+    // 与 FNativeClothModel::EOp 的顺序一致，用于生成代码中的注释
+    const TCHAR* const OpNames[] = {
+        TEXT("Gemm"), TEXT("MatMul"),
+        TEXT("Add"), TEXT("Sub"), TEXT("Mul"), TEXT("Div"),
+        TEXT("Relu"), TEXT("LeakyRelu"), TEXT("Elu"), TEXT("Tanh"), TEXT("Sigmoid"),
+        TEXT("Identity"), TEXT("Reshape"), TEXT("Flatten"), TEXT("Squeeze"), TEXT("Unsqueeze"), TEXT("Concat"), TEXT("Transpose"),
+        TEXT("GRU"), TEXT("LSTM"),
+    };
+
+    // 可以直接写进源码的 float 字面量
+    FString FloatLiteral(float Value)
+    {
+        FString text = FString::Printf(TEXT("%.9g"), Value);
+        if (!text.Contains(TEXT(".")) && !text.Contains(TEXT("e")))
+        {
+            text += TEXT(".0");
+        }
+        return text + TEXT("f");
+    }
+
+    // Small 去掉前导的 1 后与 Shape 的末尾几维相同，即按行广播
+    bool IsRowBroadcast(TConstArrayView<int64> Small, TConstArrayView<int64> Shape)
+    {
+        int32 first = 0;
+        while (first < Small.Num() && Small[first] == 1)
+        {
+            ++first;
+        }
+        const int32 rank = Small.Num() - first;
+        if (rank > Shape.Num())
+        {
+            return false;
+        }
+        for (int32 i = 0; i < rank; ++i)
+        {
+            if (Small[first + i] != Shape[Shape.Num() - rank + i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+/**
+ * FNativeClothCodeGenerator
+ * 把导入后的节点序列展开为 IClothGeneratedEvaluator 的源码：中间结果是定长成员数组，只改变形状的算子直接复用输入，
+ * 其余算子调用 NativeClothKernels.h 中的内核并以常量传入尺寸
+ */
+class FNativeClothCodeGenerator
+{
+public:
+    explicit FNativeClothCodeGenerator(const FNativeClothModel& InModel) : Model(InModel) {}
+
+    bool Generate(const FString& ClassName, TConstArrayView<TArray<int64>> InputShapes, FString& OutSource, FString& OutError)
+    {
+        if (!InferShapes(InputShapes, OutError))
+        {
+            return false;
+        }
+
+        for (int32 i = 0; i < Model.InputValues.Num(); ++i)
+        {
+            Exprs[Model.InputValues[i]] = FString::Printf(TEXT("Inputs[%d].GetData()"), i);
+        }
+
+        for (int32 n = 0; n < Model.Nodes.Num(); ++n)
+        {
+            if (!EmitNode(Model.Nodes[n], n, OutError))
+            {
+                return false;
+            }
+        }
+
+        // 输出：拷贝到调用方的数组，尺寸不变时不重新分配
+        for (int32 i = 0; i < Model.OutputValues.Num(); ++i)
+        {
+            const int32 value = Model.OutputValues[i];
+            Body += FString::Printf(TEXT("\n%s// 输出 %s %s\n"), Indent, *Model.Outputs[i].Name, *ShapeToString(Shapes[value]));
+            Body += FString::Printf(TEXT("%sOutputs[%d]->SetNumUninitialized(%lld, EAllowShrinking::No);\n"), Indent, i, Count(value));
+            Body += FString::Printf(TEXT("%sFMemory::Memcpy(Outputs[%d]->GetData(), %s, %lld * sizeof(float));\n"), Indent, i, *Use(value), Count(value));
+        }
+
+        auto JoinSizes = [this](TConstArrayView<int32> Values)
+        {
+            TArray<FString> sizes;
+            for (int32 value : Values)
+            {
+                sizes.Add(FString::Printf(TEXT("%lld"), Count(value)));
+            }
+            return FString::Join(sizes, TEXT(", "));
+        };
+
+        TArray<FString> binds;
+        FString constantMembers;
+        for (int32 value : UsedConstants)
+        {
+            binds.Add(FString::Printf(TEXT("BindConstant(Model, %d, %lld, W%d)"), value, Count(value), value));
+            constantMembers += FString::Printf(TEXT("        const float* W%d{nullptr};\n"), value);
+        }
+
+        OutSource = FString::Printf(TEXT(
+            "// %s.cpp\n"
+            "// 由 UClothDeformationModelAsset::GenerateNativeEvaluator 从 CRC 为 0x%08X 的模型数据生成，不要手动修改。\n"
+            "// 模型数据变化后需要重新生成，否则运行时找不到匹配的求值器而回退到解释执行\n"
+            "\n"
+            "#include \"ClothGeneratedEvaluator.h\"\n"
+            "#include \"NativeClothModel.h\"\n"
+            "#include \"NativeClothKernels.h\"\n"
+            "#include <cmath>\n"
+            "\n"
+            "namespace\n"
+            "{\n"
+            "    class %s final : public IClothGeneratedEvaluator\n"
+            "    {\n"
+            "    public:\n"
+            "        virtual bool Bind(const FNativeClothModel& Model) override\n"
+            "        {\n"
+            "            return %s;\n"
+            "        }\n"
+            "\n"
+            "        virtual TConstArrayView<int64> GetInputSizes() const override\n"
+            "        {\n"
+            "            static constexpr int64 Sizes[] = {%s};\n"
+            "            return Sizes;\n"
+            "        }\n"
+            "\n"
+            "        virtual TConstArrayView<int64> GetOutputSizes() const override\n"
+            "        {\n"
+            "            static constexpr int64 Sizes[] = {%s};\n"
+            "            return Sizes;\n"
+            "        }\n"
+            "\n"
+            "        virtual void Run(TConstArrayView<TConstArrayView<float>> Inputs, TConstArrayView<TArray<float>*> Outputs) override\n"
+            "        {\n"
+            "%s"
+            "        }\n"
+            "\n"
+            "    private:\n"
+            "%s"
+            "%s"
+            "    };\n"
+            "}\n"
+            "\n"
+            "CLOTH_REGISTER_GENERATED_EVALUATOR(0x%08Xu, %s);\n"),
+            *ClassName, Model.DataCrc, *ClassName,
+            binds.Num() > 0 ? *FString::Join(binds, TEXT(" &&\n                   ")) : TEXT("true"),
+            *JoinSizes(Model.InputValues), *JoinSizes(Model.OutputValues),
+            *Body, *constantMembers, *Members,
+            Model.DataCrc, *ClassName);
+        return true;
+    }
+
+private:
+    using EOp = FNativeClothModel::EOp;
+    using FNode = FNativeClothModel::FNode;
+
+    const FNativeClothModel& Model;
+    // 每个值的形状 (试运行得到) 与生成代码中读取它的表达式
+    TArray<TArray<int64>> Shapes;
+    TArray<FString> Exprs;
+    // 用到的常量，按首次使用的顺序
+    TArray<int32> UsedConstants;
+    FString Members;
+    FString Body;
+
+    int64 Count(int32 Value) const
+    {
+        return NumElements(Shapes[Value]);
+    }
+
+    FString Use(int32 Value)
+    {
+        if (Model.IsConstant[Value])
+        {
+            UsedConstants.AddUnique(Value);
+        }
+        return Exprs[Value];
+    }
+
+    // 为值分配定长的成员数组
+    FString Allocate(int32 Value)
+    {
+        Exprs[Value] = FString::Printf(TEXT("V%d"), Value);
+        Members += FString::Printf(TEXT("        alignas(16) float V%d[%lld];\n"), Value, FMath::Max<int64>(Count(Value), 1));
+        return Exprs[Value];
+    }
+
+    void EmitLoop(int64 Num, const FString& Statement)
+    {
+        Body += FString::Printf(TEXT("%sfor (int64 i = 0; i < %lld; ++i)\n%s{\n%s    %s\n%s}\n"), Indent, Num, Indent, Indent, *Statement, Indent);
+    }
+
+    // 用零输入以给定形状运行一次，记录所有值的形状
+    bool InferShapes(TConstArrayView<TArray<int64>> InputShapes, FString& OutError)
+    {
+        if (InputShapes.Num() != Model.Inputs.Num() || Model.Outputs.Num() == 0)
+        {
+            OutError = FString::Printf(TEXT("Expected shapes for %d inputs."), Model.Inputs.Num());
+            return false;
+        }
+
+        TArray<TArray<float>> inputData;
+        TArray<TConstArrayView<float>> inputViews;
+        std::vector<std::vector<int64_t>> inputShapes;
+        for (int32 i = 0; i < InputShapes.Num(); ++i)
+        {
+            for (int64 dim : InputShapes[i])
+            {
+                if (dim <= 0)
+                {
+                    OutError = FString::Printf(TEXT("Input %s has a dynamic dimension, generated evaluators need fixed shapes."), *Model.Inputs[i].Name);
+                    return false;
+                }
+            }
+            inputData.Emplace_GetRef().SetNumZeroed(static_cast<int32>(NumElements(InputShapes[i])));
+            inputShapes.emplace_back(InputShapes[i].begin(), InputShapes[i].end());
+        }
+        for (const TArray<float>& data : inputData)
+        {
+            inputViews.Add(data);
+        }
+
+        TArray<TArray<float>> outputData;
+        outputData.SetNum(Model.Outputs.Num());
+        TArray<TArray<float>*> outputViews;
+        for (TArray<float>& data : outputData)
+        {
+            outputViews.Add(&data);
+        }
+
+        FNativeClothRunContext context;
+        if (!Model.Run(context, inputViews, TConstArrayView<std::vector<int64_t>>(inputShapes.data(), static_cast<int32>(inputShapes.size())), outputViews))
+        {
+            OutError = TEXT("The model failed to run on the given input shapes.");
+            return false;
+        }
+
+        Shapes.SetNum(Model.NumValues);
+        Exprs.SetNum(Model.NumValues);
+        for (int32 value = 0; value < Model.NumValues; ++value)
+        {
+            Shapes[value] = Model.IsConstant[value] ? Model.Constants[value].Shape : context.Values[value].Shape;
+            Exprs[value] = Model.IsConstant[value] ? FString::Printf(TEXT("W%d"), value) : FString();
+        }
+        return true;
+    }
+
+    bool EmitNode(const FNode& Node, int32 NodeIndex, FString& OutError)
+    {
+        const int32 a = Node.Inputs[0];
+        const int32 out = Node.Outputs[0];
+        Body += FString::Printf(TEXT("\n%s// [%d] %s %s -> %s\n"), Indent, NodeIndex, OpNames[static_cast<int32>(Node.Op)], *ShapeToString(Shapes[a]),
+                                out != INDEX_NONE ? *ShapeToString(Shapes[out]) : TEXT("-"));
+
+        switch (Node.Op)
+        {
+        case EOp::Gemm:
+        case EOp::MatMul:
+            return EmitMatMul(Node, OutError);
+        case EOp::Add: return EmitBinary(Node, TEXT("+"), OutError);
+        case EOp::Sub: return EmitBinary(Node, TEXT("-"), OutError);
+        case EOp::Mul: return EmitBinary(Node, TEXT("*"), OutError);
+        case EOp::Div: return EmitBinary(Node, TEXT("/"), OutError);
+        case EOp::Relu: return EmitUnary(Node, TEXT("x > 0.0f ? x : 0.0f"));
+        case EOp::LeakyRelu: return EmitUnary(Node, FString::Printf(TEXT("x >= 0.0f ? x : %s * x"), *FloatLiteral(Node.Alpha)));
+        case EOp::Elu: return EmitUnary(Node, FString::Printf(TEXT("x >= 0.0f ? x : %s * (std::exp(x) - 1.0f)"), *FloatLiteral(Node.Alpha)));
+        case EOp::Tanh: return EmitUnary(Node, TEXT("std::tanh(x)"));
+        case EOp::Sigmoid: return EmitUnary(Node, TEXT("ClothNativeKernels::Sigmoid(x)"));
+        case EOp::Identity:
+        case EOp::Reshape:
+        case EOp::Flatten:
+        case EOp::Squeeze:
+        case EOp::Unsqueeze:
+            // 数据不变，直接读输入
+            Exprs[out] = Use(a);
+            return true;
+        case EOp::Concat: return EmitConcat(Node, OutError);
+        case EOp::Transpose: return EmitTranspose(Node);
+        case EOp::GRU:
+        case EOp::LSTM:
+            return EmitRecurrent(Node, NodeIndex);
+        default:
+            OutError = FString::Printf(TEXT("Operator %d cannot be generated."), static_cast<int32>(Node.Op));
+            return false;
+        }
+    }
+
+    bool EmitMatMul(const FNode& Node, FString& OutError)
+    {
+        const int32 a = Node.Inputs[0];
+        const int32 b = Node.Inputs[1];
+        const int64 k = Shapes[b][0];
+        const int64 n = Shapes[b][1];
+        const int64 m = Count(a) / k;
+        const FString y = Allocate(Node.Outputs[0]);
+
+        const int32 c = Node.Op == EOp::Gemm && Node.Inputs.IsValidIndex(2) ? Node.Inputs[2] : INDEX_NONE;
+        if (c == INDEX_NONE || Node.Beta == 0.0f)
+        {
+            Body += FString::Printf(TEXT("%sFMemory::Memzero(%s, %lld * sizeof(float));\n"), Indent, *y, m * n);
+        }
+        else if (Count(c) == n)
+        {
+            Body += FString::Printf(TEXT("%sClothNativeKernels::FillRows(%s, %lld, %lld, %s, %lld);\n"), Indent, *y, n, m, *Use(c), n);
+        }
+        else if (Count(c) == m * n)
+        {
+            Body += FString::Printf(TEXT("%sFMemory::Memcpy(%s, %s, %lld * sizeof(float));\n"), Indent, *y, *Use(c), m * n);
+        }
+        else if (Count(c) == 1 || Count(c) == m)
+        {
+            EmitLoop(m * n, FString::Printf(TEXT("%s[i] = %s[%s];"), *y, *Use(c), Count(c) == 1 ? TEXT("0") : *FString::Printf(TEXT("i / %lld"), n)));
+        }
+        else
+        {
+            OutError = TEXT("Gemm bias cannot be broadcast to the output.");
+            return false;
+        }
+        if (c != INDEX_NONE && Node.Beta != 1.0f && Node.Beta != 0.0f)
+        {
+            EmitLoop(m * n, FString::Printf(TEXT("%s[i] *= %s;"), *y, *FloatLiteral(Node.Beta)));
+        }
+        Body += FString::Printf(TEXT("%sClothNativeKernels::MatMulAccumulate(%s, %lld, %s, %lld, %s, %lld, %lld, %lld, %lld, %s);\n"),
+                                Indent, *Use(a), k, *Use(b), n, *y, n, m, k, n, *FloatLiteral(Node.Alpha));
+        return true;
+    }
+
+    bool EmitBinary(const FNode& Node, const TCHAR* Operator, FString& OutError)
+    {
+        const int32 a = Node.Inputs[0];
+        const int32 b = Node.Inputs[1];
+        const int32 out = Node.Outputs[0];
+        const int64 na = Count(a);
+        const int64 nb = Count(b);
+        const int64 no = Count(out);
+        const FString x = Use(a);
+        const FString z = Use(b);
+        const FString y = Allocate(out);
+
+        if (na == no && nb == no)
+        {
+            EmitLoop(no, FString::Printf(TEXT("%s[i] = %s[i] %s %s[i];"), *y, *x, Operator, *z));
+        }
+        else if (nb == 1)
+        {
+            EmitLoop(no, FString::Printf(TEXT("%s[i] = %s[i] %s %s[0];"), *y, *x, Operator, *z));
+        }
+        else if (na == 1)
+        {
+            EmitLoop(no, FString::Printf(TEXT("%s[i] = %s[0] %s %s[i];"), *y, *x, Operator, *z));
+        }
+        else if (na == no && IsRowBroadcast(Shapes[b], Shapes[out]))
+        {
+            EmitLoop(no, FString::Printf(TEXT("%s[i] = %s[i] %s %s[i %% %lld];"), *y, *x, Operator, *z, nb));
+        }
+        else if (nb == no && IsRowBroadcast(Shapes[a], Shapes[out]))
+        {
+            EmitLoop(no, FString::Printf(TEXT("%s[i] = %s[i %% %lld] %s %s[i];"), *y, *x, na, Operator, *z));
+        }
+        else
+        {
+            OutError = FString::Printf(TEXT("Broadcasting %s with %s is not supported by generated evaluators."), *ShapeToString(Shapes[a]), *ShapeToString(Shapes[b]));
+            return false;
+        }
+        return true;
+    }
+
+    bool EmitUnary(const FNode& Node, const FString& Expression)
+    {
+        const FString x = Use(Node.Inputs[0]);
+        const FString y = Allocate(Node.Outputs[0]);
+        EmitLoop(Count(Node.Outputs[0]), FString::Printf(TEXT("const float x = %s[i]; %s[i] = %s;"), *x, *y, *Expression));
+        return true;
+    }
+
+    bool EmitConcat(const FNode& Node, FString& OutError)
+    {
+        const int32 out = Node.Outputs[0];
+        const TArray<int64>& shape = Shapes[out];
+        const int64 axis = Node.Axis < 0 ? Node.Axis + shape.Num() : Node.Axis;
+        if (axis < 0 || axis >= shape.Num())
+        {
+            OutError = TEXT("Concat axis is out of range.");
+            return false;
+        }
+        const int64 outer = NumElements(TConstArrayView<int64>(shape.GetData(), static_cast<int32>(axis)));
+        const int64 total = outer > 0 ? Count(out) / outer : 0;
+
+        TArray<FString> parts;
+        for (int32 value : Node.Inputs)
+        {
+            parts.Add(Use(value));
+        }
+        const FString y = Allocate(out);
+
+        Body += FString::Printf(TEXT("%sfor (int64 o = 0; o < %lld; ++o)\n%s{\n"), Indent, outer, Indent);
+        int64 offset = 0;
+        for (int32 i = 0; i < Node.Inputs.Num(); ++i)
+        {
+            const int64 chunk = outer > 0 ? Count(Node.Inputs[i]) / outer : 0;
+            Body += FString::Printf(TEXT("%s    FMemory::Memcpy(%s + o * %lld + %lld, %s + o * %lld, %lld * sizeof(float));\n"),
+                                    Indent, *y, total, offset, *parts[i], chunk, chunk);
+            offset += chunk;
+        }
+        Body += FString::Printf(TEXT("%s}\n"), Indent);
+        return true;
+    }
+
+    // 长度为 1 的维度不参与循环；剩余维度的读取顺序与存储顺序一致时不需要拷贝
+    bool EmitTranspose(const FNode& Node)
+    {
+        const int32 a = Node.Inputs[0];
+        const int32 out = Node.Outputs[0];
+        const TArray<int64>& inShape = Shapes[a];
+        const int32 rank = inShape.Num();
+
+        TArray<int64> inStrides;
+        inStrides.SetNum(rank);
+        int64 stride = 1;
+        for (int32 i = rank - 1; i >= 0; --i)
+        {
+            inStrides[i] = stride;
+            stride *= inShape[i];
+        }
+
+        // 试运行已校验过 perm
+        TArray<TPair<int64, int64>> loops;
+        for (int32 i = 0; i < rank; ++i)
+        {
+            int64 source = Node.Ints.Num() > 0 ? Node.Ints[i] : rank - 1 - i;
+            source = source < 0 ? source + rank : source;
+            if (inShape[source] > 1)
+            {
+                loops.Emplace(inShape[source], inStrides[source]);
+            }
+        }
+
+        bool bContiguous = true;
+        int64 expected = 1;
+        for (int32 i = loops.Num() - 1; i >= 0; --i)
+        {
+            bContiguous &= loops[i].Value == expected;
+            expected *= loops[i].Key;
+        }
+        if (bContiguous)
+        {
+            Exprs[out] = Use(a);
+            return true;
+        }
+
+        const FString x = Use(a);
+        const FString y = Allocate(out);
+        Body += FString::Printf(TEXT("%s{\n%s    float* out = %s;\n"), Indent, Indent, *y);
+        FString indent = FString(Indent) + TEXT("    ");
+        TArray<FString> terms;
+        for (int32 i = 0; i < loops.Num(); ++i)
+        {
+            Body += FString::Printf(TEXT("%sfor (int64 i%d = 0; i%d < %lld; ++i%d)\n%s{\n"), *indent, i, i, loops[i].Key, i, *indent);
+            terms.Add(FString::Printf(TEXT("i%d * %lld"), i, loops[i].Value));
+            indent += TEXT("    ");
+        }
+        Body += FString::Printf(TEXT("%s*out++ = %s[%s];\n"), *indent, *x, *FString::Join(terms, TEXT(" + ")));
+        for (int32 i = loops.Num() - 1; i >= 0; --i)
+        {
+            indent.LeftChopInline(4);
+            Body += FString::Printf(TEXT("%s}\n"), *indent);
+        }
+        Body += FString::Printf(TEXT("%s}\n"), Indent);
+        return true;
+    }
+
+    // 输入为 {X, Wt, Rt, Wb, Rb, initial_h, (initial_c)}，状态与临时缓冲是按节点分配的成员数组
+    bool EmitRecurrent(const FNode& Node, int32 NodeIndex)
+    {
+        const bool bLSTM = Node.Op == EOp::LSTM;
+        const TArray<int64>& xShape = Shapes[Node.Inputs[0]];
+        const int64 seq = xShape[0];
+        const int64 batch = xShape[1];
+        const int64 input = xShape[2];
+        const int64 hidden = Node.HiddenSize;
+        const int64 gateSize = (bLSTM ? 4 : 3) * hidden;
+        const int64 stateSize = batch * hidden;
+
+        Members += FString::Printf(TEXT("        alignas(16) float State%d[%lld];\n"), NodeIndex, 2 * stateSize);
+        Members += FString::Printf(TEXT("        alignas(16) float Gx%d[%lld];\n"), NodeIndex, seq * batch * gateSize);
+        Members += FString::Printf(TEXT("        alignas(16) float Gh%d[%lld];\n"), NodeIndex, batch * gateSize);
+
+        for (int32 i = 0; i < (bLSTM ? 2 : 1); ++i)
+        {
+            const int32 initial = Node.Inputs[5 + i];
+            if (initial == INDEX_NONE)
+            {
+                Body += FString::Printf(TEXT("%sFMemory::Memzero(State%d + %lld, %lld * sizeof(float));\n"), Indent, NodeIndex, i * stateSize, stateSize);
+            }
+            else
+            {
+                Body += FString::Printf(TEXT("%sFMemory::Memcpy(State%d + %lld, %s, %lld * sizeof(float));\n"), Indent, NodeIndex, i * stateSize, *Use(initial), stateSize);
+            }
+        }
+
+        const FString x = Use(Node.Inputs[0]);
+        const FString wt = Use(Node.Inputs[1]);
+        const FString rt = Use(Node.Inputs[2]);
+        const FString wb = Use(Node.Inputs[3]);
+        const FString rb = Use(Node.Inputs[4]);
+        const FString y = Node.Outputs.IsValidIndex(0) && Node.Outputs[0] != INDEX_NONE ? Allocate(Node.Outputs[0]) : FString(TEXT("nullptr"));
+        if (bLSTM)
+        {
+            Body += FString::Printf(TEXT("%sClothNativeKernels::LstmSequence(%s, %lld, %lld, %lld, %lld, %s, %s, %s, %s, State%d, State%d + %lld, %s, Gx%d, Gh%d);\n"),
+                                    Indent, *x, seq, batch, input, hidden, *wt, *rt, *wb, *rb, NodeIndex, NodeIndex, stateSize, *y, NodeIndex, NodeIndex);
+        }
+        else
+        {
+            Body += FString::Printf(TEXT("%sClothNativeKernels::GruSequence(%s, %lld, %lld, %lld, %lld, %s, %s, %s, %s, %s, State%d, %s, Gx%d, Gh%d, State%d + %lld);\n"),
+                                    Indent, *x, seq, batch, input, hidden, *wt, *rt, *wb, *rb, Node.bLinearBeforeReset ? TEXT("true") : TEXT("false"),
+                                    NodeIndex, *y, NodeIndex, NodeIndex, NodeIndex, stateSize);
+        }
+
+        // Y_h 与 LSTM 的 Y_c 直接读状态
+        for (int32 i = 1; i < Node.Outputs.Num() && i <= (bLSTM ? 2 : 1); ++i)
+        {
+            if (Node.Outputs[i] != INDEX_NONE)
+            {
+                Exprs[Node.Outputs[i]] = FString::Printf(TEXT("(State%d + %lld)"), NodeIndex, (i - 1) * stateSize);
+            }
+        }
+        return true;
+    }
+};
+
+bool FNativeClothModel::GenerateEvaluatorSource(const FString& ClassName, TConstArrayView<TArray<int64>> InputShapes, FString& OutSource, FString& OutError) const
+{
+    FNativeClothCodeGenerator generator(*this);
+    return generator.Generate(ClassName, InputShapes, OutSource, OutError);
+}
+
+#endif // WITH_EDITOR
@@ -0,0 +1,199 @@
+// NativeClothKernels.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/VectorRegister.h"
+#include <cmath>
+
+/**
+ * 原生后端的计算内核，FNativeClothModel 的解释执行与 GenerateNativeEvaluator 生成的求值器共用。
+ * 定义放在头文件中，生成代码以常量尺寸调用时编译器可以据此展开与特化循环
+ */
+namespace ClothNativeKernels
+{
+    /**
+     * C[M, N] += Alpha * A[M, K] * B[K, N]，行主序，Ld* 为各矩阵的行跨度。
+     * 沿 N 方向 4 路 SIMD，K 方向每次展开 4 行以减少 C 的读写
+     */
+    inline void MatMulAccumulate(const float* A, int64 Lda, const float* B, int64 Ldb, float* C, int64 Ldc, int64 M, int64 K, int64 N, float Alpha)
+    {
+        const int64 vectorN = N & ~int64(3);
+        for (int64 m = 0; m < M; ++m)
+        {
+            const float* aRow = A + m * Lda;
+            float* cRow = C + m * Ldc;
+
+            int64 k = 0;
+            for (; k + 4 <= K; k += 4)
+            {
+                const float a0 = Alpha * aRow[k];
+                const float a1 = Alpha * aRow[k + 1];
+                const float a2 = Alpha * aRow[k + 2];
+                const float a3 = Alpha * aRow[k + 3];
+                const float* b0 = B + k * Ldb;
+                const float* b1 = b0 + Ldb;
+                const float* b2 = b1 + Ldb;
+                const float* b3 = b2 + Ldb;
+
+                const VectorRegister4Float va0 = VectorSetFloat1(a0);
+                const VectorRegister4Float va1 = VectorSetFloat1(a1);
+                const VectorRegister4Float va2 = VectorSetFloat1(a2);
+                const VectorRegister4Float va3 = VectorSetFloat1(a3);
+                int64 n = 0;
+                for (; n < vectorN; n += 4)
+                {
+                    VectorRegister4Float c = VectorLoad(cRow + n);
+                    c = VectorMultiplyAdd(va0, VectorLoad(b0 + n), c);
+                    c = VectorMultiplyAdd(va1, VectorLoad(b1 + n), c);
+                    c = VectorMultiplyAdd(va2, VectorLoad(b2 + n), c);
+                    c = VectorMultiplyAdd(va3, VectorLoad(b3 + n), c);
+                    VectorStore(c, cRow + n);
+                }
+                for (; n < N; ++n)
+                {
+                    cRow[n] += a0 * b0[n] + a1 * b1[n] + a2 * b2[n] + a3 * b3[n];
+                }
+            }
+            for (; k < K; ++k)
+            {
+                const float a = Alpha * aRow[k];
+                const float* b = B + k * Ldb;
+                const VectorRegister4Float va = VectorSetFloat1(a);
+                int64 n = 0;
+                for (; n < vectorN; n += 4)
+                {
+                    VectorStore(VectorMultiplyAdd(va, VectorLoad(b + n), VectorLoad(cRow + n)), cRow + n);
+                }
+                for (; n < N; ++n)
+                {
+                    cRow[n] += a * b[n];
+                }
+            }
+        }
+    }
+
+    // 把 Bias[N] 复制到 Out[M, N] 的每一行 (行跨度 Ldo)
+    inline void FillRows(float* Out, int64 Ldo, int64 M, const float* Bias, int64 N)
+    {
+        for (int64 m = 0; m < M; ++m)
+        {
+            FMemory::Memcpy(Out + m * Ldo, Bias, N * sizeof(float));
+        }
+    }
+
+    FORCEINLINE float Sigmoid(float X)
+    {
+        return 1.0f / (1.0f + std::exp(-X));
+    }
+
+    /**
+     * 单向 GRU 的整个序列，门顺序 z, r, h。
+     * X[Seq * Batch, Input]，Wt[Input, 3H] / Rt[H, 3H] 为转置后的权重，H[Batch, Hidden] 为就地更新的状态 (调用前写入初始值)。
+     * Y[Seq, Batch, Hidden] 可为空；Gx[Seq * Batch, 3H]、Gh[Batch, 3H]、Rh[Batch, Hidden] 为临时缓冲
+     */
+    inline void GruSequence(const float* X, int64 Seq, int64 Batch, int64 Input, int64 Hidden,
+                            const float* Wt, const float* Rt, const float* Wb, const float* Rb, bool bLinearBeforeReset,
+                            float* H, float* Y, float* Gx, float* Gh, float* Rh)
+    {
+        const int64 gateSize = 3 * Hidden;
+        const int64 stateSize = Batch * Hidden;
+
+        // 所有时间步的输入投影一次算完：Gx = X * Wt + Wb
+        FillRows(Gx, gateSize, Seq * Batch, Wb, gateSize);
+        MatMulAccumulate(X, Input, Wt, gateSize, Gx, gateSize, Seq * Batch, Input, gateSize, 1.0f);
+
+        for (int64 t = 0; t < Seq; ++t)
+        {
+            const float* gxStep = Gx + t * Batch * gateSize;
+            FillRows(Gh, gateSize, Batch, Rb, gateSize);
+
+            // linear_before_reset = 0 时候选门的隐藏投影要在 r⊙h 上计算
+            const int64 firstPass = bLinearBeforeReset ? gateSize : 2 * Hidden;
+            MatMulAccumulate(H, Hidden, Rt, gateSize, Gh, gateSize, Batch, Hidden, firstPass, 1.0f);
+            for (int64 b = 0; b < Batch; ++b)
+            {
+                const float* gxRow = gxStep + b * gateSize;
+                float* ghRow = Gh + b * gateSize;
+                for (int64 j = 0; j < 2 * Hidden; ++j)
+                {
+                    ghRow[j] = Sigmoid(gxRow[j] + ghRow[j]);
+                }
+                if (!bLinearBeforeReset)
+                {
+                    for (int64 j = 0; j < Hidden; ++j)
+                    {
+                        Rh[b * Hidden + j] = ghRow[Hidden + j] * H[b * Hidden + j];
+                    }
+                }
+            }
+            if (!bLinearBeforeReset)
+            {
+                MatMulAccumulate(Rh, Hidden, Rt + 2 * Hidden, gateSize, Gh + 2 * Hidden, gateSize, Batch, Hidden, Hidden, 1.0f);
+            }
+            for (int64 b = 0; b < Batch; ++b)
+            {
+                const float* gxRow = gxStep + b * gateSize;
+                const float* ghRow = Gh + b * gateSize;
+                float* hRow = H + b * Hidden;
+                for (int64 j = 0; j < Hidden; ++j)
+                {
+                    const float z = ghRow[j];
+                    const float r = ghRow[Hidden + j];
+                    const float candidate = bLinearBeforeReset
+                        ? std::tanh(gxRow[2 * Hidden + j] + r * ghRow[2 * Hidden + j])
+                        : std::tanh(gxRow[2 * Hidden + j] + ghRow[2 * Hidden + j]);
+                    hRow[j] = (1.0f - z) * candidate + z * hRow[j];
+                }
+            }
+
+            if (Y)
+            {
+                FMemory::Memcpy(Y + t * stateSize, H, stateSize * sizeof(float));
+            }
+        }
+    }
+
+    /**
+     * 单向 LSTM 的整个序列，门顺序 i, o, f, c。参数与 GruSequence 相同，C[Batch, Hidden] 为就地更新的细胞状态，
+     * Gx 为 [Seq * Batch, 4H]，Gh 为 [Batch, 4H]
+     */
+    inline void LstmSequence(const float* X, int64 Seq, int64 Batch, int64 Input, int64 Hidden,
+                             const float* Wt, const float* Rt, const float* Wb, const float* Rb,
+                             float* H, float* C, float* Y, float* Gx, float* Gh)
+    {
+        const int64 gateSize = 4 * Hidden;
+        const int64 stateSize = Batch * Hidden;
+
+        FillRows(Gx, gateSize, Seq * Batch, Wb, gateSize);
+        MatMulAccumulate(X, Input, Wt, gateSize, Gx, gateSize, Seq * Batch, Input, gateSize, 1.0f);
+
+        for (int64 t = 0; t < Seq; ++t)
+        {
+            const float* gxStep = Gx + t * Batch * gateSize;
+            FillRows(Gh, gateSize, Batch, Rb, gateSize);
+            MatMulAccumulate(H, Hidden, Rt, gateSize, Gh, gateSize, Batch, Hidden, gateSize, 1.0f);
+            for (int64 b = 0; b < Batch; ++b)
+            {
+                const float* gxRow = gxStep + b * gateSize;
+                const float* ghRow = Gh + b * gateSize;
+                float* hRow = H + b * Hidden;
+                float* cRow = C + b * Hidden;
+                for (int64 j = 0; j < Hidden; ++j)
+                {
+                    const float inputGate = Sigmoid(gxRow[j] + ghRow[j]);
+                    const float outputGate = Sigmoid(gxRow[Hidden + j] + ghRow[Hidden + j]);
+                    const float forgetGate = Sigmoid(gxRow[2 * Hidden + j] + ghRow[2 * Hidden + j]);
+                    const float candidate = std::tanh(gxRow[3 * Hidden + j] + ghRow[3 * Hidden + j]);
+                    cRow[j] = forgetGate * cRow[j] + inputGate * candidate;
+                    hRow[j] = outputGate * std::tanh(cRow[j]);
+                }
+            }
+
+            if (Y)
+            {
+                FMemory::Memcpy(Y + t * stateSize, H, stateSize * sizeof(float));
+            }
+        }
+    }
+}
@@ -0,0 +1,1420 @@
+#include "NativeClothModel.h"
+#include "NativeClothKernels.h"
+#include "ClothDeformerStats.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include <cmath>
+
+namespace
+{
+    using FTensor = FNativeClothRunContext::FTensor;
+    using FShape = TArray<int64, TInlineAllocator<8>>;
+    using ClothNativeKernels::MatMulAccumulate;
+    using ClothNativeKernels::FillRows;
+    using ClothNativeKernels::Sigmoid;
+
+    // 广播与转置支持的最大维数
+    constexpr int32 MaxRank = 8;
+
+    // ONNX TensorProto.DataType
+    constexpr int32 OnnxFloat = 1;
+    constexpr int32 OnnxInt32 = 6;
+    constexpr int32 OnnxInt64 = 7;
+    constexpr int32 OnnxDouble = 11;
+
+    // ---------------------------------------------------------------------
+    // ONNX (protobuf) 解析
+    // ---------------------------------------------------------------------
+
+    // protobuf 线格式的最小读取器，只覆盖 ONNX 用到的 varint / 64 位 / 长度前缀 / 32 位四种编码
+    struct FProtoReader
+    {
+        const uint8* Ptr{nullptr};
+        const uint8* End{nullptr};
+        bool bError{false};
+
+        explicit FProtoReader(TConstArrayView<uint8> InBytes)
+            : Ptr(InBytes.GetData()), End(InBytes.GetData() + InBytes.Num())
+        {
+        }
+
+        bool Next(uint32& OutField, uint32& OutWireType)
+        {
+            if (bError || Ptr >= End)
+            {
+                return false;
+            }
+            const uint64 key = ReadVarint();
+            OutField = static_cast<uint32>(key >> 3);
+            OutWireType = static_cast<uint32>(key & 7);
+            return !bError;
+        }
+
+        uint64 ReadVarint()
+        {
+            uint64 value = 0;
+            for (int32 shift = 0; shift < 64 && Ptr < End; shift += 7)
+            {
+                const uint8 byte = *Ptr++;
+                value |= static_cast<uint64>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            bError = true;
+            return 0;
+        }
+
+        float ReadFloat()
+        {
+            if (End - Ptr < 4)
+            {
+                bError = true;
+                return 0.0f;
+            }
+            float value;
+            FMemory::Memcpy(&value, Ptr, sizeof(float));
+            Ptr += 4;
+            return value;
+        }
+
+        TConstArrayView<uint8> ReadBytes()
+        {
+            const uint64 size = ReadVarint();
+            if (bError || size > static_cast<uint64>(End - Ptr))
+            {
+                bError = true;
+                return TConstArrayView<uint8>();
+            }
+            TConstArrayView<uint8> bytes(Ptr, static_cast<int32>(size));
+            Ptr += size;
+            return bytes;
+        }
+
+        FString ReadString()
+        {
+            const TConstArrayView<uint8> bytes = ReadBytes();
+            const FUTF8ToTCHAR converted(reinterpret_cast<const ANSICHAR*>(bytes.GetData()), bytes.Num());
+            return FString(converted.Length(), converted.Get());
+        }
+
+        void Skip(uint32 WireType)
+        {
+            switch (WireType)
+            {
+            case 0: ReadVarint(); break;
+            case 1: bError |= End - Ptr < 8; Ptr += bError ? 0 : 8; break;
+            case 2: ReadBytes(); break;
+            case 5: bError |= End - Ptr < 4; Ptr += bError ? 0 : 4; break;
+            default: bError = true; break;
+            }
+        }
+
+        // repeated int64/int32，兼容 packed 与非 packed 两种编码
+        void ReadInts(uint32 WireType, TArray<int64>& Out)
+        {
+            if (WireType != 2)
+            {
+                Out.Add(static_cast<int64>(ReadVarint()));
+                return;
+            }
+            FProtoReader packed(ReadBytes());
+            while (!packed.bError && packed.Ptr < packed.End)
+            {
+                Out.Add(static_cast<int64>(packed.ReadVarint()));
+            }
+            bError |= packed.bError;
+        }
+
+        // repeated float，兼容 packed 与非 packed 两种编码
+        void ReadFloats(uint32 WireType, TArray<float>& Out)
+        {
+            if (WireType != 2)
+            {
+                Out.Add(ReadFloat());
+                return;
+            }
+            const TConstArrayView<uint8> bytes = ReadBytes();
+            const int32 count = bytes.Num() / static_cast<int32>(sizeof(float));
+            const int32 offset = Out.AddUninitialized(count);
+            FMemory::Memcpy(Out.GetData() + offset, bytes.GetData(), count * sizeof(float));
+        }
+    };
+
+    struct FParsedTensor
+    {
+        FString Name;
+        TArray<int64> Dims;
+        int32 DataType{0};
+        // 浮点数据 (整数张量也会转换一份，以便参与运算)
+        TArray<float> Floats;
+        // 整数数据 (用于 Reshape 的形状、Squeeze 的轴等)
+        TArray<int64> Ints;
+        bool bExternal{false};
+    };
+
+    struct FParsedAttribute
+    {
+        FString Name;
+        float F{0.0f};
+        int64 I{0};
+        FString S;
+        TArray<float> Floats;
+        TArray<int64> Ints;
+        TArray<FString> Strings;
+        FParsedTensor T;
+        bool bHasTensor{false};
+    };
+
+    struct FParsedNode
+    {
+        FString OpType;
+        FString Domain;
+        FString Name;
+        TArray<FString> Inputs;
+        TArray<FString> Outputs;
+        TArray<FParsedAttribute> Attributes;
+
+        const FParsedAttribute* Find(const TCHAR* InName) const
+        {
+            return Attributes.FindByPredicate([InName](const FParsedAttribute& Attribute) { return Attribute.Name == InName; });
+        }
+        int64 GetInt(const TCHAR* InName, int64 Default) const
+        {
+            const FParsedAttribute* attribute = Find(InName);
+            return attribute ? attribute->I : Default;
+        }
+        float GetFloat(const TCHAR* InName, float Default) const
+        {
+            const FParsedAttribute* attribute = Find(InName);
+            return attribute ? attribute->F : Default;
+        }
+        FString GetString(const TCHAR* InName, const TCHAR* Default) const
+        {
+            const FParsedAttribute* attribute = Find(InName);
+            return attribute ? attribute->S : FString(Default);
+        }
+        // 第 Index 个输入，不存在或被省略时为空
+        FString GetInput(int32 Index) const
+        {
+            return Inputs.IsValidIndex(Index) ? Inputs[Index] : FString();
+        }
+    };
+
+    struct FParsedGraph
+    {
+        TArray<FParsedNode> Nodes;
+        TArray<FParsedTensor> Initializers;
+        TArray<FNativeTensorInfo> Inputs;
+        TArray<FNativeTensorInfo> Outputs;
+    };
+
+    bool ParseTensor(TConstArrayView<uint8> Bytes, FParsedTensor& Out)
+    {
+        FProtoReader reader(Bytes);
+        TConstArrayView<uint8> rawData;
+        uint32 field, wireType;
+        while (reader.Next(field, wireType))
+        {
+            switch (field)
+            {
+            case 1: reader.ReadInts(wireType, Out.Dims); break;
+            case 2: Out.DataType = static_cast<int32>(reader.ReadVarint()); break;
+            case 4: reader.ReadFloats(wireType, Out.Floats); break;
+            case 5: // int32_data
+            case 7: reader.ReadInts(wireType, Out.Ints); break;
+            case 8: Out.Name = reader.ReadString(); break;
+            case 9: rawData = reader.ReadBytes(); break;
+            case 13: Out.bExternal = true; reader.Skip(wireType); break;
+            case 14: Out.bExternal |= reader.ReadVarint() == 1; break;
+            default: reader.Skip(wireType); break;
+            }
+        }
+        if (reader.bError)
+        {
+            return false;
+        }
+
+        // raw_data 按元素类型解释 (小端)
+        if (rawData.Num() > 0)
+        {
+            if (Out.DataType == OnnxFloat)
+            {
+                Out.Floats.SetNumUninitialized(rawData.Num() / static_cast<int32>(sizeof(float)));
+                FMemory::Memcpy(Out.Floats.GetData(), rawData.GetData(), Out.Floats.Num() * sizeof(float));
+            }
+            else if (Out.DataType == OnnxDouble)
+            {
+                const int32 count = rawData.Num() / static_cast<int32>(sizeof(double));
+                Out.Floats.SetNumUninitialized(count);
+                for (int32 i = 0; i < count; ++i)
+                {
+                    double value;
+                    FMemory::Memcpy(&value, rawData.GetData() + i * sizeof(double), sizeof(double));
+                    Out.Floats[i] = static_cast<float>(value);
+                }
+            }
+            else if (Out.DataType == OnnxInt64 || Out.DataType == OnnxInt32)
+            {
+                const int32 elementSize = Out.DataType == OnnxInt64 ? sizeof(int64) : sizeof(int32);
+                const int32 count = rawData.Num() / elementSize;
+                Out.Ints.SetNumUninitialized(count);
+                for (int32 i = 0; i < count; ++i)
+                {
+                    if (Out.DataType == OnnxInt64)
+                    {
+                        FMemory::Memcpy(&Out.Ints[i], rawData.GetData() + i * elementSize, elementSize);
+                    }
+                    else
+                    {
+                        int32 value;
+                        FMemory::Memcpy(&value, rawData.GetData() + i * elementSize, elementSize);
+                        Out.Ints[i] = value;
+                    }
+                }
+            }
+        }
+
+        if (Out.Floats.Num() == 0 && Out.Ints.Num() > 0)
+        {
+            Out.Floats.Reserve(Out.Ints.Num());
+            for (int64 value : Out.Ints)
+            {
+                Out.Floats.Add(static_cast<float>(value));
+            }
+        }
+        return true;
+    }
+
+    bool ParseAttribute(TConstArrayView<uint8> Bytes, FParsedAttribute& Out)
+    {
+        FProtoReader reader(Bytes);
+        uint32 field, wireType;
+        while (reader.Next(field, wireType))
+        {
+            switch (field)
+            {
+            case 1: Out.Name = reader.ReadString(); break;
+            case 2: Out.F = reader.ReadFloat(); break;
+            case 3: Out.I = static_cast<int64>(reader.ReadVarint()); break;
+            case 4: Out.S = reader.ReadString(); break;
+            case 5: Out.bHasTensor = ParseTensor(reader.ReadBytes(), Out.T); break;
+            case 7: reader.ReadFloats(wireType, Out.Floats); break;
+            case 8: reader.ReadInts(wireType, Out.Ints); break;
+            case 9: Out.Strings.Add(reader.ReadString()); break;
+            default: reader.Skip(wireType); break;
+            }
+        }
+        return !reader.bError;
+    }
+
+    bool ParseNode(TConstArrayView<uint8> Bytes, FParsedNode& Out)
+    {
+        FProtoReader reader(Bytes);
+        uint32 field, wireType;
+        while (reader.Next(field, wireType))
+        {
+            switch (field)
+            {
+            case 1: Out.Inputs.Add(reader.ReadString()); break;
+            case 2: Out.Outputs.Add(reader.ReadString()); break;
+            case 3: Out.Name = reader.ReadString(); break;
+            case 4: Out.OpType = reader.ReadString(); break;
+            case 5:
+                if (!ParseAttribute(reader.ReadBytes(), Out.Attributes.AddDefaulted_GetRef()))
+                {
+                    return false;
+                }
+                break;
+            case 7: Out.Domain = reader.ReadString(); break;
+            default: reader.Skip(wireType); break;
+            }
+        }
+        return !reader.bError;
+    }
+
+    // ValueInfoProto -> TypeProto.tensor_type -> TensorShapeProto
+    bool ParseValueInfo(TConstArrayView<uint8> Bytes, FNativeTensorInfo& Out)
+    {
+        FProtoReader reader(Bytes);
+        uint32 field, wireType;
+        while (reader.Next(field, wireType))
+        {
+            if (field == 1)
+            {
+                Out.Name = reader.ReadString();
+                continue;
+            }
+            if (field != 2)
+            {
+                reader.Skip(wireType);
+                continue;
+            }
+
+            FProtoReader typeReader(reader.ReadBytes());
+            while (typeReader.Next(field, wireType))
+            {
+                if (field != 1)
+                {
+                    typeReader.Skip(wireType);
+                    continue;
+                }
+                FProtoReader tensorReader(typeReader.ReadBytes());
+                while (tensorReader.Next(field, wireType))
+                {
+                    if (field == 1)
+                    {
+                        Out.ElementType = static_cast<int32>(tensorReader.ReadVarint());
+                        continue;
+                    }
+                    if (field != 2)
+                    {
+                        tensorReader.Skip(wireType);
+                        continue;
+                    }
+                    FProtoReader shapeReader(tensorReader.ReadBytes());
+                    while (shapeReader.Next(field, wireType))
+                    {
+                        if (field != 1)
+                        {
+                            shapeReader.Skip(wireType);
+                            continue;
+                        }
+                        // 没有 dim_value 的维度是动态的，dim_param 为它的符号名
+                        int64 dimValue = -1;
+                        FString dimParam;
+                        FProtoReader dimReader(shapeReader.ReadBytes());
+                        while (dimReader.Next(field, wireType))
+                        {
+                            if (field == 1)
+                            {
+                                const int64 value = static_cast<int64>(dimReader.ReadVarint());
+                                dimValue = value > 0 ? value : -1;
+                            }
+                            else if (field == 2)
+                            {
+                                dimParam = dimReader.ReadString();
+                            }
+                            else
+                            {
+                                dimReader.Skip(wireType);
+                            }
+                        }
+                        shapeReader.bError |= dimReader.bError;
+                        Out.Shape.Add(dimValue);
+                        Out.SymbolicDims.Add(dimValue > 0 ? FString() : dimParam);
+                    }
+                    tensorReader.bError |= shapeReader.bError;
+                }
+                typeReader.bError |= tensorReader.bError;
+            }
+            reader.bError |= typeReader.bError;
+        }
+        return !reader.bError;
+    }
+
+    bool ParseModel(const TArray<uint8>& ModelData, FParsedGraph& Out, FString& OutError)
+    {
+        TConstArrayView<uint8> graphBytes;
+        FProtoReader modelReader(ModelData);
+        uint32 field, wireType;
+        while (modelReader.Next(field, wireType))
+        {
+            if (field == 7)
+            {
+                graphBytes = modelReader.ReadBytes();
+            }
+            else
+            {
+                modelReader.Skip(wireType);
+            }
+        }
+        if (modelReader.bError || graphBytes.Num() == 0)
+        {
+            OutError = TEXT("Model data is not a valid ONNX ModelProto.");
+            return false;
+        }
+
+        TArray<FNativeTensorInfo> declaredInputs;
+        FProtoReader graphReader(graphBytes);
+        while (graphReader.Next(field, wireType))
+        {
+            bool bParsed = true;
+            switch (field)
+            {
+            case 1: bParsed = ParseNode(graphReader.ReadBytes(), Out.Nodes.AddDefaulted_GetRef()); break;
+            case 5: bParsed = ParseTensor(graphReader.ReadBytes(), Out.Initializers.AddDefaulted_GetRef()); break;
+            case 11: bParsed = ParseValueInfo(graphReader.ReadBytes(), declaredInputs.AddDefaulted_GetRef()); break;
+            case 12: bParsed = ParseValueInfo(graphReader.ReadBytes(), Out.Outputs.AddDefaulted_GetRef()); break;
+            default: graphReader.Skip(wireType); break;
+            }
+            if (!bParsed)
+            {
+                OutError = TEXT("Failed to parse ONNX graph.");
+                return false;
+            }
+        }
+        if (graphReader.bError)
+        {
+            OutError = TEXT("Failed to parse ONNX graph.");
+            return false;
+        }
+
+        // 旧版导出器会把初始化器也列为图输入，它们不是真正的输入
+        for (FNativeTensorInfo& input : declaredInputs)
+        {
+            if (!Out.Initializers.ContainsByPredicate([&input](const FParsedTensor& Tensor) { return Tensor.Name == input.Name; }))
+            {
+                Out.Inputs.Add(MoveTemp(input));
+            }
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------
+    // 内核
+    // ---------------------------------------------------------------------
+
+    int64 NumElements(TConstArrayView<int64> Shape)
+    {
+        int64 count = 1;
+        for (int64 dim : Shape)
+        {
+            count *= dim;
+        }
+        return count;
+    }
+
+    // 设置输出的形状并按元素数调整数据，尺寸不变时不重新分配
+    float* PrepareOutput(FTensor& Out, TConstArrayView<int64> Shape)
+    {
+        Out.Shape.Reset();
+        Out.Shape.Append(Shape.GetData(), Shape.Num());
+        Out.Data.SetNumUninitialized(static_cast<int32>(NumElements(Shape)), EAllowShrinking::No);
+        return Out.Data.GetData();
+    }
+
+    // 负数轴按维数归一化，越界时返回 INDEX_NONE
+    int32 NormalizeAxis(int64 Axis, int32 Rank)
+    {
+        const int64 axis = Axis < 0 ? Axis + Rank : Axis;
+        return axis >= 0 && axis < Rank ? static_cast<int32>(axis) : INDEX_NONE;
+    }
+
+    // 按 numpy 规则广播的逐元素二元运算
+    template<typename FunctorType>
+    bool BroadcastBinary(const FTensor& A, const FTensor& B, FTensor& Out, FunctorType Op)
+    {
+        const int32 rank = FMath::Max(A.Shape.Num(), B.Shape.Num());
+        if (rank > MaxRank)
+        {
+            return false;
+        }
+
+        FShape shape;
+        shape.SetNum(rank);
+        int64 aStrides[MaxRank] = {};
+        int64 bStrides[MaxRank] = {};
+        int64 aStride = 1;
+        int64 bStride = 1;
+        for (int32 d = rank - 1; d >= 0; --d)
+        {
+            const int32 aIndex = d - (rank - A.Shape.Num());
+            const int32 bIndex = d - (rank - B.Shape.Num());
+            const int64 aDim = aIndex >= 0 ? A.Shape[aIndex] : 1;
+            const int64 bDim = bIndex >= 0 ? B.Shape[bIndex] : 1;
+            if (aDim != bDim && aDim != 1 && bDim != 1)
+            {
+                return false;
+            }
+            shape[d] = FMath::Max(aDim, bDim);
+            aStrides[d] = aDim == 1 ? 0 : aStride;
+            bStrides[d] = bDim == 1 ? 0 : bStride;
+            aStride *= aDim;
+            bStride *= bDim;
+        }
+
+        float* out = PrepareOutput(Out, shape);
+        const float* a = A.Data.GetData();
+        const float* b = B.Data.GetData();
+        const int64 count = Out.Data.Num();
+
+        // 常见情形：形状相同、一侧为标量
+        if (A.Data.Num() == count && B.Data.Num() == count)
+        {
+            for (int64 i = 0; i < count; ++i)
+            {
+                out[i] = Op(a[i], b[i]);
+            }
+            return true;
+        }
+        if (B.Data.Num() == 1)
+        {
+            for (int64 i = 0; i < count; ++i)
+            {
+                out[i] = Op(a[i], b[0]);
+            }
+            return true;
+        }
+        if (A.Data.Num() == 1)
+        {
+            for (int64 i = 0; i < count; ++i)
+            {
+                out[i] = Op(a[0], b[i]);
+            }
+            return true;
+        }
+
+        // 一般情形：最内层连续循环，外层按下标计数器推进
+        const int64 inner = shape[rank - 1];
+        const int64 aInner = aStrides[rank - 1];
+        const int64 bInner = bStrides[rank - 1];
+        int64 index[MaxRank] = {};
+        int64 aOffset = 0;
+        int64 bOffset = 0;
+        for (int64 o = 0; o < count; o += inner)
+        {
+            for (int64 i = 0; i < inner; ++i)
+            {
+                out[o + i] = Op(a[aOffset + i * aInner], b[bOffset + i * bInner]);
+            }
+            for (int32 d = rank - 2; d >= 0; --d)
+            {
+                ++index[d];
+                aOffset += aStrides[d];
+                bOffset += bStrides[d];
+                if (index[d] < shape[d])
+                {
+                    break;
+                }
+                aOffset -= aStrides[d] * shape[d];
+                bOffset -= bStrides[d] * shape[d];
+                index[d] = 0;
+            }
+        }
+        return true;
+    }
+
+    template<typename FunctorType>
+    void Unary(const FTensor& In, FTensor& Out, FunctorType Op)
+    {
+        float* out = PrepareOutput(Out, In.Shape);
+        const float* in = In.Data.GetData();
+        for (int32 i = 0; i < In.Data.Num(); ++i)
+        {
+            out[i] = Op(in[i]);
+        }
+    }
+
+    // 只改变形状的算子：数据原样拷贝
+    void CopyWithShape(const FTensor& In, FTensor& Out, TConstArrayView<int64> Shape)
+    {
+        float* out = PrepareOutput(Out, Shape);
+        FMemory::Memcpy(out, In.Data.GetData(), In.Data.Num() * sizeof(float));
+    }
+
+    // ---------------------------------------------------------------------
+    // 共享模型缓存
+    // ---------------------------------------------------------------------
+
+    FCriticalSection GNativeModelsMutex;
+    TMap<uint32, TWeakPtr<const FNativeClothModel, ESPMode::ThreadSafe>> GNativeModels;
+}
+
+/**
+ * FNativeClothModelImporter
+ * 把解析出的 ONNX 图转换为 FNativeClothModel：分配值表、把权重转置为 [K, N] 布局、校验算子与属性
+ */
+class FNativeClothModelImporter
+{
+public:
+    explicit FNativeClothModelImporter(FNativeClothModel& InModel) : Model(InModel) {}
+
+    bool Import(const FParsedGraph& Graph, FString& OutError)
+    {
+        for (const FParsedTensor& initializer : Graph.Initializers)
+        {
+            if (initializer.bExternal)
+            {
+                OutError = FString::Printf(TEXT("Initializer %s uses external data, which is not supported."), *initializer.Name);
+                return false;
+            }
+            AddConstant(initializer.Name, initializer.Dims, initializer.Floats);
+            IntConstants.Add(initializer.Name, initializer.Ints);
+        }
+
+        for (const FNativeTensorInfo& input : Graph.Inputs)
+        {
+            if (input.ElementType != OnnxFloat)
+            {
+                OutError = FString::Printf(TEXT("Input %s is not a float tensor (element type %d)."), *input.Name, input.ElementType);
+                return false;
+            }
+            Model.Inputs.Add(input);
+            Model.InputValues.Add(AddValue(input.Name));
+        }
+
+        for (const FParsedNode& node : Graph.Nodes)
+        {
+            if (!ImportNode(node, OutError))
+            {
+                return false;
+            }
+        }
+
+        for (const FNativeTensorInfo& output : Graph.Outputs)
+        {
+            const int32* value = ValueIndices.Find(output.Name);
+            if (!value || output.ElementType != OnnxFloat)
+            {
+                OutError = FString::Printf(TEXT("Output %s is not produced by the graph or is not a float tensor."), *output.Name);
+                return false;
+            }
+            Model.Outputs.Add(output);
+            Model.OutputValues.Add(*value);
+        }
+
+        Model.NumValues = Model.Constants.Num();
+        return true;
+    }
+
+private:
+    FNativeClothModel& Model;
+    TMap<FString, int32> ValueIndices;
+    TMap<FString, TArray<int64>> IntConstants;
+
+    int32 AddValue(const FString& Name)
+    {
+        const int32 index = Model.Constants.AddDefaulted();
+        Model.IsConstant.Add(false);
+        if (!Name.IsEmpty())
+        {
+            ValueIndices.Add(Name, index);
+        }
+        return index;
+    }
+
+    int32 AddConstant(const FString& Name, TConstArrayView<int64> Shape, TArray<float> Data)
+    {
+        const int32 index = AddValue(Name);
+        Model.IsConstant[index] = true;
+        FTensor& tensor = Model.Constants[index];
+        tensor.Shape.Append(Shape.GetData(), Shape.Num());
+        tensor.Data = MoveTemp(Data);
+        return index;
+    }
+
+    // 省略的可选输入返回 INDEX_NONE，未定义的名字返回 false
+    bool FindValue(const FString& Name, int32& OutIndex, FString& OutError) const
+    {
+        OutIndex = INDEX_NONE;
+        if (Name.IsEmpty())
+        {
+            return true;
+        }
+        if (const int32* index = ValueIndices.Find(Name))
+        {
+            OutIndex = *index;
+            return true;
+        }
+        OutError = FString::Printf(TEXT("Value %s is used before it is defined."), *Name);
+        return false;
+    }
+
+    const FTensor* FindConstant(const FString& Name) const
+    {
+        const int32* index = ValueIndices.Find(Name);
+        return index && Model.IsConstant[*index] ? &Model.Constants[*index] : nullptr;
+    }
+
+    // [Rows, Cols] -> [Cols, Rows]
+    static TArray<float> Transpose2D(const float* Data, int64 Rows, int64 Cols)
+    {
+        TArray<float> result;
+        result.SetNumUninitialized(static_cast<int32>(Rows * Cols));
+        float* target = result.GetData();
+        for (int64 r = 0; r < Rows; ++r)
+        {
+            for (int64 c = 0; c < Cols; ++c)
+            {
+                target[c * Rows + r] = Data[r * Cols + c];
+            }
+        }
+        return result;
+    }
+
+    bool ImportNode(const FParsedNode& Node, FString& OutError)
+    {
+        if (!Node.Domain.IsEmpty() && Node.Domain != TEXT("ai.onnx"))
+        {
+            OutError = FString::Printf(TEXT("Operator %s from domain %s is not supported."), *Node.OpType, *Node.Domain);
+            return false;
+        }
+
+        // Constant 节点直接成为常量
+        if (Node.OpType == TEXT("Constant"))
+        {
+            const FParsedAttribute* value = Node.Find(TEXT("value"));
+            if (!value || !value->bHasTensor || Node.Outputs.Num() != 1)
+            {
+                OutError = FString::Printf(TEXT("Constant node %s has no tensor value."), *Node.Name);
+                return false;
+            }
+            AddConstant(Node.Outputs[0], value->T.Dims, value->T.Floats);
+            IntConstants.Add(Node.Outputs[0], value->T.Ints);
+            return true;
+        }
+
+        FNativeClothModel::FNode node;
+        const FString& op = Node.OpType;
+        int32 numInputs = 1;
+        if (op == TEXT("Gemm") || op == TEXT("MatMul"))
+        {
+            if (!ImportMatMul(Node, node, OutError))
+            {
+                return false;
+            }
+            numInputs = 0;
+        }
+        else if (op == TEXT("GRU") || op == TEXT("LSTM"))
+        {
+            if (!ImportRecurrent(Node, node, OutError))
+            {
+                return false;
+            }
+            numInputs = 0;
+        }
+        else if (op == TEXT("Add")) { node.Op = FNativeClothModel::EOp::Add; numInputs = 2; }
+        else if (op == TEXT("Sub")) { node.Op = FNativeClothModel::EOp::Sub; numInputs = 2; }
+        else if (op == TEXT("Mul")) { node.Op = FNativeClothModel::EOp::Mul; numInputs = 2; }
+        else if (op == TEXT("Div")) { node.Op = FNativeClothModel::EOp::Div; numInputs = 2; }
+        else if (op == TEXT("Relu")) { node.Op = FNativeClothModel::EOp::Relu; }
+        else if (op == TEXT("Tanh")) { node.Op = FNativeClothModel::EOp::Tanh; }
+        else if (op == TEXT("Sigmoid")) { node.Op = FNativeClothModel::EOp::Sigmoid; }
+        else if (op == TEXT("LeakyRelu")) { node.Op = FNativeClothModel::EOp::LeakyRelu; node.Alpha = Node.GetFloat(TEXT("alpha"), 0.01f); }
+        else if (op == TEXT("Elu")) { node.Op = FNativeClothModel::EOp::Elu; node.Alpha = Node.GetFloat(TEXT("alpha"), 1.0f); }
+        // 推理时 Dropout 就是恒等映射
+        else if (op == TEXT("Identity") || op == TEXT("Dropout")) { node.Op = FNativeClothModel::EOp::Identity; }
+        else if (op == TEXT("Flatten")) { node.Op = FNativeClothModel::EOp::Flatten; node.Axis = Node.GetInt(TEXT("axis"), 1); }
+        else if (op == TEXT("Concat")) { node.Op = FNativeClothModel::EOp::Concat; node.Axis = Node.GetInt(TEXT("axis"), 0); numInputs = Node.Inputs.Num(); }
+        else if (op == TEXT("Transpose"))
+        {
+            node.Op = FNativeClothModel::EOp::Transpose;
+            if (const FParsedAttribute* perm = Node.Find(TEXT("perm")))
+            {
+                node.Ints = perm->Ints;
+            }
+        }
+        else if (op == TEXT("Reshape") || op == TEXT("Squeeze") || op == TEXT("Unsqueeze"))
+        {
+            node.Op = op == TEXT("Reshape") ? FNativeClothModel::EOp::Reshape : op == TEXT("Squeeze") ? FNativeClothModel::EOp::Squeeze : FNativeClothModel::EOp::Unsqueeze;
+
+            // 形状/轴来自属性 (旧 opset) 或常量输入 (新 opset)，必须在导出时折叠为常量
+            const FParsedAttribute* attribute = Node.Find(op == TEXT("Reshape") ? TEXT("shape") : TEXT("axes"));
+            const FString shapeInput = Node.GetInput(1);
+            if (attribute)
+            {
+                node.Ints = attribute->Ints;
+            }
+            else if (!shapeInput.IsEmpty())
+            {
+                const TArray<int64>* ints = IntConstants.Find(shapeInput);
+                if (!ints)
+                {
+                    OutError = FString::Printf(TEXT("%s node %s takes a computed shape, fold it into a constant when exporting."), *op, *Node.Name);
+                    return false;
+                }
+                node.Ints = *ints;
+            }
+            else if (node.Op != FNativeClothModel::EOp::Squeeze)
+            {
+                OutError = FString::Printf(TEXT("%s node %s has no shape or axes."), *op, *Node.Name);
+                return false;
+            }
+        }
+        else
+        {
+            OutError = FString::Printf(TEXT("Operator %s (node %s) is not supported by the native backend."), *op, *Node.Name);
+            return false;
+        }
+
+        for (int32 i = 0; i < numInputs; ++i)
+        {
+            int32 value;
+            if (!FindValue(Node.GetInput(i), value, OutError))
+            {
+                return false;
+            }
+            if (value == INDEX_NONE)
+            {
+                OutError = FString::Printf(TEXT("Node %s is missing input %d."), *Node.Name, i);
+                return false;
+            }
+            node.Inputs.Add(value);
+        }
+
+        // 只有 Dropout 的 mask 与循环层的可选输出可能省略
+        const int32 numOutputs = node.Op == FNativeClothModel::EOp::GRU || node.Op == FNativeClothModel::EOp::LSTM ? Node.Outputs.Num() : 1;
+        if (Node.Outputs.Num() == 0 || Node.Outputs[0].IsEmpty())
+        {
+            OutError = FString::Printf(TEXT("Node %s has no output."), *Node.Name);
+            return false;
+        }
+        for (int32 i = 0; i < numOutputs; ++i)
+        {
+            node.Outputs.Add(Node.Outputs[i].IsEmpty() ? INDEX_NONE : AddValue(Node.Outputs[i]));
+        }
+        Model.Nodes.Add(MoveTemp(node));
+        return true;
+    }
+
+    // Gemm / MatMul：B 必须是常量，导入时转为 [K, N]
+    bool ImportMatMul(const FParsedNode& Node, FNativeClothModel::FNode& OutNode, FString& OutError)
+    {
+        const bool bGemm = Node.OpType == TEXT("Gemm");
+        const FTensor* weight = FindConstant(Node.GetInput(1));
+        if (!weight || weight->Shape.Num() != 2)
+        {
+            OutError = FString::Printf(TEXT("%s node %s needs a constant 2D weight."), *Node.OpType, *Node.Name);
+            return false;
+        }
+        if (bGemm && Node.GetInt(TEXT("transA"), 0) != 0)
+        {
+            OutError = FString::Printf(TEXT("Gemm node %s uses transA, which is not supported."), *Node.Name);
+            return false;
+        }
+
+        int32 input;
+        if (!FindValue(Node.GetInput(0), input, OutError))
+        {
+            return false;
+        }
+        OutNode.Op = bGemm ? FNativeClothModel::EOp::Gemm : FNativeClothModel::EOp::MatMul;
+        OutNode.Inputs.Add(input);
+
+        if (bGemm && Node.GetInt(TEXT("transB"), 0) != 0)
+        {
+            // PyTorch Linear 导出的 [N, K] 权重
+            const int64 n = weight->Shape[0];
+            const int64 k = weight->Shape[1];
+            const int64 shape[] = {k, n};
+            OutNode.Inputs.Add(AddConstant(FString(), shape, Transpose2D(weight->Data.GetData(), n, k)));
+        }
+        else
+        {
+            OutNode.Inputs.Add(ValueIndices[Node.GetInput(1)]);
+        }
+
+        if (bGemm)
+        {
+            int32 bias;
+            if (!FindValue(Node.GetInput(2), bias, OutError))
+            {
+                return false;
+            }
+            OutNode.Inputs.Add(bias);
+            OutNode.Alpha = Node.GetFloat(TEXT("alpha"), 1.0f);
+            OutNode.Beta = Node.GetFloat(TEXT("beta"), 1.0f);
+        }
+        return true;
+    }
+
+    /**
+     * GRU / LSTM：只支持单向、layout = 0、默认激活函数、无 sequence_lens 与 peephole。
+     * 导入后的输入为 {X, Wt[I, G*H], Rt[H, G*H], Wb[G*H], Rb[G*H], initial_h, (initial_c)}
+     */
+    bool ImportRecurrent(const FParsedNode& Node, FNativeClothModel::FNode& OutNode, FString& OutError)
+    {
+        const bool bLSTM = Node.OpType == TEXT("LSTM");
+        const int64 numGates = bLSTM ? 4 : 3;
+        const int64 hidden = Node.GetInt(TEXT("hidden_size"), 0);
+
+        const FParsedAttribute* activations = Node.Find(TEXT("activations"));
+        const bool bDefaultActivations = !activations ||
+            (activations->Strings.Num() == (bLSTM ? 3 : 2) && activations->Strings[0] == TEXT("Sigmoid") &&
+             activations->Strings[1] == TEXT("Tanh") && (!bLSTM || activations->Strings[2] == TEXT("Tanh")));
+        if (hidden <= 0 || Node.GetString(TEXT("direction"), TEXT("forward")) != TEXT("forward") ||
+            Node.GetInt(TEXT("layout"), 0) != 0 || Node.Find(TEXT("clip")) || Node.GetInt(TEXT("input_forget"), 0) != 0 ||
+            !bDefaultActivations || !Node.GetInput(4).IsEmpty() || (bLSTM && !Node.GetInput(7).IsEmpty()))
+        {
+            OutError = FString::Printf(TEXT("%s node %s uses attributes or inputs not supported by the native backend (only forward, layout 0, default activations, no sequence_lens/clip/peepholes)."), *Node.OpType, *Node.Name);
+            return false;
+        }
+
+        const FTensor* w = FindConstant(Node.GetInput(1));
+        const FTensor* r = FindConstant(Node.GetInput(2));
+        const FTensor* b = FindConstant(Node.GetInput(3));
+        const int64 gateSize = numGates * hidden;
+        if (!w || !r || w->Shape.Num() != 3 || r->Shape.Num() != 3 || w->Shape[0] != 1 || w->Shape[1] != gateSize ||
+            r->Shape[0] != 1 || r->Shape[1] != gateSize || r->Shape[2] != hidden ||
+            (!Node.GetInput(3).IsEmpty() && (!b || b->Data.Num() != 2 * gateSize)))
+        {
+            OutError = FString::Printf(TEXT("%s node %s needs constant weights of the declared hidden size."), *Node.OpType, *Node.Name);
+            return false;
+        }
+
+        // 添加常量可能使 w / r / b 指向的数组重新分配，先取出所有数据
+        const int64 inputSize = w->Shape[2];
+        const int64 wtShape[] = {inputSize, gateSize};
+        const int64 rtShape[] = {hidden, gateSize};
+        const int64 biasShape[] = {gateSize};
+        TArray<float> wt = Transpose2D(w->Data.GetData(), gateSize, inputSize);
+        TArray<float> rt = Transpose2D(r->Data.GetData(), gateSize, hidden);
+        TArray<float> wb;
+        TArray<float> rb;
+        if (b)
+        {
+            wb.Append(b->Data.GetData(), static_cast<int32>(gateSize));
+            rb.Append(b->Data.GetData() + gateSize, static_cast<int32>(gateSize));
+        }
+        else
+        {
+            wb.SetNumZeroed(static_cast<int32>(gateSize));
+            rb.SetNumZeroed(static_cast<int32>(gateSize));
+        }
+
+        int32 x, initialH, initialC = INDEX_NONE;
+        if (!FindValue(Node.GetInput(0), x, OutError) || !FindValue(Node.GetInput(5), initialH, OutError) ||
+            (bLSTM && !FindValue(Node.GetInput(6), initialC, OutError)))
+        {
+            return false;
+        }
+
+        OutNode.Op = bLSTM ? FNativeClothModel::EOp::LSTM : FNativeClothModel::EOp::GRU;
+        OutNode.HiddenSize = static_cast<int32>(hidden);
+        OutNode.bLinearBeforeReset = Node.GetInt(TEXT("linear_before_reset"), 0) != 0;
+        OutNode.Inputs.Add(x);
+        OutNode.Inputs.Add(AddConstant(FString(), wtShape, MoveTemp(wt)));
+        OutNode.Inputs.Add(AddConstant(FString(), rtShape, MoveTemp(rt)));
+        OutNode.Inputs.Add(AddConstant(FString(), biasShape, MoveTemp(wb)));
+        OutNode.Inputs.Add(AddConstant(FString(), biasShape, MoveTemp(rb)));
+        OutNode.Inputs.Add(initialH);
+        if (bLSTM)
+        {
+            OutNode.Inputs.Add(initialC);
+        }
+        return true;
+    }
+};
+
+TSharedPtr<const FNativeClothModel, ESPMode::ThreadSafe> FNativeClothModel::Acquire(const TArray<uint8>& ModelData, FString& OutError)
+{
+    // 原生后端的权重与 ORT 会话一样计入会话
+    LLM_SCOPE_BYTAG(ClothDeformer_Sessions);
+    const uint32 crc = FCrc::MemCrc32(ModelData.GetData(), ModelData.Num());
+
+    FScopeLock lock(&GNativeModelsMutex);
+    if (const TWeakPtr<const FNativeClothModel, ESPMode::ThreadSafe>* existing = GNativeModels.Find(crc))
+    {
+        if (TSharedPtr<const FNativeClothModel, ESPMode::ThreadSafe> model = existing->Pin())
+        {
+            return model;
+        }
+    }
+
+    FParsedGraph graph;
+    if (!ParseModel(ModelData, graph, OutError))
+    {
+        return nullptr;
+    }
+
+    TSharedPtr<FNativeClothModel, ESPMode::ThreadSafe> model = MakeShared<FNativeClothModel, ESPMode::ThreadSafe>();
+    model->DataCrc = crc;
+    FNativeClothModelImporter importer(*model);
+    if (!importer.Import(graph, OutError))
+    {
+        return nullptr;
+    }
+
+    GNativeModels.Add(crc, model);
+    return model;
+}
+
+bool FNativeClothModel::ReadGraphSignature(const TArray<uint8>& ModelData, TArray<FNativeTensorInfo>& OutInputs, TArray<FNativeTensorInfo>& OutOutputs, FString& OutError)
+{
+    FParsedGraph graph;
+    if (!ParseModel(ModelData, graph, OutError))
+    {
+        return false;
+    }
+    OutInputs = MoveTemp(graph.Inputs);
+    OutOutputs = MoveTemp(graph.Outputs);
+    return true;
+}
+
+bool FNativeClothModel::Run(FNativeClothRunContext& Context, TConstArrayView<TConstArrayView<float>> InputData, TConstArrayView<std::vector<int64_t>> InputShapes, TConstArrayView<TArray<float>*> OutputData) const
+{
+    if (InputData.Num() != InputValues.Num() || InputShapes.Num() != InputValues.Num() || OutputData.Num() != OutputValues.Num())
+    {
+        UE_LOG(LogTemp, Error, TEXT("FNativeClothModel::Run: Expected %d inputs and %d outputs."), InputValues.Num(), OutputValues.Num());
+        return false;
+    }
+
+    Context.Values.SetNum(NumValues);
+    for (int32 i = 0; i < InputValues.Num(); ++i)
+    {
+        FShape shape;
+        for (int64_t dim : InputShapes[i])
+        {
+            shape.Add(dim);
+        }
+        if (NumElements(shape) != InputData[i].Num())
+        {
+            UE_LOG(LogTemp, Error, TEXT("FNativeClothModel::Run: Input %s has %d elements, its shape needs %lld."), *Inputs[i].Name, InputData[i].Num(), NumElements(shape));
+            return false;
+        }
+        float* data = PrepareOutput(Context.Values[InputValues[i]], shape);
+        FMemory::Memcpy(data, InputData[i].GetData(), InputData[i].Num() * sizeof(float));
+    }
+
+    for (const FNode& node : Nodes)
+    {
+        if (!RunNode(node, Context))
+        {
+            return false;
+        }
+    }
+
+    for (int32 i = 0; i < OutputValues.Num(); ++i)
+    {
+        const FNativeClothRunContext::FTensor& tensor = GetValue(Context, OutputValues[i]);
+        TArray<float>& output = *OutputData[i];
+        output.SetNumUninitialized(tensor.Data.Num(), EAllowShrinking::No);
+        FMemory::Memcpy(output.GetData(), tensor.Data.GetData(), tensor.Data.Num() * sizeof(float));
+    }
+    return true;
+}
+
+bool FNativeClothModel::RunNode(const FNode& Node, FNativeClothRunContext& Context) const
+{
+    if (Node.Op == EOp::GRU || Node.Op == EOp::LSTM)
+    {
+        return RunRecurrent(Node, Context);
+    }
+
+    const FTensor& a = GetValue(Context, Node.Inputs[0]);
+    FTensor& out = Context.Values[Node.Outputs[0]];
+    const int32 rank = a.Shape.Num();
+    bool bSucceeded = true;
+
+    switch (Node.Op)
+    {
+    case EOp::Gemm:
+    case EOp::MatMul:
+    {
+        // 权重已是 [K, N]；MatMul 把 A 的前导维度合并为 M
+        const FTensor& b = GetValue(Context, Node.Inputs[1]);
+        const int64 k = b.Shape[0];
+        const int64 n = b.Shape[1];
+        if (rank == 0 || a.Shape.Last() != k || (Node.Op == EOp::Gemm && rank != 2))
+        {
+            bSucceeded = false;
+            break;
+        }
+        const int64 m = a.Data.Num() / k;
+        FShape shape(a.Shape);
+        shape.Last() = n;
+        float* y = PrepareOutput(out, shape);
+
+        const FTensor* c = Node.Op == EOp::Gemm && Node.Inputs[2] != INDEX_NONE ? &GetValue(Context, Node.Inputs[2]) : nullptr;
+        if (!c || Node.Beta == 0.0f)
+        {
+            FMemory::Memzero(y, m * n * sizeof(float));
+        }
+        else if (c->Data.Num() == n)
+        {
+            FillRows(y, n, m, c->Data.GetData(), n);
+        }
+        else if (c->Data.Num() == m * n)
+        {
+            FMemory::Memcpy(y, c->Data.GetData(), m * n * sizeof(float));
+        }
+        else if (c->Data.Num() == 1 || c->Data.Num() == m)
+        {
+            const float* bias = c->Data.GetData();
+            for (int64 i = 0; i < m * n; ++i)
+            {
+                y[i] = bias[c->Data.Num() == 1 ? 0 : i / n];
+            }
+        }
+        else
+        {
+            bSucceeded = false;
+            break;
+        }
+        if (c && Node.Beta != 1.0f && Node.Beta != 0.0f)
+        {
+            for (int64 i = 0; i < m * n; ++i)
+            {
+                y[i] *= Node.Beta;
+            }
+        }
+        MatMulAccumulate(a.Data.GetData(), k, b.Data.GetData(), n, y, n, m, k, n, Node.Alpha);
+        break;
+    }
+    case EOp::Add: bSucceeded = BroadcastBinary(a, GetValue(Context, Node.Inputs[1]), out, [](float x, float y) { return x + y; }); break;
+    case EOp::Sub: bSucceeded = BroadcastBinary(a, GetValue(Context, Node.Inputs[1]), out, [](float x, float y) { return x - y; }); break;
+    case EOp::Mul: bSucceeded = BroadcastBinary(a, GetValue(Context, Node.Inputs[1]), out, [](float x, float y) { return x * y; }); break;
+    case EOp::Div: bSucceeded = BroadcastBinary(a, GetValue(Context, Node.Inputs[1]), out, [](float x, float y) { return x / y; }); break;
+    case EOp::Relu: Unary(a, out, [](float x) { return x > 0.0f ? x : 0.0f; }); break;
+    case EOp::LeakyRelu: Unary(a, out, [alpha = Node.Alpha](float x) { return x >= 0.0f ? x : alpha * x; }); break;
+    case EOp::Elu: Unary(a, out, [alpha = Node.Alpha](float x) { return x >= 0.0f ? x : alpha * (std::exp(x) - 1.0f); }); break;
+    case EOp::Tanh: Unary(a, out, [](float x) { return std::tanh(x); }); break;
+    case EOp::Sigmoid: Unary(a, out, [](float x) { return Sigmoid(x); }); break;
+    case EOp::Identity: CopyWithShape(a, out, a.Shape); break;
+    case EOp::Reshape:
+    {
+        // 0 沿用输入的维度，-1 由元素数推算
+        FShape shape;
+        int32 inferred = INDEX_NONE;
+        int64 known = 1;
+        for (int32 i = 0; i < Node.Ints.Num(); ++i)
+        {
+            int64 dim = Node.Ints[i];
+            if (dim == 0 && i < rank)
+            {
+                dim = a.Shape[i];
+            }
+            if (dim < 0)
+            {
+                inferred = i;
+            }
+            else
+            {
+                known *= dim;
+            }
+            shape.Add(dim);
+        }
+        if (inferred != INDEX_NONE)
+        {
+            shape[inferred] = known > 0 ? a.Data.Num() / known : 0;
+        }
+        bSucceeded = NumElements(shape) == a.Data.Num();
+        if (bSucceeded)
+        {
+            CopyWithShape(a, out, shape);
+        }
+        break;
+    }
+    case EOp::Flatten:
+    {
+        const int64 axis = Node.Axis < 0 ? Node.Axis + rank : Node.Axis;
+        bSucceeded = axis >= 0 && axis <= rank;
+        if (bSucceeded)
+        {
+            const int64 outer = NumElements(TConstArrayView<int64>(a.Shape.GetData(), static_cast<int32>(axis)));
+            const int64 shape[] = {outer, outer > 0 ? a.Data.Num() / outer : 0};
+            CopyWithShape(a, out, shape);
+        }
+        break;
+    }
+    case EOp::Squeeze:
+    {
+        FShape shape;
+        for (int32 i = 0; i < rank; ++i)
+        {
+            const bool bListed = Node.Ints.ContainsByPredicate([i, rank](int64 Axis) { return NormalizeAxis(Axis, rank) == i; });
+            if (Node.Ints.Num() > 0 ? !bListed : a.Shape[i] != 1)
+            {
+                shape.Add(a.Shape[i]);
+            }
+        }
+        CopyWithShape(a, out, shape);
+        break;
+    }
+    case EOp::Unsqueeze:
+    {
+        const int32 outRank = rank + Node.Ints.Num();
+        FShape shape;
+        int32 source = 0;
+        for (int32 i = 0; i < outRank; ++i)
+        {
+            const bool bInserted = Node.Ints.ContainsByPredicate([i, outRank](int64 Axis) { return NormalizeAxis(Axis, outRank) == i; });
+            shape.Add(bInserted ? 1 : (source < rank ? a.Shape[source++] : 1));
+        }
+        CopyWithShape(a, out, shape);
+        break;
+    }
+    case EOp::Concat:
+    {
+        // 除拼接轴外各输入的维度必须一致
+        const int32 axis = NormalizeAxis(Node.Axis, rank);
+        if (axis == INDEX_NONE)
+        {
+            bSucceeded = false;
+            break;
+        }
+        FShape shape(a.Shape);
+        shape[axis] = 0;
+        for (int32 value : Node.Inputs)
+        {
+            const FTensor& part = GetValue(Context, value);
+            for (int32 d = 0; d < rank && bSucceeded; ++d)
+            {
+                bSucceeded = part.Shape.Num() == rank && (d == axis || part.Shape[d] == a.Shape[d]);
+            }
+            shape[axis] += bSucceeded ? part.Shape[axis] : 0;
+        }
+        if (!bSucceeded)
+        {
+            break;
+        }
+        const int64 outer = NumElements(TConstArrayView<int64>(shape.GetData(), axis));
+        float* y = PrepareOutput(out, shape);
+        for (int64 o = 0; o < outer; ++o)
+        {
+            for (int32 value : Node.Inputs)
+            {
+                const FTensor& part = GetValue(Context, value);
+                const int64 chunk = part.Data.Num() / outer;
+                FMemory::Memcpy(y, part.Data.GetData() + o * chunk, chunk * sizeof(float));
+                y += chunk;
+            }
+        }
+        break;
+    }
+    case EOp::Transpose:
+    {
+        if (rank > MaxRank || (Node.Ints.Num() > 0 && Node.Ints.Num() != rank))
+        {
+            bSucceeded = false;
+            break;
+        }
+        int64 perm[MaxRank];
+        int64 inStrides[MaxRank];
+        int64 stride = 1;
+        for (int32 i = rank - 1; i >= 0; --i)
+        {
+            perm[i] = Node.Ints.Num() > 0 ? Node.Ints[i] : rank - 1 - i;
+            inStrides[i] = stride;
+            stride *= a.Shape[i];
+        }
+        FShape shape;
+        int64 outStrides[MaxRank];
+        for (int32 i = 0; i < rank; ++i)
+        {
+            const int32 source = NormalizeAxis(perm[i], rank);
+            if (source == INDEX_NONE)
+            {
+                return false;
+            }
+            shape.Add(a.Shape[source]);
+            outStrides[i] = inStrides[source];
+        }
+        float* y = PrepareOutput(out, shape);
+        const float* x = a.Data.GetData();
+        int64 index[MaxRank] = {};
+        int64 offset = 0;
+        for (int32 i = 0; i < out.Data.Num(); ++i)
+        {
+            y[i] = x[offset];
+            for (int32 d = rank - 1; d >= 0; --d)
+            {
+                ++index[d];
+                offset += outStrides[d];
+                if (index[d] < shape[d])
+                {
+                    break;
+                }
+                offset -= outStrides[d] * shape[d];
+                index[d] = 0;
+            }
+        }
+        break;
+    }
+    default:
+        bSucceeded = false;
+        break;
+    }
+
+    if (!bSucceeded)
+    {
+        UE_LOG(LogTemp, Error, TEXT("FNativeClothModel::Run: Operator %d failed on an input of rank %d (incompatible shapes)."), static_cast<int32>(Node.Op), rank);
+    }
+    return bSucceeded;
+}
+
+bool FNativeClothModel::RunRecurrent(const FNode& Node, FNativeClothRunContext& Context) const
+{
+    const bool bLSTM = Node.Op == EOp::LSTM;
+    const int64 numGates = bLSTM ? 4 : 3;
+    const int64 hidden = Node.HiddenSize;
+    const int64 gateSize = numGates * hidden;
+
+    const FTensor& x = GetValue(Context, Node.Inputs[0]);
+    const FTensor& wt = GetValue(Context, Node.Inputs[1]);
+    const FTensor& rt = GetValue(Context, Node.Inputs[2]);
+    const FTensor& wb = GetValue(Context, Node.Inputs[3]);
+    const FTensor& rb = GetValue(Context, Node.Inputs[4]);
+    if (x.Shape.Num() != 3 || x.Shape[2] != wt.Shape[0])
+    {
+        UE_LOG(LogTemp, Error, TEXT("FNativeClothModel::Run: Recurrent layer input must be [seq, batch, %lld]."), wt.Shape[0]);
+        return false;
+    }
+    const int64 seqLength = x.Shape[0];
+    const int64 batch = x.Shape[1];
+    const int64 stateSize = batch * hidden;
+
+    // 状态：h (与 LSTM 的 c，或 GRU 的 r⊙h)，初始值来自可选输入，否则为 0
+    TArray<float>& state = Context.Scratch[2];
+    state.SetNumUninitialized(static_cast<int32>(2 * stateSize), EAllowShrinking::No);
+    float* h = state.GetData();
+    float* extra = h + stateSize;
+    const int32 initialInputs[] = {5, 6};
+    float* initialTargets[] = {h, extra};
+    for (int32 i = 0; i < (bLSTM ? 2 : 1); ++i)
+    {
+        const int32 value = Node.Inputs[initialInputs[i]];
+        if (value == INDEX_NONE)
+        {
+            FMemory::Memzero(initialTargets[i], stateSize * sizeof(float));
+            continue;
+        }
+        const FTensor& initial = GetValue(Context, value);
+        if (initial.Data.Num() != stateSize)
+        {
+            UE_LOG(LogTemp, Error, TEXT("FNativeClothModel::Run: Initial state has %d elements, expected %lld."), initial.Data.Num(), stateSize);
+            return false;
+        }
+        FMemory::Memcpy(initialTargets[i], initial.Data.GetData(), stateSize * sizeof(float));
+    }
+
+    // 所有时间步的输入投影 Gx[seq * batch, G * H] 与每步的隐藏投影 Gh[batch, G * H]
+    TArray<float>& gx = Context.Scratch[0];
+    gx.SetNumUninitialized(static_cast<int32>(seqLength * batch * gateSize), EAllowShrinking::No);
+    TArray<float>& gh = Context.Scratch[1];
+    gh.SetNumUninitialized(static_cast<int32>(batch * gateSize), EAllowShrinking::No);
+
+    const int32 outputY = Node.Outputs.IsValidIndex(0) ? Node.Outputs[0] : INDEX_NONE;
+    float* y = nullptr;
+    if (outputY != INDEX_NONE)
+    {
+        const int64 shape[] = {seqLength, 1, batch, hidden};
+        y = PrepareOutput(Context.Values[outputY], shape);
+    }
+
+    if (bLSTM)
+    {
+        ClothNativeKernels::LstmSequence(x.Data.GetData(), seqLength, batch, x.Shape[2], hidden, wt.Data.GetData(), rt.Data.GetData(),
+                                         wb.Data.GetData(), rb.Data.GetData(), h, extra, y, gx.GetData(), gh.GetData());
+    }
+    else
+    {
+        ClothNativeKernels::GruSequence(x.Data.GetData(), seqLength, batch, x.Shape[2], hidden, wt.Data.GetData(), rt.Data.GetData(),
+                                        wb.Data.GetData(), rb.Data.GetData(), Node.bLinearBeforeReset, h, y, gx.GetData(), gh.GetData(), extra);
+    }
+
+    // Y_h 与 LSTM 的 Y_c：[1, batch, hidden]
+    const int64 stateShape[] = {1, batch, hidden};
+    const float* finalStates[] = {h, extra};
+    for (int32 i = 1; i < Node.Outputs.Num() && i <= (bLSTM ? 2 : 1); ++i)
+    {
+        if (Node.Outputs[i] != INDEX_NONE)
+        {
+            float* target = PrepareOutput(Context.Values[Node.Outputs[i]], stateShape);
+            FMemory::Memcpy(target, finalStates[i - 1], stateSize * sizeof(float));
+        }
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+#include "OnnxBatchRunner.h"
+#include "OnnxModelInstance.h"
+#include "ClothDeformerStats.h"
+#include "Algo/AllOf.h"
+
+bool FOnnxBatchRunner::SupportsBatching(const FOnnxModelInstance& Instance)
+{
+#if WITH_CLOTH_ORT
+    if (!Instance.IsInitialized() || Instance.IsNative())
+    {
+        return false;
+    }
+    // 第 0 维是唯一的动态维度；其他维度带符号的模型需要逐实例绑定，float16 输入输出的模型逐个运行，都不参与打包
+    auto IsBatchDim = [](const FOnnxTensorSlot& Slot)
+    {
+        return Slot.DynamicDimIndex == 0 && Slot.NumDynamicDims == 1 && Slot.ElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+    };
+    return Instance.inputSlots_.Num() > 0 &&
+           Algo::AllOf(Instance.inputSlots_, IsBatchDim) &&
+           Algo::AllOf(Instance.outputSlots_, IsBatchDim);
+#else
+    return false;
+#endif
+}
+
+bool FOnnxBatchRunner::Run(TConstArrayView<FOnnxBatchItem> Items)
+{
+    CLOTH_DEFORMER_SCOPE(Inference);
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+
+    if (Items.Num() == 0)
+    {
+        return true;
+    }
+
+#if WITH_CLOTH_ORT
+    const FOnnxModelInstance& first = *Items[0].Instance;
+    if (!SupportsBatching(first))
+    {
+        return false;
+    }
+    const TArray<FOnnxTensorSlot>& inputSlots = first.inputSlots_;
+    const TArray<FOnnxTensorSlot>& outputSlots = first.outputSlots_;
+    for (const FOnnxBatchItem& item : Items)
+    {
+        if (!item.Instance || item.Instance->session_ != first.session_ ||
+            item.Inputs.Num() != inputSlots.Num() || item.Outputs.Num() != outputSlots.Num())
+        {
+            UE_LOG(LogTemp, Error, TEXT("FOnnxBatchRunner: Batch items do not share one session or have mismatched slot counts."));
+            return false;
+        }
+    }
+
+    const int32 batchSize = Items.Num();
+    packedInputs_.SetNum(inputSlots.Num());
+    packedOutputs_.SetNum(outputSlots.Num());
+    inputShapes_.resize(inputSlots.Num());
+    outputShapes_.resize(outputSlots.Num());
+
+    try
+    {
+        // 1. 打包输入：每个角色占第 0 维的一行，循环状态从实例当前的读缓冲取
+        inputTensors_.clear();
+        for (int32 i = 0; i < inputSlots.Num(); ++i)
+        {
+            const FOnnxTensorSlot& slot = inputSlots[i];
+            const int32 rowSize = static_cast<int32>(slot.StaticElementCount);
+            TArray<float>& packed = packedInputs_[i];
+            packed.SetNumUninitialized(rowSize * batchSize, EAllowShrinking::No);
+
+            for (int32 b = 0; b < batchSize; ++b)
+            {
+                const FOnnxBatchItem& item = Items[b];
+                const TConstArrayView<float> source = slot.RecurrentPair != INDEX_NONE ? item.Instance->GetRecurrentState(slot.RecurrentPair) : item.Inputs[i];
+                if (source.Num() != rowSize)
+                {
+                    UE_LOG(LogTemp, Error, TEXT("FOnnxBatchRunner: Input %s of batch item %d has %d elements, expected %d."), *slot.Name, b, source.Num(), rowSize);
+                    inputTensors_.clear();
+                    return false;
+                }
+                FMemory::Memcpy(packed.GetData() + b * rowSize, source.GetData(), rowSize * sizeof(float));
+            }
+
+            inputShapes_[i].assign(slot.Shape.begin(), slot.Shape.end());
+            inputShapes_[i][0] = batchSize;
+            inputTensors_.push_back(Ort::Value::CreateTensor<float>(first.memoryInfo_, packed.GetData(), packed.Num(), inputShapes_[i].data(), inputShapes_[i].size()));
+        }
+
+        // 2. 输出直接写入打包缓冲 (每行尺寸是静态的)
+        outputTensors_.clear();
+        for (int32 i = 0; i < outputSlots.Num(); ++i)
+        {
+            const FOnnxTensorSlot& slot = outputSlots[i];
+            TArray<float>& packed = packedOutputs_[i];
+            packed.SetNumUninitialized(static_cast<int32>(slot.StaticElementCount) * batchSize, EAllowShrinking::No);
+
+            outputShapes_[i].assign(slot.Shape.begin(), slot.Shape.end());
+            outputShapes_[i][0] = batchSize;
+            outputTensors_.push_back(Ort::Value::CreateTensor<float>(first.memoryInfo_, packed.GetData(), packed.Num(), outputShapes_[i].data(), outputShapes_[i].size()));
+        }
+
+        // 3. 一次推理
+        first.session_->Run(
+            Ort::RunOptions{nullptr},
+            first.inputNames_.data(),
+            inputTensors_.data(),
+            inputTensors_.size(),
+            first.outputNames_.data(),
+            outputTensors_.data(),
+            outputTensors_.size());
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("FOnnxBatchRunner: ONNX Runtime error: %s"), UTF8_TO_TCHAR(e.what()));
+        inputTensors_.clear();
+        outputTensors_.clear();
+        return false;
+    }
+    inputTensors_.clear();
+    outputTensors_.clear();
+
+    // 4. 拆回结果：普通输出写入调用方数组，新状态写入实例的写缓冲后轮换
+    for (int32 i = 0; i < outputSlots.Num(); ++i)
+    {
+        const FOnnxTensorSlot& slot = outputSlots[i];
+        const int32 rowSize = static_cast<int32>(slot.StaticElementCount);
+        const float* packed = packedOutputs_[i].GetData();
+
+        for (int32 b = 0; b < batchSize; ++b)
+        {
+            const FOnnxBatchItem& item = Items[b];
+            TArray<float>* target = nullptr;
+            if (slot.RecurrentPair != INDEX_NONE)
+            {
+                FOnnxModelInstance::FRecurrentState& state = item.Instance->recurrentStates_[slot.RecurrentPair];
+                target = &state.Buffers[1 - item.Instance->stateReadIndex_];
+            }
+            else
+            {
+                target = &item.Outputs[i];
+                if (target->Num() != rowSize)
+                {
+                    target->SetNumUninitialized(rowSize);
+                }
+            }
+
+            if (target->Num() == rowSize)
+            {
+                FMemory::Memcpy(target->GetData(), packed + b * rowSize, rowSize * sizeof(float));
+            }
+        }
+    }
+
+    for (const FOnnxBatchItem& item : Items)
+    {
+        if (item.Instance->recurrentStates_.Num() > 0)
+        {
+            item.Instance->stateReadIndex_ = 1 - item.Instance->stateReadIndex_;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
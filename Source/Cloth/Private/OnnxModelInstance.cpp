@@ -1,5 +1,9 @@
 #include "OnnxModelInstance.h"
 #include "ClothDeformationModelAsset.h"
+#include "OnnxSessionRegistry.h"
+#include "ClothGeneratedEvaluator.h"
+#include "ClothDeformerStats.h"
+#include "OrtUEAllocator.h"
 
 // 包含ONNX Runtime的实现头文件
 #if PLATFORM_WINDOWS && PLATFORM_64BITS
@@ -10,8 +14,49 @@
 #include "Windows/HideWindowsPlatformTypes.h"
 #endif
 
+#if WITH_CLOTH_ORT
+namespace
+{
+    bool IsFloatOrHalf(ONNXTensorElementDataType InType)
+    {
+        return InType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || InType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+    }
+
+    // float -> float16，尺寸不变时不重新分配转换缓冲
+    void ConvertToHalf(TConstArrayView<float> InData, TArray<Ort::Float16_t>& OutHalf)
+    {
+        OutHalf.SetNumUninitialized(InData.Num(), EAllowShrinking::No);
+        for (int32 i = 0; i < InData.Num(); ++i)
+        {
+            OutHalf[i] = Ort::Float16_t(InData[i]);
+        }
+    }
+
+    void ConvertFromHalf(const Ort::Float16_t* InHalf, int32 Num, TArray<float>& OutData)
+    {
+        OutData.SetNumUninitialized(Num, EAllowShrinking::No);
+        for (int32 i = 0; i < Num; ++i)
+        {
+            OutData[i] = InHalf[i].ToFloat();
+        }
+    }
+}
+#endif
+
 FOnnxModelInstance::FOnnxModelInstance(UClothDeformationModelAsset *InModelAsset)
+    : FOnnxModelInstance(InModelAsset, InModelAsset ? InModelAsset->GetRuntimePrecision() : EClothModelPrecision::FP32)
 {
+}
+
+FOnnxModelInstance::FOnnxModelInstance(UClothDeformationModelAsset *InModelAsset, EClothModelPrecision InPrecision)
+    : FOnnxModelInstance(InModelAsset, InPrecision, InModelAsset ? InModelAsset->GetInferenceBackend() : EClothInferenceBackend::OnnxRuntime)
+{
+}
+
+FOnnxModelInstance::FOnnxModelInstance(UClothDeformationModelAsset *InModelAsset, EClothModelPrecision InPrecision, EClothInferenceBackend InBackend)
+{
+    // 共享会话在 Acquire 中另行计入 ClothDeformer/Sessions
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
     UE_LOG(LogTemp, Log, TEXT("Creating FOnnxModelInstance..."));
 
     if (!InModelAsset)
@@ -21,265 +66,933 @@ FOnnxModelInstance::FOnnxModelInstance(UClothDeformationModelAsset *InModelAsset
     }
 
     // 检查是否有模型数据
-    if (InModelAsset->modelData_.Num() == 0)
+    if (InModelAsset->GetModelData(InPrecision).Num() == 0)
     {
-        UE_LOG(LogTemp, Error, TEXT("Model Asset has no data (modelData_ is empty). Make sure to re-import or update the asset."));
+        UE_LOG(LogTemp, Error, TEXT("Model Asset has no data for precision %d. Make sure to re-import or update the asset."), static_cast<int32>(InPrecision));
         return;
     }
 
-    try
+#if WITH_CLOTH_ORT
+    const bool bInitialized = InBackend == EClothInferenceBackend::Native
+        ? InitializeNative(InModelAsset, InPrecision)
+        : InitializeOrt(InModelAsset, InPrecision);
+#else
+    if (InBackend != EClothInferenceBackend::Native)
     {
-        // 创建ONNX环境
-        env_ = MakeUnique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "ClothModel");
-
-        // 创建会话选项
-        Ort::SessionOptions sessionOptions;
-        sessionOptions.SetIntraOpNumThreads(1);
-        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_BASIC);
+        UE_LOG(LogTemp, Log, TEXT("ONNX Runtime is not available on this platform, %s uses the native backend."), *InModelAsset->GetName());
+    }
+    const bool bInitialized = InitializeNative(InModelAsset, InPrecision);
+#endif
 
-        UE_LOG(LogTemp, Log, TEXT("Creating ONNX Session from memory (%d bytes)..."), InModelAsset->modelData_.Num());
+    bIsInitialized_ = bInitialized;
+    if (bIsInitialized_)
+    {
+        INC_DWORD_STAT(STAT_ClothDeformer_NumModelInstances);
+        UE_LOG(LogTemp, Log, TEXT("FOnnxModelInstance initialized successfully from asset memory"));
+    }
+}
 
-        // 从内存创建会话
-        session_ = MakeUnique<Ort::Session>(*env_, InModelAsset->modelData_.GetData(), InModelAsset->modelData_.Num(), sessionOptions);
+#if WITH_CLOTH_ORT
+bool FOnnxModelInstance::InitializeOrt(UClothDeformationModelAsset *InModelAsset, EClothModelPrecision InPrecision)
+{
+    try
+    {
+        // 从注册表获取 (或创建) 该资产的共享会话，同一资产的模型权重只加载一次
+        sharedSession_ = FOnnxSessionRegistry::Get().Acquire(InModelAsset, InPrecision);
+        if (!sharedSession_)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to acquire ONNX Session for %s"), *InModelAsset->GetName());
+            return false;
+        }
+        session_ = sharedSession_->Session.Get();
 
-        UE_LOG(LogTemp, Log, TEXT("ONNX Session created successfully"));
+        UE_LOG(LogTemp, Log, TEXT("ONNX Session acquired successfully"));
 
-        // 获取模型输入输出信息
+        // 获取模型输入输出信息：名字、元素类型与形状只在这里解析一次，Run 时按槽位索引直接使用
         Ort::AllocatorWithDefaultOptions allocator;
 
-        // Input Info
-        size_t numInputNodes = session_->GetInputCount();
-        if (numInputNodes > 0)
+        const size_t numInputNodes = session_->GetInputCount();
+        inputSlots_.Reserve(static_cast<int32>(numInputNodes));
+        for (size_t i = 0; i < numInputNodes; ++i)
         {
-            auto inputName = session_->GetInputNameAllocated(0, allocator);
-            inputNodeName_ = FString(UTF8_TO_TCHAR(inputName.get()));
-
-            Ort::TypeInfo typeInfo = session_->GetInputTypeInfo(0);
-            auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-            std::vector<int64_t> OnnxShape = tensorInfo.GetShape();
-
-
-            inputNodeDims_.SetNumUninitialized(OnnxShape.size());
-
-            // 内存块拷贝
-            FMemory::Memcpy(
-                inputNodeDims_.GetData(),   // 目标地址
-                OnnxShape.data(),           // 源地址
-                OnnxShape.size() * sizeof(int64) // 字节数
-            );
-
-            UE_LOG(LogTemp, Log, TEXT("Input Node: %s, Dimensions: %d"), *inputNodeName_, inputNodeDims_.Num());
+            const FOnnxTensorSlot& slot = inputSlots_.Add_GetRef(MakeTensorSlot(session_->GetInputNameAllocated(i, allocator), session_->GetInputTypeInfo(i), dimSymbols_));
+            if (!IsFloatOrHalf(slot.ElementType))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Input Node %s is not a float or float16 tensor (element type %d), which is not supported."), *slot.Name, static_cast<int32>(slot.ElementType));
+                return false;
+            }
+            UE_LOG(LogTemp, Log, TEXT("Input Node: %s, Dimensions: %d"), *slot.Name, static_cast<int32>(slot.Shape.size()));
         }
 
-        // Output Info
-        size_t numOutputNodes = session_->GetOutputCount();
-        if (numOutputNodes > 0)
+        const size_t numOutputNodes = session_->GetOutputCount();
+        outputSlots_.Reserve(static_cast<int32>(numOutputNodes));
+        for (size_t i = 0; i < numOutputNodes; ++i)
         {
-            auto outputName = session_->GetOutputNameAllocated(0, allocator);
-            outputNodeName_ = FString(UTF8_TO_TCHAR(outputName.get()));
-
-            // 可以存储 outputNodeDims_ 如果需要
-            UE_LOG(LogTemp, Log, TEXT("Output Node: %s"), *outputNodeName_);
+            const FOnnxTensorSlot& slot = outputSlots_.Add_GetRef(MakeTensorSlot(session_->GetOutputNameAllocated(i, allocator), session_->GetOutputTypeInfo(i), dimSymbols_));
+            if (!IsFloatOrHalf(slot.ElementType))
+            {
+                UE_LOG(LogTemp, Error, TEXT("Output Node %s is not a float or float16 tensor (element type %d), which is not supported."), *slot.Name, static_cast<int32>(slot.ElementType));
+                return false;
+            }
+            UE_LOG(LogTemp, Log, TEXT("Output Node: %s"), *slot.Name);
         }
 
-        bIsInitialized_ = true;
-        UE_LOG(LogTemp, Log, TEXT("FOnnxModelInstance initialized successfully from asset memory"));
+        memoryInfo_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault); // Warn:从 Mesh 获取顶点数据通常是在 CPU 上完成的. 理论上可以将顶点数据存在GPU上进行加速
+        inputTensors_.reserve(numInputNodes);
+        FinishSlotSetup(InModelAsset);
+
+        // IoBinding 路径的持久状态
+        runOptions_ = Ort::RunOptions{};
+        CreateBindingSets();
+        return true;
     }
     catch (const Ort::Exception &e)
     {
         UE_LOG(LogTemp, Error, TEXT("ONNX Runtime error in constructor: %s"), UTF8_TO_TCHAR(e.what()));
-        bIsInitialized_ = false;
     }
     catch (const std::exception &e)
     {
         UE_LOG(LogTemp, Error, TEXT("Standard exception in constructor: %s"), UTF8_TO_TCHAR(e.what()));
-        bIsInitialized_ = false;
     }
+    return false;
+}
+#endif
+
+bool FOnnxModelInstance::InitializeNative(UClothDeformationModelAsset *InModelAsset, EClothModelPrecision InPrecision)
+{
+    FString error;
+    nativeModel_ = FNativeClothModel::Acquire(InModelAsset->GetModelData(InPrecision), error);
+    if (!nativeModel_)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Native backend cannot load %s: %s"), *InModelAsset->GetName(), *error);
+        return false;
+    }
+
+    for (const FNativeTensorInfo& info : nativeModel_->GetInputs())
+    {
+        inputSlots_.Add(MakeTensorSlot(info.Name, static_cast<ONNXTensorElementDataType>(info.ElementType), info.Shape, info.SymbolicDims, dimSymbols_));
+    }
+    for (const FNativeTensorInfo& info : nativeModel_->GetOutputs())
+    {
+        outputSlots_.Add(MakeTensorSlot(info.Name, static_cast<ONNXTensorElementDataType>(info.ElementType), info.Shape, info.SymbolicDims, dimSymbols_));
+    }
+    nativeInputs_.SetNum(inputSlots_.Num());
+    nativeOutputs_.SetNum(outputSlots_.Num());
+
+    FinishSlotSetup(InModelAsset);
+
+    generatedEvaluator_ = FClothGeneratedEvaluatorRegistry::Get().Create(nativeModel_->GetDataCrc());
+    if (generatedEvaluator_ && (!generatedEvaluator_->Bind(*nativeModel_) ||
+        generatedEvaluator_->GetInputSizes().Num() != inputSlots_.Num() || generatedEvaluator_->GetOutputSizes().Num() != outputSlots_.Num()))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Generated evaluator for %s does not match the model data, regenerate it. Falling back to the interpreter."), *InModelAsset->GetName());
+        generatedEvaluator_.Reset();
+    }
+    UE_LOG(LogTemp, Log, TEXT("Native backend loaded %s (%d inputs, %d outputs, %s)"), *InModelAsset->GetName(), inputSlots_.Num(), outputSlots_.Num(),
+           generatedEvaluator_ ? TEXT("generated evaluator") : TEXT("interpreter"));
+    return true;
+}
+
+void FOnnxModelInstance::FinishSlotSetup(const UClothDeformationModelAsset *InModelAsset)
+{
+    // 槽位全部添加完后再收集名字指针，避免数组扩容使指针失效
+    for (const FOnnxTensorSlot& slot : inputSlots_)
+    {
+        inputNames_.push_back(slot.NameUtf8.GetData());
+    }
+    for (const FOnnxTensorSlot& slot : outputSlots_)
+    {
+        outputNames_.push_back(slot.NameUtf8.GetData());
+    }
+
+    inputShapes_.resize(inputSlots_.Num());
+    inputShapeKeys_.SetNum(inputSlots_.Num());
+    inputBuffers_.SetNum(inputSlots_.Num());
+    halfInputs_.SetNum(inputSlots_.Num());
+    halfOutputs_.SetNum(outputSlots_.Num());
+    dimSymbolValues_.Init(INDEX_NONE, dimSymbols_.Num());
+    for (const FString& symbol : dimSymbols_)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Symbolic dimension: %s"), *symbol);
+    }
+
+    ResolveRecurrentStates(InModelAsset);
+
+    // 静态形状的输出在这里就能确定元素数
+    outputShapes_.resize(outputSlots_.Num());
+    outputElementCounts_.Init(INDEX_NONE, outputSlots_.Num());
+    ResolveOutputShapes();
 }
 
 FOnnxModelInstance::~FOnnxModelInstance()
 {
+    if (bIsInitialized_)
+    {
+        DEC_DWORD_STAT(STAT_ClothDeformer_NumModelInstances);
+    }
+
+#if WITH_CLOTH_ORT
+    // 绑定与张量引用共享会话，先于 (可能是最后一份的) 会话引用释放
+    for (FBindingSet& set : bindingSets_)
+    {
+        set.Binding.Reset();
+        set.Inputs.Empty();
+        set.Outputs.Empty();
+    }
+    session_ = nullptr;
+    sharedSession_.Reset();
+#endif
+    nativeModel_.Reset();
 }
 
 bool FOnnxModelInstance::IsInitialized() const
 {
     return bIsInitialized_;
 }
+int32 FOnnxModelInstance::FindInputSlot(const FString& Name) const
+{
+    return inputSlots_.IndexOfByPredicate([&Name](const FOnnxTensorSlot& Slot) { return Slot.Name == Name; });
+}
+
+int32 FOnnxModelInstance::FindOutputSlot(const FString& Name) const
+{
+    return outputSlots_.IndexOfByPredicate([&Name](const FOnnxTensorSlot& Slot) { return Slot.Name == Name; });
+}
+
+int64 FOnnxModelInstance::GetDefaultElementCount(int32 InputSlot) const
+{
+    return inputSlots_.IsValidIndex(InputSlot) ? inputSlots_[InputSlot].StaticElementCount : 0;
+}
+
+TArrayView<float> FOnnxModelInstance::GetInputBuffer(int32 InputSlot)
+{
+    if (!inputSlots_.IsValidIndex(InputSlot) || inputSlots_[InputSlot].RecurrentPair != INDEX_NONE)
+    {
+        return TArrayView<float>();
+    }
+
+    const FOnnxTensorSlot& slot = inputSlots_[InputSlot];
+    int64 elementCount = 1;
+    for (size_t j = 0; j < slot.Shape.size(); ++j)
+    {
+        const int32 symbol = slot.DimSymbols[j];
+        const int64 dim = slot.Shape[j] > 0 ? slot.Shape[j] : (symbol != INDEX_NONE ? dimSymbolValues_[symbol] : INDEX_NONE);
+        if (dim <= 0)
+        {
+            return TArrayView<float>();
+        }
+        elementCount *= dim;
+    }
+
+    // 尺寸不变时地址不变，已有的绑定继续有效
+    TArray<float, TAlignedHeapAllocator<64>>& buffer = inputBuffers_[InputSlot];
+    if (buffer.Num() != elementCount)
+    {
+        LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+        buffer.SetNumZeroed(static_cast<int32>(elementCount));
+    }
+    return buffer;
+}
+
+int32 FOnnxModelInstance::FindDimSymbol(const FString& Name) const
+{
+    return dimSymbols_.IndexOfByKey(Name);
+}
+
+bool FOnnxModelInstance::BindDimSymbol(const FString& Name, int64 Value)
+{
+    const int32 symbolIndex = FindDimSymbol(Name);
+    if (symbolIndex == INDEX_NONE)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("BindDimSymbol: Model has no symbolic dimension named %s"), *Name);
+        return false;
+    }
+    BindDimSymbol(symbolIndex, Value);
+    return true;
+}
+
+void FOnnxModelInstance::BindDimSymbol(int32 SymbolIndex, int64 Value)
+{
+    if (!dimSymbolValues_.IsValidIndex(SymbolIndex))
+    {
+        return;
+    }
+    const int64 newValue = Value > 0 ? Value : INDEX_NONE;
+    if (dimSymbolValues_[SymbolIndex] != newValue)
+    {
+        dimSymbolValues_[SymbolIndex] = newValue;
+        ++shapeGeneration_;
+    }
+}
+
+void FOnnxModelInstance::ResetDimSymbols()
+{
+    for (int32 i = 0; i < dimSymbolValues_.Num(); ++i)
+    {
+        BindDimSymbol(i, INDEX_NONE);
+    }
+}
+
+void FOnnxModelInstance::ResolveOutputShapes()
+{
+    for (int32 i = 0; i < outputSlots_.Num(); ++i)
+    {
+        const FOnnxTensorSlot& slot = outputSlots_[i];
+        std::vector<int64_t>& shape = outputShapes_[i];
+        shape.assign(slot.Shape.begin(), slot.Shape.end());
+
+        int64 elementCount = 1;
+        for (size_t j = 0; j < shape.size() && elementCount != INDEX_NONE; ++j)
+        {
+            if (shape[j] <= 0)
+            {
+                const int32 symbol = slot.DimSymbols[j];
+                shape[j] = symbol != INDEX_NONE ? dimSymbolValues_[symbol] : INDEX_NONE;
+            }
+            elementCount = shape[j] > 0 ? elementCount * shape[j] : INDEX_NONE;
+        }
+
+        // 仍有未知维度时由 ORT 分配一次以得到形状
+        outputElementCounts_[i] = elementCount;
+    }
+    outputShapeGeneration_ = shapeGeneration_;
+}
+
+FOnnxTensorSlot FOnnxModelInstance::MakeTensorSlot(const FString& InName, ONNXTensorElementDataType InElementType, TConstArrayView<int64> InShape, TConstArrayView<FString> InSymbolicDims, TArray<FString>& InOutDimSymbols)
+{
+    FOnnxTensorSlot slot;
+    slot.Name = InName;
+    const FTCHARToUTF8 nameUtf8(*InName);
+    slot.NameUtf8.Append(nameUtf8.Get(), nameUtf8.Length());
+    slot.NameUtf8.Add('\0');
+    slot.ElementType = InElementType;
+    slot.Shape.assign(InShape.begin(), InShape.end());
+
+    slot.DimSymbols.Init(INDEX_NONE, static_cast<int32>(slot.Shape.size()));
+    for (size_t j = 0; j < slot.Shape.size(); ++j)
+    {
+        if (slot.Shape[j] > 0)
+        {
+            slot.StaticElementCount *= slot.Shape[j];
+            continue;
+        }
+
+        // 动态维度：具名的 (dim_param) 加入符号表，匿名的只能由数据长度推算
+        slot.Shape[j] = -1;
+        ++slot.NumDynamicDims;
+        if (slot.DynamicDimIndex == INDEX_NONE)
+        {
+            slot.DynamicDimIndex = static_cast<int32>(j);
+        }
+        const int32 dimIndex = static_cast<int32>(j);
+        if (InSymbolicDims.IsValidIndex(dimIndex) && !InSymbolicDims[dimIndex].IsEmpty())
+        {
+            slot.DimSymbols[dimIndex] = InOutDimSymbols.AddUnique(InSymbolicDims[dimIndex]);
+        }
+    }
+    return slot;
+}
+
+#if WITH_CLOTH_ORT
+FOnnxTensorSlot FOnnxModelInstance::MakeTensorSlot(const Ort::AllocatedStringPtr& InName, const Ort::TypeInfo& InTypeInfo, TArray<FString>& InOutDimSymbols)
+{
+    auto tensorInfo = InTypeInfo.GetTensorTypeAndShapeInfo();
+    const std::vector<int64_t> shape = tensorInfo.GetShape();
+
+    std::vector<const char*> symbolicDims(shape.size(), nullptr);
+    if (!symbolicDims.empty())
+    {
+        tensorInfo.GetSymbolicDimensions(symbolicDims.data(), symbolicDims.size());
+    }
+
+    TArray<int64, TInlineAllocator<8>> dims;
+    TArray<FString, TInlineAllocator<8>> symbols;
+    for (size_t j = 0; j < shape.size(); ++j)
+    {
+        dims.Add(shape[j]);
+        symbols.Add(symbolicDims[j] ? FString(UTF8_TO_TCHAR(symbolicDims[j])) : FString());
+    }
+    return MakeTensorSlot(FString(UTF8_TO_TCHAR(InName.get())), tensorInfo.GetElementType(), dims, symbols, InOutDimSymbols);
+}
+#endif
+
+void FOnnxModelInstance::ResolveRecurrentStates(const UClothDeformationModelAsset* InModelAsset)
+{
+    TArray<FRecurrentStatePair> pairs = InModelAsset->recurrentStatePairs_;
+    if (pairs.Num() == 0)
+    {
+        // 旧资产没有声明配对，按名字猜测，与之前的行为一致
+        TArray<FString> inputNames;
+        TArray<FString> outputNames;
+        for (const FOnnxTensorSlot& slot : inputSlots_)
+        {
+            inputNames.Add(slot.Name);
+        }
+        for (const FOnnxTensorSlot& slot : outputSlots_)
+        {
+            outputNames.Add(slot.Name);
+        }
+        pairs = UClothDeformationModelAsset::GuessRecurrentStatePairs(inputNames, outputNames);
+        if (pairs.Num() > 0)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Model asset declares no recurrent state pairs, guessed %d by name. Re-import the model to store them."), pairs.Num());
+        }
+    }
+
+    for (const FRecurrentStatePair& pair : pairs)
+    {
+        const int32 inputSlot = FindInputSlot(pair.InputName);
+        const int32 outputSlot = FindOutputSlot(pair.OutputName);
+        if (inputSlot == INDEX_NONE || outputSlot == INDEX_NONE ||
+            inputSlots_[inputSlot].RecurrentPair != INDEX_NONE || outputSlots_[outputSlot].RecurrentPair != INDEX_NONE)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Recurrent state pair %s -> %s does not match the model or is declared twice, ignored."), *pair.OutputName, *pair.InputName);
+            continue;
+        }
+
+        // 状态按输入声明的形状分配，动态维度取 1；输出为静态形状时必须与之一致
+        const FOnnxTensorSlot& stateInput = inputSlots_[inputSlot];
+        const FOnnxTensorSlot& stateOutput = outputSlots_[outputSlot];
+        if (stateInput.ElementType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || stateOutput.ElementType != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Recurrent state pair %s -> %s must be float32 (export FP16 variants with float32 I/O), ignored."), *pair.OutputName, *pair.InputName);
+            continue;
+        }
+        const int64 elementCount = stateInput.StaticElementCount;
+        if (stateOutput.DynamicDimIndex == INDEX_NONE && stateOutput.StaticElementCount != elementCount)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Recurrent state pair %s -> %s has mismatched sizes (%lld vs %lld), ignored."), *pair.OutputName, *pair.InputName, stateOutput.StaticElementCount, elementCount);
+            continue;
+        }
+
+        const int32 pairIndex = recurrentStates_.Num();
+        FRecurrentState& state = recurrentStates_.AddDefaulted_GetRef();
+        state.InputSlot = inputSlot;
+        state.OutputSlot = outputSlot;
+        state.Shape = stateInput.Shape;
+        for (int64_t& dim : state.Shape)
+        {
+            dim = dim > 0 ? dim : 1;
+        }
+        state.Buffers[0].SetNumZeroed(static_cast<int32>(elementCount));
+        state.Buffers[1].SetNumZeroed(static_cast<int32>(elementCount));
+
+        inputSlots_[inputSlot].RecurrentPair = pairIndex;
+        outputSlots_[outputSlot].RecurrentPair = pairIndex;
+        UE_LOG(LogTemp, Log, TEXT("Recurrent state: %s -> %s (%lld floats)"), *pair.OutputName, *pair.InputName, elementCount);
+    }
+}
+
+#if WITH_CLOTH_ORT
+void FOnnxModelInstance::CreateBindingSets()
+{
+    const int32 numSets = recurrentStates_.Num() > 0 ? 2 : 1;
+    for (int32 k = 0; k < numSets; ++k)
+    {
+        FBindingSet& set = bindingSets_[k];
+        set.Binding = MakeUnique<Ort::IoBinding>(*session_);
+        set.Inputs.SetNum(inputSlots_.Num());
+        set.Outputs.SetNum(outputSlots_.Num());
+
+        // 状态缓冲的地址在实例生命周期内不变，构造时绑定一次即可
+        for (FRecurrentState& state : recurrentStates_)
+        {
+            TArray<float>& readBuffer = state.Buffers[k];
+            TArray<float>& writeBuffer = state.Buffers[1 - k];
+
+            FBoundTensor& boundInput = set.Inputs[state.InputSlot];
+            boundInput.Value = Ort::Value::CreateTensor<float>(memoryInfo_, readBuffer.GetData(), readBuffer.Num(), state.Shape.data(), state.Shape.size());
+            boundInput.Data = readBuffer.GetData();
+            boundInput.Num = readBuffer.Num();
+            set.Binding->BindInput(inputNames_[state.InputSlot], boundInput.Value);
+
+            FBoundTensor& boundOutput = set.Outputs[state.OutputSlot];
+            boundOutput.Value = Ort::Value::CreateTensor<float>(memoryInfo_, writeBuffer.GetData(), writeBuffer.Num(), state.Shape.data(), state.Shape.size());
+            boundOutput.Data = writeBuffer.GetData();
+            boundOutput.Num = writeBuffer.Num();
+            set.Binding->BindOutput(outputNames_[state.OutputSlot], boundOutput.Value);
+        }
+    }
+    stateReadIndex_ = 0;
+}
+#endif
+
+TConstArrayView<float> FOnnxModelInstance::GetRecurrentState(int32 PairIndex) const
+{
+    return recurrentStates_.IsValidIndex(PairIndex) ? TConstArrayView<float>(recurrentStates_[PairIndex].Buffers[stateReadIndex_]) : TConstArrayView<float>();
+}
+
+void FOnnxModelInstance::ResetRecurrentState()
+{
+    for (FRecurrentState& state : recurrentStates_)
+    {
+        FMemory::Memzero(state.Buffers[0].GetData(), state.Buffers[0].Num() * sizeof(float));
+        FMemory::Memzero(state.Buffers[1].GetData(), state.Buffers[1].Num() * sizeof(float));
+    }
+}
+
 bool FOnnxModelInstance::Run(const TMap<FString, TArray<float>>& Inputs, TArray<float>& HiddenState, TMap<FString, TArray<float>>& Outputs)
 {
-    if (!bIsInitialized_ || !session_)
+    if (!bIsInitialized_)
     {
         UE_LOG(LogTemp, Error, TEXT("Run: Model not initialized."));
         return false;
     }
-    try
+
+    TArray<TConstArrayView<float>, TInlineAllocator<8>> inputViews;
+    for (int32 i = 0; i < inputSlots_.Num(); ++i)
     {
-        Ort::AllocatorWithDefaultOptions Allocator{};
-        size_t NumInputs = session_->GetInputCount();
-        std::vector<const char*> InputNames;
-        std::vector<Ort::AllocatedStringPtr> inputNamePtrs;
-        std::vector<Ort::Value> InputTensors;
-        
-        for (size_t i = 0; i < NumInputs; ++i)
+        const TArray<float>* sourceData = inputSlots_[i].RecurrentPair == INDEX_NONE ? Inputs.Find(inputSlots_[i].Name) : nullptr;
+        if (!sourceData)
         {
-            auto NamePtr = session_->GetInputNameAllocated(i, Allocator);
-            FString inputNameStr(UTF8_TO_TCHAR(NamePtr.get()));
-            
-            InputNames.push_back(NamePtr.get());
-            inputNamePtrs.push_back(std::move(NamePtr));
+            // 循环状态输入，或在 Inputs 字典里找不到的输入，当作 HiddenState 喂给模型
+            // 第一帧 HiddenState 是空的，需要根据模型要求的尺寸初始化填充0
+            if (HiddenState.Num() == 0)
+            {
+                HiddenState.Init(0.0f, static_cast<int32>(GetDefaultElementCount(i)));
+            }
+            sourceData = &HiddenState;
+        }
+        inputViews.Add(*sourceData);
+    }
 
-            const TArray<float>* sourceData = nullptr;
+    TArray<TArray<float>, TInlineAllocator<4>> outputData;
+    outputData.SetNum(outputSlots_.Num());
+    if (!Run(inputViews, outputData))
+    {
+        return false;
+    }
+
+    // 隐藏状态输出更新到 HiddenState，普通输出（如预测的顶点位移）放入字典供外部提取
+    Outputs.Reset();
+    for (int32 i = 0; i < outputSlots_.Num(); ++i)
+    {
+        if (outputSlots_[i].RecurrentPair != INDEX_NONE)
+        {
+            HiddenState = MoveTemp(outputData[i]);
+        }
+        else
+        {
+            Outputs.Add(outputSlots_[i].Name, MoveTemp(outputData[i]));
+        }
+    }
+    return true;
+}
+
+bool FOnnxModelInstance::Run(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs)
+{
+    CLOTH_DEFORMER_SCOPE(Inference);
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+
+    if (!bIsInitialized_)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Run: Model not initialized."));
+        return false;
+    }
+    if (Inputs.Num() != inputSlots_.Num() || Outputs.Num() != outputSlots_.Num())
+    {
+        UE_LOG(LogTemp, Error, TEXT("Run: Expected %d inputs and %d outputs, got %d and %d."), inputSlots_.Num(), outputSlots_.Num(), Inputs.Num(), Outputs.Num());
+        return false;
+    }
+    if (nativeModel_)
+    {
+        return RunNative(Inputs, Outputs, false);
+    }
 
-            if (Inputs.Contains(inputNameStr))
+#if WITH_CLOTH_ORT
+    try
+    {
+        // 张量只包装调用方的数据，形状缓冲在调用间复用
+        inputTensors_.clear();
+        for (int32 i = 0; i < inputSlots_.Num(); ++i)
+        {
+            Ort::Value tensor{nullptr};
+            if (!ResolveInputShape(i, Inputs[i].Num()) ||
+                !CreateInputTensor(i, Inputs[i], inputShapes_[i], tensor))
             {
-                sourceData = &Inputs[inputNameStr];
+                UE_LOG(LogTemp, Error, TEXT("Run: Failed to create tensor for input %s"), *inputSlots_[i].Name);
+                inputTensors_.clear();
+                return false;
             }
-            else
+            inputTensors_.push_back(std::move(tensor));
+        }
+
+        // 执行推理
+        auto outputTensors = session_->Run(
+            Ort::RunOptions{nullptr},
+            inputNames_.data(),
+            inputTensors_.data(),
+            inputTensors_.size(),
+            outputNames_.data(),
+            outputNames_.size());
+        inputTensors_.clear();
+
+        for (int32 i = 0; i < outputSlots_.Num(); ++i)
+        {
+            if (!ExtractOutputTensorData(outputTensors[i], Outputs[i]))
             {
-                // 如果在 Inputs 字典里找不到，默认当作 HiddenState 喂给模型
-                sourceData = &HiddenState;
+                UE_LOG(LogTemp, Warning, TEXT("Run: Failed to extract output %s"), *outputSlots_[i].Name);
+                return false;
             }
+        }
+        return true;
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Run: ONNX Runtime error: %s"), UTF8_TO_TCHAR(e.what()));
+    }
+    inputTensors_.clear();
+#endif
+    return false;
+}
+
+bool FOnnxModelInstance::RunNative(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs, bool bRecurrent)
+{
+    // 循环状态与 IoBinding 路径一致：从读缓冲取、写入写缓冲，成功后轮换
+    for (int32 i = 0; i < inputSlots_.Num(); ++i)
+    {
+        const int32 pair = bRecurrent ? inputSlots_[i].RecurrentPair : INDEX_NONE;
+        nativeInputs_[i] = pair != INDEX_NONE ? TConstArrayView<float>(recurrentStates_[pair].Buffers[stateReadIndex_]) : Inputs[i];
+        if (!ResolveInputShape(i, nativeInputs_[i].Num()))
+        {
+            UE_LOG(LogTemp, Error, TEXT("RunNative: Failed to resolve the shape of input %s"), *inputSlots_[i].Name);
+            return false;
+        }
+    }
 
-            auto typeInfo = session_->GetInputTypeInfo(i);
-            auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
-            std::vector<int64_t> dims = tensorInfo.GetShape();
+    for (int32 i = 0; i < outputSlots_.Num(); ++i)
+    {
+        const int32 pair = bRecurrent ? outputSlots_[i].RecurrentPair : INDEX_NONE;
+        nativeOutputs_[i] = pair != INDEX_NONE ? &recurrentStates_[pair].Buffers[1 - stateReadIndex_] : &Outputs[i];
+    }
+
+    // 输入尺寸与生成时一致才能用生成的求值器 (符号维度绑定为其他值时回退到解释执行)
+    bool bGenerated = generatedEvaluator_ && bUseGeneratedEvaluator_;
+    if (bGenerated)
+    {
+        const TConstArrayView<int64> sizes = generatedEvaluator_->GetInputSizes();
+        for (int32 i = 0; i < nativeInputs_.Num() && bGenerated; ++i)
+        {
+            bGenerated = nativeInputs_[i].Num() == sizes[i];
+        }
+    }
 
-            int64_t knownSize = 1;
-            int32 dynamicIndex = -1;
-            for (size_t j = 0; j < dims.size(); ++j)
+    if (bGenerated)
+    {
+        generatedEvaluator_->Run(nativeInputs_, nativeOutputs_);
+    }
+    else if (!nativeModel_->Run(nativeContext_, nativeInputs_, TConstArrayView<std::vector<int64_t>>(inputShapes_.data(), static_cast<int32>(inputShapes_.size())), nativeOutputs_))
+    {
+        return false;
+    }
+
+    if (bRecurrent && recurrentStates_.Num() > 0)
+    {
+        stateReadIndex_ = 1 - stateReadIndex_;
+    }
+    return true;
+}
+
+FOnnxModelInstance::FAllocationProbe::FAllocationProbe(FOnnxModelInstance& InInstance, TConstArrayView<TArray<float>> InOutputs)
+    : Instance(InInstance)
+    , Outputs(InOutputs)
+    , BufferSignature(InInstance.GetBufferSignature(InOutputs))
+#if WITH_CLOTH_ORT
+    , OrtAllocations(FOrtUEAllocator::GetAllocationCount())
+#else
+    , OrtAllocations(0)
+#endif
+{
+}
+
+FOnnxModelInstance::FAllocationProbe::~FAllocationProbe()
+{
+#if WITH_CLOTH_ORT
+    Instance.allocationCount_ += FOrtUEAllocator::GetAllocationCount() - OrtAllocations;
+#endif
+    if (Instance.GetBufferSignature(Outputs) != BufferSignature)
+    {
+        ++Instance.allocationCount_;
+    }
+}
+
+uint64 FOnnxModelInstance::GetBufferSignature(TConstArrayView<TArray<float>> Outputs) const
+{
+    // 混入每块缓冲的地址与容量，任何一块重新分配都会改变签名
+    uint64 signature = 0;
+    auto mix = [&signature](const void* Data, int32 Capacity)
+        {
+            signature = (signature ^ (static_cast<uint64>(reinterpret_cast<UPTRINT>(Data)) + static_cast<uint32>(Capacity))) * 0x100000001b3ull;
+        };
+    auto mixArrays = [&mix](const auto& Arrays)
+        {
+            mix(Arrays.GetData(), Arrays.Num());
+            for (const auto& array : Arrays)
             {
-                if (dims[j] <= 0)
-                {
-                    dynamicIndex = static_cast<int32>(j);
-                }
-                else
-                {
-                    knownSize *= dims[j];
-                }
+                mix(array.GetData(), array.Max());
             }
-            // TODO 只能处理单一动态温度
-            // 如果存在 -1 这样的动态维度，通过传入的数组总长反推真实大小
-            if (dynamicIndex != -1 && knownSize > 0)
+        };
+
+    mixArrays(Outputs);
+    mixArrays(inputBuffers_);
+    mixArrays(halfInputs_);
+    mixArrays(halfOutputs_);
+    for (const FRecurrentState& state : recurrentStates_)
+    {
+        mix(state.Buffers[0].GetData(), state.Buffers[0].Max());
+        mix(state.Buffers[1].GetData(), state.Buffers[1].Max());
+    }
+    for (const FNativeClothRunContext::FTensor& value : nativeContext_.Values)
+    {
+        mix(value.Data.GetData(), value.Data.Max());
+        mix(value.Shape.GetData(), value.Shape.Max());
+    }
+    for (const TArray<float>& scratch : nativeContext_.Scratch)
+    {
+        mix(scratch.GetData(), scratch.Max());
+    }
+    return signature;
+}
+
+bool FOnnxModelInstance::RunWithBinding(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs)
+{
+    CLOTH_DEFORMER_SCOPE(Inference);
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+    FAllocationProbe allocationProbe(*this, Outputs);
+
+    if (nativeModel_)
+    {
+        if (!bIsInitialized_ || Inputs.Num() != inputSlots_.Num() || Outputs.Num() != outputSlots_.Num())
+        {
+            UE_LOG(LogTemp, Error, TEXT("RunWithBinding: Model not initialized or slot counts mismatch."));
+            return false;
+        }
+        return RunNative(Inputs, Outputs, true);
+    }
+
+#if WITH_CLOTH_ORT
+    FBindingSet& set = bindingSets_[stateReadIndex_];
+    if (!bIsInitialized_ || !session_ || !set.Binding)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RunWithBinding: Model not initialized."));
+        return false;
+    }
+    if (Inputs.Num() != inputSlots_.Num() || Outputs.Num() != outputSlots_.Num())
+    {
+        UE_LOG(LogTemp, Error, TEXT("RunWithBinding: Expected %d inputs and %d outputs, got %d and %d."), inputSlots_.Num(), outputSlots_.Num(), Inputs.Num(), Outputs.Num());
+        return false;
+    }
+
+    // 符号绑定变化后重新推算输出形状
+    if (outputShapeGeneration_ != shapeGeneration_)
+    {
+        ResolveOutputShapes();
+    }
+
+    bool bHasUnboundOutput = false;
+    try
+    {
+        // 1. 输入：地址、尺寸和符号绑定都没变时沿用上一帧的绑定
+        for (int32 i = 0; i < inputSlots_.Num(); ++i)
+        {
+            FBoundTensor& bound = set.Inputs[i];
+            if (inputSlots_[i].RecurrentPair != INDEX_NONE)
             {
-                dims[dynamicIndex] = sourceData->Num() / knownSize;
-                if (dims[dynamicIndex] <= 0)
-                {
-                    dims[dynamicIndex] = 1; // 兜底保护，防止除零或负数
-                }
+                continue;
             }
 
-            // 如果是第一帧，HiddenState 是空的，需要根据模型要求的尺寸初始化填充0
-            if (sourceData == &HiddenState && HiddenState.Num() == 0)
+            // float16 输入绑定的是转换缓冲，数据每帧都要重新转换；尺寸不变时缓冲地址不变，绑定照常沿用
+            const bool bHalf = inputSlots_[i].ElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+            if (bHalf && bound.Num == Inputs[i].Num() && bound.ShapeGeneration == shapeGeneration_)
             {
-                int64_t totalElements = 1;
-                for (int64_t dim : dims)
+                ConvertToHalf(Inputs[i], halfInputs_[i]);
+                if (bound.Data == halfInputs_[i].GetData())
                 {
-                    totalElements *= dim;
+                    continue;
                 }
-                HiddenState.Init(0.0f, static_cast<int32>(totalElements));
+            }
+            else if (!bHalf && bound.Data == Inputs[i].GetData() && bound.Num == Inputs[i].Num() && bound.ShapeGeneration == shapeGeneration_)
+            {
+                continue;
             }
 
-            Ort::Value tensor{ nullptr };
-            if (!CreateInputTensor(*sourceData, dims, tensor))
+            if (!ResolveInputShape(i, Inputs[i].Num()) ||
+                !CreateInputTensor(i, Inputs[i], inputShapes_[i], bound.Value))
             {
-                UE_LOG(LogTemp, Error, TEXT("Run: Failed to create tensor for input %s"), *inputNameStr);
+                UE_LOG(LogTemp, Error, TEXT("RunWithBinding: Failed to bind input %s"), *inputSlots_[i].Name);
+                bound.Data = nullptr;
                 return false;
             }
-            InputTensors.push_back(std::move(tensor));
+            set.Binding->BindInput(inputNames_[i], bound.Value);
+            bound.Data = bHalf ? static_cast<const void*>(halfInputs_[i].GetData()) : static_cast<const void*>(Inputs[i].GetData());
+            bound.Num = Inputs[i].Num();
+            bound.ShapeGeneration = shapeGeneration_;
         }
-        
-        // 准备输出节点名称
-        size_t numOutputs = session_->GetOutputCount();
-        std::vector<const char*> outputNames;
-        std::vector<Ort::AllocatedStringPtr> outputNamePtrs;
 
-        for (size_t i = 0; i < numOutputs; ++i)
+        // 2. 输出：形状已知的输出绑定到调用方的缓冲，形状未知的交给 ORT 分配
+        for (int32 i = 0; i < outputSlots_.Num(); ++i)
         {
-            auto namePtr = session_->GetOutputNameAllocated(i, Allocator);
-            outputNames.push_back(namePtr.get());
-            outputNamePtrs.push_back(std::move(namePtr));
+            if (outputSlots_[i].RecurrentPair != INDEX_NONE)
+            {
+                continue;
+            }
+
+            FBoundTensor& bound = set.Outputs[i];
+            const int64 elementCount = outputElementCounts_[i];
+            if (elementCount == INDEX_NONE)
+            {
+                if (bound.Num != INDEX_NONE)
+                {
+                    set.Binding->BindOutput(outputNames_[i], memoryInfo_);
+                    bound.Value = Ort::Value{nullptr};
+                    bound.Data = nullptr;
+                    bound.Num = INDEX_NONE;
+                }
+                bHasUnboundOutput = true;
+                continue;
+            }
+
+            if (Outputs[i].Num() != elementCount)
+            {
+                Outputs[i].SetNumZeroed(static_cast<int32>(elementCount));
+            }
+
+            // float16 输出写入转换缓冲，运行后再转换到 Outputs
+            const bool bHalf = outputSlots_[i].ElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+            if (bHalf && halfOutputs_[i].Num() != elementCount)
+            {
+                halfOutputs_[i].SetNumZeroed(static_cast<int32>(elementCount));
+            }
+            const void* target = bHalf ? static_cast<const void*>(halfOutputs_[i].GetData()) : static_cast<const void*>(Outputs[i].GetData());
+            if (bound.Data == target && bound.Num == Outputs[i].Num() && bound.ShapeGeneration == shapeGeneration_)
+            {
+                continue;
+            }
+
+            bound.Value = bHalf
+                ? Ort::Value::CreateTensor<Ort::Float16_t>(memoryInfo_, halfOutputs_[i].GetData(), halfOutputs_[i].Num(), outputShapes_[i].data(), outputShapes_[i].size())
+                : Ort::Value::CreateTensor<float>(memoryInfo_, Outputs[i].GetData(), Outputs[i].Num(), outputShapes_[i].data(), outputShapes_[i].size());
+            set.Binding->BindOutput(outputNames_[i], bound.Value);
+            bound.Data = target;
+            bound.Num = Outputs[i].Num();
+            bound.ShapeGeneration = shapeGeneration_;
         }
 
-        // 执行推理
+        // 3. 执行推理，ORT 直接读写绑定的内存
+        session_->Run(runOptions_, *set.Binding);
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RunWithBinding: ONNX Runtime error: %s"), UTF8_TO_TCHAR(e.what()));
 
-        auto outputTensors = session_->Run(
-            Ort::RunOptions{ nullptr },
-            InputNames.data(),
-            InputTensors.data(),
-            InputTensors.size(),
-            outputNames.data(),
-            outputNames.size()
-        );
+        // 输出形状可能已随输入变化，动态输出回到由 ORT 分配，下一帧重新得到形状
+        for (int32 i = 0; i < outputSlots_.Num(); ++i)
+        {
+            if (outputSlots_[i].NumDynamicDims > 0)
+            {
+                outputElementCounts_[i] = INDEX_NONE;
+            }
+        }
+        return false;
+    }
 
-        // 提取并分配输出
-        Outputs.Empty();
-        for (size_t i = 0; i < numOutputs; ++i)
+    // float16 输出从转换缓冲转换到调用方的数组
+    for (int32 i = 0; i < outputSlots_.Num(); ++i)
+    {
+        if (outputSlots_[i].ElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16 && outputSlots_[i].RecurrentPair == INDEX_NONE &&
+            outputElementCounts_[i] != INDEX_NONE && set.Outputs[i].Data == halfOutputs_[i].GetData())
         {
-            FString outputNameStr(UTF8_TO_TCHAR(outputNames[i]));
-            TArray<float> outData;
+            ConvertFromHalf(halfOutputs_[i].GetData(), halfOutputs_[i].Num(), Outputs[i]);
+        }
+    }
 
-            if (outputTensors[i].IsTensor() && ExtractOutputTensorData(outputTensors[i], outData))
+    // 4. 第一次得到动态输出的形状：拷贝一次结果，并记录形状，下一帧起直接写入 Outputs
+    if (bHasUnboundOutput)
+    {
+        std::vector<Ort::Value> outputValues = set.Binding->GetOutputValues();
+        for (int32 i = 0; i < outputSlots_.Num(); ++i)
+        {
+            if (outputSlots_[i].RecurrentPair != INDEX_NONE || outputElementCounts_[i] != INDEX_NONE)
             {
-                // 启发式分配：如果模型的输出节点名字里带有 state/hidden/hx 等字眼，
-                // 认定它是用于下一帧的隐藏状态，直接更新到 HiddenState 中。
-                if (outputNameStr.Contains(TEXT("state"), ESearchCase::IgnoreCase) ||
-                    outputNameStr.Contains(TEXT("hidden"), ESearchCase::IgnoreCase) ||
-                    outputNameStr.Contains(TEXT("hx"), ESearchCase::IgnoreCase))
-                {
-                    HiddenState = outData;
-                }
-                else
-                {
-                    // 普通输出（如预测的顶点位移），放入字典供外部提取
-                    Outputs.Add(outputNameStr, outData);
-                }
+                continue;
             }
-            else
+            if (!ExtractOutputTensorData(outputValues[i], Outputs[i]))
             {
-                UE_LOG(LogTemp, Warning, TEXT("Run: Failed to extract output %s"), *outputNameStr);
+                UE_LOG(LogTemp, Warning, TEXT("RunWithBinding: Failed to extract output %s"), *outputSlots_[i].Name);
+                return false;
             }
+            outputShapes_[i] = outputValues[i].GetTensorTypeAndShapeInfo().GetShape();
+            outputElementCounts_[i] = Outputs[i].Num();
         }
     }
-    catch (const Ort::Exception& e)
+
+    // 本帧写出的状态缓冲成为下一帧的输入，切换到另一套绑定
+    if (recurrentStates_.Num() > 0)
     {
-        UE_LOG(LogTemp, Error, TEXT("Run: ONNX Runtime error: %s"), UTF8_TO_TCHAR(e.what()));
+        stateReadIndex_ = 1 - stateReadIndex_;
     }
+    return true;
+#else
+    UE_LOG(LogTemp, Error, TEXT("RunWithBinding: Model not initialized."));
     return false;
+#endif
 }
 
 bool FOnnxModelInstance::Run(const TArray<float> &InputData, TArray<float> &OutputData)
 {
-    if (!bIsInitialized_ || !session_)
+    CLOTH_DEFORMER_SCOPE(Inference);
+    LLM_SCOPE_BYTAG(ClothDeformer_InstanceBuffers);
+
+    if (!bIsInitialized_)
     {
         UE_LOG(LogTemp, Error, TEXT("Run: Model not initialized."));
         return false;
     }
 
+    if (nativeModel_)
+    {
+        if (inputSlots_.Num() != 1 || outputSlots_.Num() == 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Run: Single-tensor Run needs a model with exactly one input."));
+            return false;
+        }
+        const TConstArrayView<float> inputs[] = {InputData};
+        TArray<TArray<float>, TInlineAllocator<4>> outputs;
+        outputs.SetNum(outputSlots_.Num());
+        if (!RunNative(inputs, outputs, false))
+        {
+            return false;
+        }
+        OutputData = MoveTemp(outputs[0]);
+        return true;
+    }
+
+#if WITH_CLOTH_ORT
     try
     {
-        // 1. 计算输入张量维度
-        std::vector<int64_t> actualInputDims;
+        if (inputSlots_.Num() == 0 || outputSlots_.Num() == 0)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Run: Model has no input or output."));
+            return false;
+        }
 
-        // Warn: 每次重新进行检查, 如果模型确定所有维度都是静态的，并且每次推理的输入数据大小都固定不变, 可以缓存
-        if (!CalculateInputTensorDimensions(InputData.Num(), actualInputDims))
+        // 1. 计算输入张量维度 (形状在构造时已缓存，这里只推算动态维度)
+        if (!ResolveInputShape(0, InputData.Num()))
         {
             return false;
         }
+        const std::vector<int64_t>& actualInputDims = inputShapes_[0];
 
         // 2. 创建 ONNX 输入张量
         Ort::Value inputTensor{nullptr}; // Initialize with nullptr
-        if (!CreateInputTensor(InputData, actualInputDims, inputTensor))
+        if (!CreateInputTensor(0, InputData, actualInputDims, inputTensor))
         {
             return false;
         }
 
-        // 3. 准备节点名称
-        Ort::AllocatorWithDefaultOptions allocator;
-        auto inputNamePtr = session_->GetInputNameAllocated(0, allocator);
-        auto outputNamePtr = session_->GetOutputNameAllocated(0, allocator);
-
-        const char *inputNames[] = {inputNamePtr.get()};
-        const char *outputNames[] = {outputNamePtr.get()};
+        // 3. 节点名称已在构造时缓存
+        const char *inputNames[] = {inputNames_[0]};
+        const char *outputNames[] = {outputNames_[0]};
 
         // 4. 执行推理
         auto outputTensors = session_->Run(
@@ -310,66 +1023,100 @@ bool FOnnxModelInstance::Run(const TArray<float> &InputData, TArray<float> &Outp
     {
         UE_LOG(LogTemp, Error, TEXT("Run: Standard exception: %s"), UTF8_TO_TCHAR(e.what()));
     }
+#endif
 
     return false;
 }
 
-bool FOnnxModelInstance::CalculateInputTensorDimensions(int32 InInputDataSize, std::vector<int64_t> &OutActualDims) const
+bool FOnnxModelInstance::ResolveInputShape(int32 InputSlot, int32 InInputDataSize)
 {
-    OutActualDims.clear();
-    OutActualDims.reserve(inputNodeDims_.Num()); // 预分配内存
-    for (int64 Val : inputNodeDims_)
+    FInputShapeKey& key = inputShapeKeys_[InputSlot];
+    if (key.Num == InInputDataSize && key.Generation == shapeGeneration_)
     {
-        OutActualDims.push_back(Val);
+        return true;
     }
-    int64_t staticElementCount = 1;
-    int dynamicDimIndex = -1; // Warn: 在大多数常见的深度学习模型中，通常只有一个动态维度, 如果需要支持多个动态维度, 需要修改
 
-    // Analyze dimensions
-    for (size_t i = 0; i < OutActualDims.size(); ++i)
+    if (!CalculateInputTensorDimensions(inputSlots_[InputSlot], InInputDataSize, inputShapes_[InputSlot]))
     {
-        if (OutActualDims[i] == -1)
-        {
-            dynamicDimIndex = (int)i;
-        }
-        else
+        key.Num = INDEX_NONE;
+        return false;
+    }
+    key.Num = InInputDataSize;
+    key.Generation = shapeGeneration_;
+    return true;
+}
+
+bool FOnnxModelInstance::CalculateInputTensorDimensions(const FOnnxTensorSlot &InSlot, int32 InInputDataSize, std::vector<int64_t> &OutActualDims) const
+{
+    // 同一槽位每次尺寸相同，assign 不会重新分配
+    OutActualDims.assign(InSlot.Shape.begin(), InSlot.Shape.end());
+
+    // 1. 已绑定的符号维度直接代入，只留下未绑定的动态维度
+    int64_t knownElementCount = 1;
+    int32 unresolvedDim = INDEX_NONE;
+    for (size_t j = 0; j < OutActualDims.size(); ++j)
+    {
+        if (OutActualDims[j] <= 0)
         {
-            staticElementCount *= OutActualDims[i];
+            const int32 symbol = InSlot.DimSymbols[j];
+            if (symbol != INDEX_NONE && dimSymbolValues_[symbol] > 0)
+            {
+                OutActualDims[j] = dimSymbolValues_[symbol];
+            }
+            else if (unresolvedDim == INDEX_NONE)
+            {
+                unresolvedDim = static_cast<int32>(j);
+                continue;
+            }
+            else
+            {
+                UE_LOG(LogTemp, Error, TEXT("CalculateInputTensorDimensions: Input %s has more than one unbound dynamic dimension, bind its symbolic dimensions first."), *InSlot.Name);
+                return false;
+            }
         }
+        knownElementCount *= OutActualDims[j];
     }
 
-    // Infer dynamic dimension if necessary
-    if (dynamicDimIndex != -1)
+    // 2. 剩下的一个动态维度由数据长度推算
+    if (unresolvedDim != INDEX_NONE)
     {
-        if (staticElementCount > 0 && InInputDataSize % staticElementCount == 0)
+        if (knownElementCount > 0 && InInputDataSize % knownElementCount == 0)
         {
-            OutActualDims[dynamicDimIndex] = InInputDataSize / staticElementCount;
+            OutActualDims[unresolvedDim] = InInputDataSize / knownElementCount;
         }
         else
         {
-            UE_LOG(LogTemp, Error, TEXT("CalculateInputTensorDimensions: Input data size %d is incompatible with model static structure (element count: %lld)."), InInputDataSize, staticElementCount);
+            UE_LOG(LogTemp, Error, TEXT("CalculateInputTensorDimensions: Input data size %d is incompatible with model static structure (element count: %lld)."), InInputDataSize, knownElementCount);
             return false;
         }
     }
     else
     {
-        // Strict check for purely static models
-        if (InInputDataSize != staticElementCount)
+        // Strict check for fully resolved shapes
+        if (InInputDataSize != knownElementCount)
         {
-            UE_LOG(LogTemp, Warning, TEXT("CalculateInputTensorDimensions: Input data size %d does not match expected model size %lld."), InInputDataSize, staticElementCount);
+            UE_LOG(LogTemp, Warning, TEXT("CalculateInputTensorDimensions: Input data size %d does not match expected model size %lld."), InInputDataSize, knownElementCount);
             return false;
         }
     }
     return true;
 }
 
-bool FOnnxModelInstance::CreateInputTensor(const TArray<float> &InInputData, const std::vector<int64_t> &InActualDims, Ort::Value &OutInputTensor) const
+#if WITH_CLOTH_ORT
+bool FOnnxModelInstance::CreateInputTensor(int32 InputSlot, TConstArrayView<float> InInputData, const std::vector<int64_t> &InActualDims, Ort::Value &OutInputTensor)
 {
-    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault); // Warn:从 Mesh 获取顶点数据通常是在 CPU 上完成的. 理论上可以将顶点数据存在GPU上进行加速
     try
     {
+        if (inputSlots_[InputSlot].ElementType == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16)
+        {
+            TArray<Ort::Float16_t>& halfData = halfInputs_[InputSlot];
+            ConvertToHalf(InInputData, halfData);
+            OutInputTensor = Ort::Value::CreateTensor<Ort::Float16_t>(memoryInfo_, halfData.GetData(), halfData.Num(), InActualDims.data(), InActualDims.size());
+            return true;
+        }
+
         OutInputTensor = Ort::Value::CreateTensor<float>(
-            memoryInfo,
+            memoryInfo_,
             const_cast<float *>(InInputData.GetData()),
             InInputData.Num(),
             InActualDims.data(),
@@ -396,11 +1143,19 @@ bool FOnnxModelInstance::ExtractOutputTensorData(Ort::Value &InOutputTensor, TAr
         return false;
     }
 
+    const auto tensorInfo = InOutputTensor.GetTensorTypeAndShapeInfo();
+    size_t outputElementCount = tensorInfo.GetElementCount();
+    if (tensorInfo.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16)
+    {
+        ConvertFromHalf(InOutputTensor.GetTensorData<Ort::Float16_t>(), static_cast<int32>(outputElementCount), OutOutputData);
+        return true;
+    }
+
     const float *floatArr = InOutputTensor.GetTensorData<float>();
-    size_t outputElementCount = InOutputTensor.GetTensorTypeAndShapeInfo().GetElementCount();
 
     OutOutputData.SetNumUninitialized(outputElementCount);
-    FMemory::Memcpy(OutOutputData.GetData(), floatArr, outputElementCount * sizeof(float)); // Warn: 当前额外进行了一次拷贝, 理论上可以通过 传入一个预先分配好的 Ort::Value 作为输出
+    FMemory::Memcpy(OutOutputData.GetData(), floatArr, outputElementCount * sizeof(float)); // Warn: 当前额外进行了一次拷贝, 每帧推理请使用 RunWithBinding, 输出直接写入预先分配好的缓冲
 
     return true;
-}
\ No newline at end of file
+}
+#endif
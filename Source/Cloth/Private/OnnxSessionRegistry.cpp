@@ -0,0 +1,501 @@
+#include "OnnxSessionRegistry.h"
+#include "ClothDeformationModelAsset.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include "ClothDeformerSettings.h"
+#include "ClothDeformerStats.h"
+#include "OrtUEAllocator.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/PlatformAffinity.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProperties.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+#if WITH_CLOTH_ORT
+
+namespace
+{
+    // 通过 FRunnableThread 创建的 ORT 工作线程：带 UE 名字、优先级与亲和性，会被 FThreadManager 和 Insights 识别
+    struct FOrtWorkerThreadOptions
+    {
+        EThreadPriority Priority{TPri_BelowNormal};
+        uint64 AffinityMask{0};
+        std::atomic<int32> NextIndex{0};
+    };
+    FOrtWorkerThreadOptions GOrtWorkerThreadOptions;
+
+    // 注册到 Env 的 UE 分配器，与 Env 同生共死 (Env 被有意泄漏时一并泄漏)
+    FOrtUEAllocator* GOrtAllocator = nullptr;
+
+    class FOrtWorkerRunnable : public FRunnable
+    {
+    public:
+        FOrtWorkerRunnable(OrtThreadWorkerFn InWorkerFn, void* InWorkerParam)
+            : WorkerFn(InWorkerFn), WorkerParam(InWorkerParam)
+        {
+        }
+
+        // ORT 提供工作循环，线程池析构时循环返回
+        virtual uint32 Run() override
+        {
+            WorkerFn(WorkerParam);
+            return 0;
+        }
+
+    private:
+        OrtThreadWorkerFn WorkerFn;
+        void* WorkerParam;
+    };
+
+    struct FOrtWorkerThread
+    {
+        TUniquePtr<FOrtWorkerRunnable> Runnable;
+        TUniquePtr<FRunnableThread> Thread;
+    };
+
+    OrtCustomThreadHandle CreateOrtWorkerThread(void* InOptions, OrtThreadWorkerFn InWorkerFn, void* InWorkerParam)
+    {
+        FOrtWorkerThreadOptions& options = *static_cast<FOrtWorkerThreadOptions*>(InOptions);
+        const int32 index = options.NextIndex.fetch_add(1, std::memory_order_relaxed);
+
+        FOrtWorkerThread* worker = new FOrtWorkerThread;
+        worker->Runnable = MakeUnique<FOrtWorkerRunnable>(InWorkerFn, InWorkerParam);
+        worker->Thread.Reset(FRunnableThread::Create(worker->Runnable.Get(), *FString::Printf(TEXT("OnnxWorker_%d"), index), 0, options.Priority, options.AffinityMask));
+        if (!worker->Thread)
+        {
+            // 返回空句柄时 ORT 会抛出异常，会话创建失败
+            delete worker;
+            return nullptr;
+        }
+        return reinterpret_cast<OrtCustomThreadHandle>(worker);
+    }
+
+    void JoinOrtWorkerThread(OrtCustomThreadHandle InHandle)
+    {
+        FOrtWorkerThread* worker = reinterpret_cast<FOrtWorkerThread*>(const_cast<OrtCustomHandleType*>(InHandle));
+        worker->Thread->WaitForCompletion();
+        delete worker;
+    }
+
+    EThreadPriority ToThreadPriority(EClothOrtThreadPriority InPriority)
+    {
+        switch (InPriority)
+        {
+        case EClothOrtThreadPriority::BelowNormal: return TPri_BelowNormal;
+        case EClothOrtThreadPriority::Lowest: return TPri_Lowest;
+        case EClothOrtThreadPriority::AboveNormal: return TPri_AboveNormal;
+        default: return TPri_Normal;
+        }
+    }
+
+    const char* SpinConfigValue(bool bAllowSpinning)
+    {
+        return bAllowSpinning ? "1" : "0";
+    }
+
+    // 输入由持久缓冲提供且形状每帧不变，内存模式按输入形状记录第一次运行的中间张量布局，之后整块预分配。
+    // 并行执行模式下 ORT 会忽略内存模式。Env 注册了共享分配器 (UE 分配器或限额 arena) 时用它代替会话自己的 CPU 内存池
+    void ApplyMemoryOptions(Ort::SessionOptions& OutOptions, bool bUseEnvAllocator)
+    {
+        OutOptions.EnableMemPattern();
+        if (bUseEnvAllocator)
+        {
+            OutOptions.AddConfigEntry("session.use_env_allocators", "1");
+        }
+        else
+        {
+            OutOptions.EnableCpuMemArena();
+        }
+    }
+
+    // FString 路径转换为 ORT 的路径字符类型 (Windows 上是 wchar_t)
+    std::basic_string<ORTCHAR_T> ToOrtPath(const FString& InPath)
+    {
+#ifdef _WIN32
+        return std::basic_string<ORTCHAR_T>(TCHAR_TO_WCHAR(*InPath));
+#else
+        return std::basic_string<ORTCHAR_T>(TCHAR_TO_UTF8(*InPath));
+#endif
+    }
+}
+
+FOnnxSessionRegistry& FOnnxSessionRegistry::Get()
+{
+    static FOnnxSessionRegistry Registry;
+    return Registry;
+}
+
+Ort::Env& FOnnxSessionRegistry::GetEnv()
+{
+    FScopeLock Lock(&Mutex);
+    if (Env)
+    {
+        return *Env;
+    }
+
+    const UClothDeformerSettings* settings = GetDefault<UClothDeformerSettings>();
+    GOrtWorkerThreadOptions.Priority = ToThreadPriority(settings->WorkerThreadPriority);
+    GOrtWorkerThreadOptions.AffinityMask = settings->WorkerThreadAffinityMask != 0 ? static_cast<uint64>(settings->WorkerThreadAffinityMask) : FPlatformAffinity::GetTaskGraphBackgroundTaskMask();
+
+    if (settings->bUseGlobalThreadPools)
+    {
+        Ort::ThreadingOptions threadingOptions;
+        threadingOptions.SetGlobalIntraOpNumThreads(settings->GlobalIntraOpThreads);
+        threadingOptions.SetGlobalInterOpNumThreads(settings->GlobalInterOpThreads);
+        threadingOptions.SetGlobalSpinControl(settings->bGlobalAllowSpinning ? 1 : 0);
+        if (settings->bCreateWorkerThreadsThroughUE)
+        {
+            threadingOptions.SetGlobalCustomCreateThreadFn(&CreateOrtWorkerThread);
+            threadingOptions.SetGlobalCustomThreadCreationOptions(&GOrtWorkerThreadOptions);
+            threadingOptions.SetGlobalCustomJoinThreadFn(&JoinOrtWorkerThread);
+        }
+        Env = MakeUnique<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "Cloth");
+        bEnvHasGlobalThreadPools = true;
+        UE_LOG(LogTemp, Log, TEXT("ONNX Runtime environment created with global thread pools (intra-op %d, inter-op %d, spinning %d)"),
+            settings->GlobalIntraOpThreads, settings->GlobalInterOpThreads, settings->bGlobalAllowSpinning ? 1 : 0);
+    }
+    else
+    {
+        Env = MakeUnique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "Cloth");
+        bEnvHasGlobalThreadPools = false;
+    }
+
+    bEnvHasSharedAllocator = false;
+    bEnvHasCappedArena = false;
+    if (settings->OrtMemoryBudgetMB > 0)
+    {
+        // 限额只能由 ORT 自己的 arena 保证：超出 max_mem 的分配在 ORT 内部以错误返回，会话创建或 Run 抛出 Ort::Exception。
+        // 按请求大小扩展，arena 不会为了翻倍增长而提前越过限额
+        const size_t budgetBytes = static_cast<size_t>(settings->OrtMemoryBudgetMB) * 1024 * 1024;
+        try
+        {
+            const Ort::MemoryInfo arenaInfo("Cpu", OrtArenaAllocator, 0, OrtMemTypeDefault);
+            const Ort::ArenaCfg arenaCfg(budgetBytes, /*arena_extend_strategy kSameAsRequested*/ 1, -1, -1);
+            Env->CreateAndRegisterAllocator(arenaInfo, arenaCfg);
+            bEnvHasSharedAllocator = true;
+            bEnvHasCappedArena = true;
+#if CLOTH_ORT_HAS_ALLOCATOR_STATS
+            UE_LOG(LogTemp, Log, TEXT("ONNX Runtime sessions share a CPU arena capped at %d MB (usage sampled per frame into stat ClothDeformer and LLM ClothDeformer/OrtArena)"), settings->OrtMemoryBudgetMB);
+#else
+            UE_LOG(LogTemp, Warning, TEXT("ONNX Runtime sessions share a CPU arena capped at %d MB; this ONNX Runtime version has no allocator stats, so its usage is not reported"), settings->OrtMemoryBudgetMB);
+#endif
+        }
+        catch (const Ort::Exception& e)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to create the capped ONNX Runtime arena, sessions use their own arena without a limit: %s"), UTF8_TO_TCHAR(e.what()));
+        }
+    }
+    else if (settings->bRouteOrtAllocationsThroughUE)
+    {
+        GOrtAllocator = new FOrtUEAllocator();
+        try
+        {
+            Env->RegisterAllocator(GOrtAllocator);
+            bEnvHasSharedAllocator = true;
+            UE_LOG(LogTemp, Log, TEXT("ONNX Runtime CPU allocations routed through FMemory"));
+        }
+        catch (const Ort::Exception& e)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to register the UE allocator with ONNX Runtime, sessions use their own arena: %s"), UTF8_TO_TCHAR(e.what()));
+            delete GOrtAllocator;
+            GOrtAllocator = nullptr;
+        }
+    }
+    return *Env;
+}
+
+TSharedPtr<FOnnxSharedSession, ESPMode::ThreadSafe> FOnnxSessionRegistry::Acquire(const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision)
+{
+    if (!InModelAsset || InModelAsset->GetModelData(InPrecision).Num() == 0)
+    {
+        return nullptr;
+    }
+
+    const TArray<uint8>& modelData = InModelAsset->GetModelData(InPrecision);
+    const uint32 modelDataCrc = FCrc::MemCrc32(modelData.GetData(), modelData.Num());
+    Ort::Env& env = GetEnv();
+
+    FScopeLock Lock(&Mutex);
+
+    // 清理已经没有持有者的条目
+    for (auto It = Sessions.CreateIterator(); It; ++It)
+    {
+        if (!It.Value().IsValid())
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    const TPair<TObjectKey<UClothDeformationModelAsset>, EClothModelPrecision> key(InModelAsset, InPrecision);
+    if (TWeakPtr<FOnnxSharedSession, ESPMode::ThreadSafe>* existing = Sessions.Find(key))
+    {
+        TSharedPtr<FOnnxSharedSession, ESPMode::ThreadSafe> shared = existing->Pin();
+        if (shared && shared->ModelDataCrc == modelDataCrc)
+        {
+            return shared;
+        }
+    }
+
+    try
+    {
+        UE_LOG(LogTemp, Log, TEXT("Creating shared ONNX Session for %s (%s) from memory (%d bytes)..."), *InModelAsset->GetName(),
+            *StaticEnum<EClothModelPrecision>()->GetNameStringByValue(static_cast<int64>(InPrecision)), modelData.Num());
+
+        const double startSeconds = FPlatformTime::Seconds();
+        TSharedPtr<FOnnxSharedSession, ESPMode::ThreadSafe> shared = MakeShared<FOnnxSharedSession, ESPMode::ThreadSafe>();
+        shared->Session = CreateSession(env, InModelAsset, InPrecision, modelDataCrc, shared->bLoadedFromOptimizedCache);
+        shared->ModelDataCrc = modelDataCrc;
+        shared->CreationSeconds = FPlatformTime::Seconds() - startSeconds;
+#if CLOTH_ORT_HAS_ALLOCATOR_STATS
+        // 会话以 use_env_allocators 使用 Env 的限额 arena，经它取得的分配器句柄即指向该 arena，会话销毁后仍然有效
+        if (bEnvHasCappedArena && !ArenaAllocator)
+        {
+            const Ort::MemoryInfo arenaInfo("Cpu", OrtArenaAllocator, 0, OrtMemTypeDefault);
+            ArenaAllocator = MakeUnique<Ort::Allocator>(*shared->Session, arenaInfo);
+        }
+#endif
+        UE_LOG(LogTemp, Log, TEXT("Shared ONNX Session for %s created in %.2f ms (%s)"), *InModelAsset->GetName(), shared->CreationSeconds * 1000.0,
+            shared->bLoadedFromOptimizedCache ? TEXT("optimized model cache") : TEXT("raw model"));
+
+        // 旧会话 (资产重新导入前的) 仍由已有实例持有，这里只替换条目
+        Sessions.Add(key, shared);
+        return shared;
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ONNX Runtime error creating shared session: %s"), UTF8_TO_TCHAR(e.what()));
+    }
+    catch (const std::exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Standard exception creating shared session: %s"), UTF8_TO_TCHAR(e.what()));
+    }
+    return nullptr;
+}
+
+FString FOnnxSessionRegistry::GetOptimizedModelCachePath(const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision, uint32 ModelDataCrc)
+{
+    const FString fileName = FString::Printf(TEXT("%s_%s_%08X_%s_ort%s.ort"),
+        *InModelAsset->GetName(), *StaticEnum<EClothModelPrecision>()->GetNameStringByValue(static_cast<int64>(InPrecision)), ModelDataCrc, ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()), UTF8_TO_TCHAR(Ort::GetVersionString().c_str()));
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("ClothDeformer"), TEXT("OptimizedModels"), fileName);
+}
+
+bool FOnnxSessionRegistry::WarmOptimizedModelCache(const UClothDeformationModelAsset* InModelAsset)
+{
+    if (!InModelAsset || InModelAsset->modelData_.Num() == 0 || !GetDefault<UClothDeformerSettings>()->bCacheOptimizedModels)
+    {
+        return false;
+    }
+
+    const EClothModelPrecision precision = InModelAsset->GetRuntimePrecision();
+    const TArray<uint8>& modelData = InModelAsset->GetModelData(precision);
+    const uint32 modelDataCrc = FCrc::MemCrc32(modelData.GetData(), modelData.Num());
+    if (IFileManager::Get().FileExists(*GetOptimizedModelCachePath(InModelAsset, precision, modelDataCrc)))
+    {
+        return true;
+    }
+
+    try
+    {
+        bool bFromCache = false;
+        TUniquePtr<Ort::Session> session = CreateSession(GetEnv(), InModelAsset, precision, modelDataCrc, bFromCache);
+        return session.IsValid() && IFileManager::Get().FileExists(*GetOptimizedModelCachePath(InModelAsset, precision, modelDataCrc));
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ONNX Runtime error warming optimized model cache: %s"), UTF8_TO_TCHAR(e.what()));
+    }
+    return false;
+}
+
+TUniquePtr<Ort::Session> FOnnxSessionRegistry::CreateSession(Ort::Env& InEnv, const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision, uint32 ModelDataCrc, bool& bOutFromCache) const
+{
+    // 权重与初始化期间的分配 (包括经 UE 分配器的 ORT 分配) 计入会话
+    LLM_SCOPE_BYTAG(ClothDeformer_Sessions);
+    FOrtUEAllocator::FSessionCreationScope sessionCreationScope;
+
+    bOutFromCache = false;
+    const TArray<uint8>& modelData = InModelAsset->GetModelData(InPrecision);
+    if (!GetDefault<UClothDeformerSettings>()->bCacheOptimizedModels)
+    {
+        Ort::SessionOptions sessionOptions;
+        ApplyThreadingOptions(sessionOptions, InModelAsset);
+        ApplyMemoryOptions(sessionOptions, bEnvHasSharedAllocator);
+        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_BASIC);
+        return MakeUnique<Ort::Session>(InEnv, modelData.GetData(), modelData.Num(), sessionOptions);
+    }
+
+    // 1. 缓存命中：ORT 格式的模型已经过优化，加载时关闭图优化
+    const FString cachePath = GetOptimizedModelCachePath(InModelAsset, InPrecision, ModelDataCrc);
+    TArray<uint8> cachedModel;
+    if (FFileHelper::LoadFileToArray(cachedModel, *cachePath, FILEREAD_Silent))
+    {
+        try
+        {
+            Ort::SessionOptions sessionOptions;
+            ApplyThreadingOptions(sessionOptions, InModelAsset);
+            ApplyMemoryOptions(sessionOptions, bEnvHasSharedAllocator);
+            sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            sessionOptions.AddConfigEntry("session.load_model_format", "ORT");
+            TUniquePtr<Ort::Session> session = MakeUnique<Ort::Session>(InEnv, cachedModel.GetData(), cachedModel.Num(), sessionOptions);
+            bOutFromCache = true;
+            return session;
+        }
+        catch (const Ort::Exception& e)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Optimized model cache %s is unusable (%s), rebuilding."), *cachePath, UTF8_TO_TCHAR(e.what()));
+            IFileManager::Get().Delete(*cachePath, false, true, true);
+        }
+    }
+
+    // 2. 缓存缺失：以 ORT_ENABLE_ALL 优化原始模型，并让 ORT 把结果写入临时文件，完整写出后再改名，避免留下半个缓存
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(cachePath), true);
+    const FString tempPath = cachePath + TEXT(".tmp");
+    const std::basic_string<ORTCHAR_T> ortTempPath = ToOrtPath(tempPath);
+
+    Ort::SessionOptions sessionOptions;
+    ApplyThreadingOptions(sessionOptions, InModelAsset);
+    ApplyMemoryOptions(sessionOptions, bEnvHasSharedAllocator);
+    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    sessionOptions.SetOptimizedModelFilePath(ortTempPath.c_str());
+    sessionOptions.AddConfigEntry("session.save_model_format", "ORT");
+    TUniquePtr<Ort::Session> session = MakeUnique<Ort::Session>(InEnv, modelData.GetData(), modelData.Num(), sessionOptions);
+
+    if (IFileManager::Get().Move(*cachePath, *tempPath, true, true, false, true))
+    {
+        UE_LOG(LogTemp, Log, TEXT("Wrote optimized model cache %s"), *cachePath);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to write optimized model cache %s"), *cachePath);
+        IFileManager::Get().Delete(*tempPath, false, true, true);
+    }
+    return session;
+}
+
+void FOnnxSessionRegistry::ApplyThreadingOptions(Ort::SessionOptions& OutOptions, const UClothDeformationModelAsset* InModelAsset) const
+{
+    if (bEnvHasGlobalThreadPools)
+    {
+        // 使用 Env 的全局线程池，会话不再创建自己的线程
+        OutOptions.DisablePerSessionThreads();
+        const UClothDeformerSettings* settings = GetDefault<UClothDeformerSettings>();
+        OutOptions.SetExecutionMode(settings->GlobalInterOpThreads > 1 ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+        return;
+    }
+
+    const UClothDeformerSettings* settings = GetDefault<UClothDeformerSettings>();
+    int32 intraOpThreads = settings->DefaultIntraOpThreads;
+    int32 interOpThreads = settings->DefaultInterOpThreads;
+    bool bAllowSpinning = settings->bDefaultAllowSpinning;
+    if (InModelAsset && InModelAsset->threadingOverrides_.bOverride)
+    {
+        intraOpThreads = InModelAsset->threadingOverrides_.IntraOpThreads;
+        interOpThreads = InModelAsset->threadingOverrides_.InterOpThreads;
+        bAllowSpinning = InModelAsset->threadingOverrides_.bAllowSpinning;
+    }
+
+    OutOptions.SetIntraOpNumThreads(intraOpThreads);
+    OutOptions.SetInterOpNumThreads(interOpThreads);
+    OutOptions.SetExecutionMode(interOpThreads > 1 ? ExecutionMode::ORT_PARALLEL : ExecutionMode::ORT_SEQUENTIAL);
+    OutOptions.AddConfigEntry("session.intra_op.allow_spinning", SpinConfigValue(bAllowSpinning));
+    OutOptions.AddConfigEntry("session.inter_op.allow_spinning", SpinConfigValue(bAllowSpinning));
+    if (settings->bCreateWorkerThreadsThroughUE)
+    {
+        OutOptions.SetCustomCreateThreadFn(&CreateOrtWorkerThread);
+        OutOptions.SetCustomThreadCreationOptions(&GOrtWorkerThreadOptions);
+        OutOptions.SetCustomJoinThreadFn(&JoinOrtWorkerThread);
+    }
+}
+
+int32 FOnnxSessionRegistry::GetNumLiveSessions() const
+{
+    FScopeLock Lock(&Mutex);
+    int32 numLive = 0;
+    for (const auto& pair : Sessions)
+    {
+        numLive += pair.Value.IsValid() ? 1 : 0;
+    }
+    return numLive;
+}
+
+void FOnnxSessionRegistry::PublishArenaUsage()
+{
+#if CLOTH_ORT_HAS_ALLOCATOR_STATS
+    FScopeLock Lock(&Mutex);
+    if (!ArenaAllocator)
+    {
+        return;
+    }
+
+    int64 totalAllocated = ReportedArenaBytes;
+    try
+    {
+        // BFC arena 的统计：TotalAllocated 为 arena 向系统申请的字节数 (即 arena 的增长)，InUse 为其中正在使用的部分
+        Ort::KeyValuePairs stats = ArenaAllocator->GetStats();
+        if (const char* value = stats.GetValue("TotalAllocated"))
+        {
+            totalAllocated = FCStringAnsi::Atoi64(value);
+        }
+    }
+    catch (const Ort::Exception& e)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Failed to read ONNX Runtime arena stats: %s"), UTF8_TO_TCHAR(e.what()));
+        ArenaAllocator.Reset();
+        return;
+    }
+
+    const int64 delta = totalAllocated - ReportedArenaBytes;
+    if (delta != 0)
+    {
+        SET_MEMORY_STAT(STAT_ClothDeformer_OrtAllocated, totalAllocated);
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        FLowLevelMemTracker::Get().OnLowLevelChangeInMemoryUse(ELLMTracker::Default, delta, LLM_TAG_NAME(ClothDeformer_OrtArena));
+#endif
+        ReportedArenaBytes = totalAllocated;
+    }
+#endif
+}
+
+void FOnnxSessionRegistry::Shutdown()
+{
+    const int32 numLive = GetNumLiveSessions();
+
+    FScopeLock Lock(&Mutex);
+    Sessions.Empty();
+
+    // 会话依赖 Env，仍有会话存活时有意泄漏 Env (进程退出时由系统回收)，避免静态析构时先于会话销毁
+    if (numLive > 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FOnnxSessionRegistry::Shutdown: %d sessions still alive, leaking the ONNX Runtime environment"), numLive);
+        (void)Env.Release();
+        return;
+    }
+
+    // 撤回报告给 stat 与 LLM 的 arena 用量，arena 随 Env 释放
+#if CLOTH_ORT_HAS_ALLOCATOR_STATS
+    ArenaAllocator.Reset();
+    if (ReportedArenaBytes != 0)
+    {
+        SET_MEMORY_STAT(STAT_ClothDeformer_OrtAllocated, 0);
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+        FLowLevelMemTracker::Get().OnLowLevelChangeInMemoryUse(ELLMTracker::Default, -ReportedArenaBytes, LLM_TAG_NAME(ClothDeformer_OrtArena));
+#endif
+        ReportedArenaBytes = 0;
+    }
+#endif
+    Env.Reset();
+
+    if (GOrtAllocator)
+    {
+        UE_LOG(LogTemp, Log, TEXT("ONNX Runtime UE allocator peak usage: %.2f MB"), GOrtAllocator->GetPeakBytes() / (1024.0 * 1024.0));
+        delete GOrtAllocator;
+        GOrtAllocator = nullptr;
+    }
+    bEnvHasSharedAllocator = false;
+    bEnvHasCappedArena = false;
+}
+
+#endif // WITH_CLOTH_ORT
@@ -0,0 +1,93 @@
+#include "OrtUEAllocator.h"
+#include "ClothDeformerStats.h"
+
+#if WITH_CLOTH_ORT
+
+namespace
+{
+    thread_local int32 GSessionCreationDepth = 0;
+    // ORT 的 intra-op 线程池在工作线程上分配，按线程计数会漏掉这部分，因此用进程级计数
+    std::atomic<uint64> GAllocationCount{0};
+}
+
+uint64 FOrtUEAllocator::GetAllocationCount()
+{
+    return GAllocationCount.load(std::memory_order_relaxed);
+}
+
+FOrtUEAllocator::FSessionCreationScope::FSessionCreationScope()
+{
+    ++GSessionCreationDepth;
+}
+
+FOrtUEAllocator::FSessionCreationScope::~FSessionCreationScope()
+{
+    --GSessionCreationDepth;
+}
+
+FOrtUEAllocator::FOrtUEAllocator()
+    // 注册到 Env 的分配器必须声明为 OrtDeviceAllocator
+    : MemoryInfo("Cpu", OrtDeviceAllocator, 0, OrtMemTypeDefault)
+{
+    version = ORT_API_VERSION;
+    Alloc = &AllocImpl;
+    Free = &FreeImpl;
+    Info = &InfoImpl;
+    Reserve = &AllocImpl;
+}
+
+void* FOrtUEAllocator::Allocate(size_t Size)
+{
+    const uint64 allocated = AllocatedBytes.fetch_add(Size, std::memory_order_relaxed) + Size;
+    uint64 peak = PeakBytes.load(std::memory_order_relaxed);
+    while (allocated > peak && !PeakBytes.compare_exchange_weak(peak, allocated, std::memory_order_relaxed))
+    {
+    }
+
+    uint8* block = nullptr;
+    if (GSessionCreationDepth > 0)
+    {
+        LLM_SCOPE_BYTAG(ClothDeformer_Sessions);
+        block = static_cast<uint8*>(FMemory::Malloc(Size + Alignment, Alignment));
+    }
+    else
+    {
+        LLM_SCOPE_BYTAG(ClothDeformer_OrtArena);
+        block = static_cast<uint8*>(FMemory::Malloc(Size + Alignment, Alignment));
+    }
+    *reinterpret_cast<uint64*>(block) = Size;
+    GAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    INC_MEMORY_STAT_BY(STAT_ClothDeformer_OrtAllocated, Size);
+    return block + Alignment;
+}
+
+void FOrtUEAllocator::Release(void* Ptr)
+{
+    if (!Ptr)
+    {
+        return;
+    }
+
+    uint8* block = static_cast<uint8*>(Ptr) - Alignment;
+    const uint64 size = *reinterpret_cast<const uint64*>(block);
+    AllocatedBytes.fetch_sub(size, std::memory_order_relaxed);
+    DEC_MEMORY_STAT_BY(STAT_ClothDeformer_OrtAllocated, size);
+    FMemory::Free(block);
+}
+
+void* ORT_API_CALL FOrtUEAllocator::AllocImpl(OrtAllocator* This, size_t Size)
+{
+    return static_cast<FOrtUEAllocator*>(This)->Allocate(Size);
+}
+
+void ORT_API_CALL FOrtUEAllocator::FreeImpl(OrtAllocator* This, void* Ptr)
+{
+    static_cast<FOrtUEAllocator*>(This)->Release(Ptr);
+}
+
+const OrtMemoryInfo* ORT_API_CALL FOrtUEAllocator::InfoImpl(const OrtAllocator* This)
+{
+    return static_cast<const FOrtUEAllocator*>(This)->MemoryInfo;
+}
+
+#endif // WITH_CLOTH_ORT
@@ -0,0 +1,62 @@
+// OrtUEAllocator.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include "onnxruntime_cxx_api.h"
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+#include <atomic>
+
+#if WITH_CLOTH_ORT
+
+/**
+ * FOrtUEAllocator
+ * 注册到 Ort::Env 的 CPU 分配器，会话以 session.use_env_allocators 使用它代替自己的 arena。
+ * 内存来自 FMemory，因此出现在 LLM 与 Memory Insights 中：会话创建期间的分配 (权重、初始化) 计入 ClothDeformer/Sessions，
+ * 其余 (推理中的中间结果与内存模式块) 计入 ClothDeformer/OrtArena。
+ * 它不设上限，也从不返回空指针 (ORT 没有把自定义分配器返回空指针定义为可恢复的失败)；
+ * 需要限制 ORT 内存时改用 ORT 自己的 arena 与 OrtArenaCfg 的 max_mem (见 FOnnxSessionRegistry::GetEnv)，其用量由 PublishArenaUsage 每帧采样
+ */
+class FOrtUEAllocator : public OrtAllocator
+{
+public:
+    FOrtUEAllocator();
+
+    // 当前与峰值分配字节数 (不含对齐头)
+    uint64 GetAllocatedBytes() const { return AllocatedBytes.load(std::memory_order_relaxed); }
+    uint64 GetPeakBytes() const { return PeakBytes.load(std::memory_order_relaxed); }
+
+    // 进程内经此分配器累计的分配次数 (含 intra-op 线程池中的分配)，推理前后各取一次即得到这次 Run 中 ORT 实际的堆分配
+    static uint64 GetAllocationCount();
+
+    // 作用域内本线程的分配计入 ClothDeformer/Sessions
+    struct FSessionCreationScope
+    {
+        FSessionCreationScope();
+        ~FSessionCreationScope();
+    };
+
+private:
+    void* Allocate(size_t Size);
+    void Release(void* Ptr);
+
+    static void* ORT_API_CALL AllocImpl(OrtAllocator* This, size_t Size);
+    static void ORT_API_CALL FreeImpl(OrtAllocator* This, void* Ptr);
+    static const OrtMemoryInfo* ORT_API_CALL InfoImpl(const OrtAllocator* This);
+
+    // 返回地址按 64 字节对齐，字节数记录在其前方的对齐头中，释放时据此扣减
+    static constexpr SIZE_T Alignment = 64;
+
+    Ort::MemoryInfo MemoryInfo;
+    std::atomic<uint64> AllocatedBytes{0};
+    std::atomic<uint64> PeakBytes{0};
+};
+
+#endif // WITH_CLOTH_ORT
@@ -1,6 +1,7 @@
 #include "SnugInputAdapter.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Engine/SkeletalMesh.h"
+#include "ClothDeformerStats.h"
 
 // 构造函数：硬编码 SMPL 标准骨骼层级顺序
 // 警告：这个列表必须和训练模型时使用的 SMPL 定义完全一致！
@@ -34,6 +35,16 @@ FSnugInputAdapter::FSnugInputAdapter()
     };
     // 注意：请根据您的具体骨骼资产修改上述字符串名称！
     // 比如 Mixamo 骨骼可能叫 "Hips" 而不是 "Pelvis"
+
+    InputNames.SetNum(NumInputSlots);
+    InputNames[PoseSlot] = TEXT("pose");
+    InputNames[BetasSlot] = TEXT("betas");
+    InputNames[TransSlot] = TEXT("trans");
+
+    for (int32 i = 0; i < 10; i++)
+    {
+        BetaCurveNames.Add(*FString::Printf(TEXT("Shape_%03d"), i));
+    }
 }
 
 void FSnugInputAdapter::Initialize(USkeletalMeshComponent* InSkelMeshComp)
@@ -71,10 +82,49 @@ TMap<FString, TArray<float>> FSnugInputAdapter::ExtractInputs(float DeltaTime)
 {
     TMap<FString, TArray<float>> Inputs;
 
-    if (!SkelComp.IsValid()) return Inputs;
+    TArray<TArray<float>, TInlineAllocator<NumInputSlots>> SlotData;
+    SlotData.SetNum(NumInputSlots);
+    if (!ExtractInputs(DeltaTime, SlotData)) return Inputs;
+
+    for (int32 i = 0; i < NumInputSlots; i++)
+    {
+        Inputs.Add(InputNames[i], MoveTemp(SlotData[i]));
+    }
+    return Inputs;
+}
+
+bool FSnugInputAdapter::ExtractInputs(float DeltaTime, TArrayView<TArray<float>> OutInputs)
+{
+    if (OutInputs.Num() != NumInputSlots) return false;
+
+    TArray<TArrayView<float>, TInlineAllocator<NumInputSlots>> Views;
+    for (int32 i = 0; i < NumInputSlots; i++)
+    {
+        OutInputs[i].SetNumZeroed(InputSizes[i], EAllowShrinking::No);
+        Views.Add(OutInputs[i]);
+    }
+    return WriteInputs(DeltaTime, Views);
+}
+
+bool FSnugInputAdapter::WriteInputs(float DeltaTime, TConstArrayView<TArrayView<float>> OutInputs)
+{
+    CLOTH_DEFORMER_SCOPE(InputExtraction);
+
+    if (OutInputs.Num() != NumInputSlots) return false;
+
+    for (int32 i = 0; i < NumInputSlots; i++)
+    {
+        if (OutInputs[i].Num() != 0 && OutInputs[i].Num() != InputSizes[i])
+        {
+            UE_LOG(LogTemp, Error, TEXT("FSnugInputAdapter: Input %s buffer has %d elements, expected %d."), *InputNames[i], OutInputs[i].Num(), InputSizes[i]);
+            return false;
+        }
+    }
+
+    if (!SkelComp.IsValid()) return false;
 
     USkeletalMesh* MeshAsset = SkelComp->GetSkeletalMeshAsset();
-    if (!MeshAsset) return Inputs; // 安全检查
+    if (!MeshAsset) return false; // 安全检查
 
     // 资源中获取 Reference Skeleton 
     const FReferenceSkeleton& RefSkeleton = MeshAsset->GetRefSkeleton();
@@ -83,10 +133,9 @@ TMap<FString, TArray<float>> FSnugInputAdapter::ExtractInputs(float DeltaTime)
     // -------------------------------------------------------------------------
     // 1. 提取 Pose (72 floats = 24 bones * 3 axis-angle)
     // -------------------------------------------------------------------------
-    TArray<float>& PoseData = Inputs.Add("pose");
-    PoseData.SetNumUninitialized(72); // 24 * 3
+    const TArrayView<float> PoseData = OutInputs[PoseSlot];
 
-    for (int32 i = 0; i < CachedBoneIndices.Num(); i++)
+    for (int32 i = 0; i < CachedBoneIndices.Num() && !PoseData.IsEmpty(); i++)
     {
         int32 BoneIndex = CachedBoneIndices[i];
         float* OutputPtr = &PoseData[i * 3];
@@ -136,15 +185,13 @@ TMap<FString, TArray<float>> FSnugInputAdapter::ExtractInputs(float DeltaTime)
     // -------------------------------------------------------------------------
     // 2. 提取 Betas (10 floats) - 体型参数
     // -------------------------------------------------------------------------
-    TArray<float>& BetasData = Inputs.Add("betas");
-    BetasData.SetNumZeroed(10); // 初始化为 0 (标准身材)
+    const TArrayView<float> BetasData = OutInputs[BetasSlot];
 
-    // 从 Morph Targets 或 Curves 读取 Betas
+    // 从 Morph Targets 或 Curves 读取 Betas，曲线不存在时为 0 (标准身材)
     // 假设您的骨骼上有名为 "Shape_000", "Shape_001" 等的曲线
-     for (int32 i = 0; i < 10; i++)
+     for (int32 i = 0; i < BetasData.Num(); i++)
      {
-         FName CurveName = *FString::Printf(TEXT("Shape_%03d"), i);
-         BetasData[i] = SkelComp->GetMorphTarget(CurveName); 
+         BetasData[i] = SkelComp->GetMorphTarget(BetaCurveNames[i]); 
      }
 
     // -------------------------------------------------------------------------
@@ -152,18 +199,19 @@ TMap<FString, TArray<float>> FSnugInputAdapter::ExtractInputs(float DeltaTime)
     // -------------------------------------------------------------------------
     // 许多 SnUG 变体需要根骨骼的 global translation 或者是 velocity
     
-    TArray<float>& TransData = Inputs.Add("trans");
-    TransData.SetNum(3);
-
-    FVector CurrentRootLoc = SkelComp->GetComponentLocation(); // 或者 GetBoneLocation(Root)
+    const TArrayView<float> TransData = OutInputs[TransSlot];
+    if (!TransData.IsEmpty())
+    {
+        FVector CurrentRootLoc = SkelComp->GetComponentLocation(); // 或者 GetBoneLocation(Root)
 
-    // 这里简单的填入相对位置，具体取决于模型训练时是否 normalized
-    // 注意坐标系转换: UE(X,Y,Z) -> Python(X,Z,Y) or similar
-    TransData[0] = CurrentRootLoc.X;
-    TransData[1] = CurrentRootLoc.Z; // Swap Y/Z for typical conversion
-    TransData[2] = CurrentRootLoc.Y;
+        // 这里简单的填入相对位置，具体取决于模型训练时是否 normalized
+        // 注意坐标系转换: UE(X,Y,Z) -> Python(X,Z,Y) or similar
+        TransData[0] = CurrentRootLoc.X;
+        TransData[1] = CurrentRootLoc.Z; // Swap Y/Z for typical conversion
+        TransData[2] = CurrentRootLoc.Y;
+    }
     
-    return Inputs;
+    return true;
 }
 
 /// @brief 需详细考察
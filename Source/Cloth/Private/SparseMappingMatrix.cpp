@@ -1,13 +1,271 @@
 #include "SparseMappingMatrix.h"
+#include "ClothDeformerStats.h"
+#include "Math/VectorRegister.h"
+#include "Async/ParallelFor.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+namespace
+{
+    // 读取第 Col 个低模顶点的 float3
+    // 除最后一个顶点外都直接做 4 宽非对齐加载, 多读出的 W 分量在写回时被丢弃, 避免逐分量组装寄存器
+    FORCEINLINE VectorRegister4Float LoadLowResOffset(const float* InData, int32 Col, int32 LastCol)
+    {
+        const float* Ptr = InData + Col * 3;
+        return Col < LastCol ? VectorLoad(Ptr) : VectorLoadFloat3(Ptr);
+    }
+
+    // 量化权重的反量化系数，浮点权重为 1
+    template <typename TWeight> constexpr float WeightDequantScale = 1.0f;
+    template <> constexpr float WeightDequantScale<uint16> = 1.0f / 65535.0f;
+    template <> constexpr float WeightDequantScale<uint8> = 1.0f / 255.0f;
+
+    struct FMappingKernelArgs
+    {
+        const float* InLowResOffsets;
+        FVector3f* OutHighResOffsets;
+        int32 LastCol;
+        const int32* RowPtr;
+        int32 FixedRowWidth;
+        const void* ColIndice;
+        const void* Value;
+    };
+
+    // 按存储格式填入列索引/权重数组，并以对应的元素类型标签调用 Func(TIndex{}, TWeight{})
+    template <typename TFunc>
+    void VisitStorage(const FSparseMappingMatrix& Matrix, FMappingKernelArgs& Args, TFunc&& Func)
+    {
+        Args.LastCol = Matrix.NumCol - 1;
+        Args.RowPtr = Matrix.RowPtr.GetData();
+        Args.FixedRowWidth = Matrix.FixedRowWidth;
+
+        switch (Matrix.StorageMode)
+        {
+        case EMappingStorageMode::Compact16:
+            Args.ColIndice = Matrix.CompactColIndice.GetData();
+            Args.Value = Matrix.CompactValue16.GetData();
+            Func(uint16{}, uint16{});
+            break;
+        case EMappingStorageMode::Compact8:
+            Args.ColIndice = Matrix.CompactColIndice.GetData();
+            Args.Value = Matrix.CompactValue8.GetData();
+            Func(uint16{}, uint8{});
+            break;
+        default:
+            Args.ColIndice = Matrix.ColIndice.GetData();
+            Args.Value = Matrix.Value.GetData();
+            Func(int32{}, float{});
+            break;
+        }
+    }
+
+    /**
+     * 映射内核
+     * K > 0: 定宽行，K 为编译期常量，内层循环被完全展开，没有 RowPtr 间接寻址
+     * K == 0: 通用 CSR
+     * 量化权重以整数值直接累加，整行只在写回前乘一次反量化系数
+     */
+    template <int32 K, typename TIndex, typename TWeight>
+    void ApplyMappingRowsKernel(const FMappingKernelArgs& Args, int32 RowBegin, int32 RowEnd)
+    {
+        const TIndex* colIndice = static_cast<const TIndex*>(Args.ColIndice);
+        const TWeight* value = static_cast<const TWeight*>(Args.Value);
+
+        for (int32 row = RowBegin; row < RowEnd; ++row)
+        {
+            int32 startIdx;
+            int32 endIdx;
+            if constexpr (K > 0)
+            {
+                startIdx = row * K;
+                endIdx = startIdx + K;
+            }
+            else
+            {
+                startIdx = Args.RowPtr[row];
+                endIdx = Args.RowPtr[row + 1];
+            }
+
+            VectorRegister4Float accumulated = VectorZeroFloat();
+            for (int32 i = startIdx; i < endIdx; ++i)
+            {
+                accumulated = VectorMultiplyAdd(LoadLowResOffset(Args.InLowResOffsets, colIndice[i], Args.LastCol), VectorSetFloat1(static_cast<float>(value[i])), accumulated);
+            }
+
+            if constexpr (!std::is_same_v<TWeight, float>)
+            {
+                accumulated = VectorMultiply(accumulated, VectorSetFloat1(WeightDequantScale<TWeight>));
+            }
+
+            VectorStoreFloat3(accumulated, &Args.OutHighResOffsets[row].X);
+        }
+    }
+
+    using FMappingKernel = void (*)(const FMappingKernelArgs&, int32, int32);
+
+    template <typename TIndex, typename TWeight>
+    FMappingKernel SelectMappingKernel(int32 FixedRowWidth)
+    {
+        static_assert(FSparseMappingMatrix::MaxFixedRowWidth == 8, "Update the specialized kernel list");
+        switch (FixedRowWidth)
+        {
+        case 1: return &ApplyMappingRowsKernel<1, TIndex, TWeight>;
+        case 2: return &ApplyMappingRowsKernel<2, TIndex, TWeight>;
+        case 3: return &ApplyMappingRowsKernel<3, TIndex, TWeight>;
+        case 4: return &ApplyMappingRowsKernel<4, TIndex, TWeight>;
+        case 5: return &ApplyMappingRowsKernel<5, TIndex, TWeight>;
+        case 6: return &ApplyMappingRowsKernel<6, TIndex, TWeight>;
+        case 7: return &ApplyMappingRowsKernel<7, TIndex, TWeight>;
+        case 8: return &ApplyMappingRowsKernel<8, TIndex, TWeight>;
+        default: return &ApplyMappingRowsKernel<0, TIndex, TWeight>;
+        }
+    }
+
+    // 批量映射时一组同时累加的实例数，4 组累加器加上加载寄存器不会溢出 16 个向量寄存器
+    constexpr int32 MappingBatchGroupSize = 4;
+
+    // 实例多于一组时按行分块，每块的矩阵数据 (256 行，定宽压缩存储约几 KB) 在各组实例间复用时仍留在 L1/L2 中
+    constexpr int32 MappingBatchTileRows = 256;
+
+    /**
+     * 批量映射内核：N 个实例共享同一个映射矩阵
+     * 每个非零元的列索引和权重只读取一次，在 N 个实例的累加器之间复用
+     */
+    template <typename TIndex, typename TWeight, int32 N>
+    void ApplyMappingRowsBatchKernel(const FMappingKernelArgs& Args, const float* const* InLowResOffsets, FVector3f* const* OutHighResOffsets, int32 RowBegin, int32 RowEnd)
+    {
+        const TIndex* colIndice = static_cast<const TIndex*>(Args.ColIndice);
+        const TWeight* value = static_cast<const TWeight*>(Args.Value);
+
+        for (int32 row = RowBegin; row < RowEnd; ++row)
+        {
+            const int32 startIdx = Args.FixedRowWidth > 0 ? row * Args.FixedRowWidth : Args.RowPtr[row];
+            const int32 endIdx = Args.FixedRowWidth > 0 ? startIdx + Args.FixedRowWidth : Args.RowPtr[row + 1];
+
+            VectorRegister4Float accumulated[N];
+            for (int32 j = 0; j < N; ++j)
+            {
+                accumulated[j] = VectorZeroFloat();
+            }
+
+            for (int32 i = startIdx; i < endIdx; ++i)
+            {
+                const int32 col = static_cast<int32>(colIndice[i]);
+                const VectorRegister4Float weight = VectorSetFloat1(static_cast<float>(value[i]));
+                for (int32 j = 0; j < N; ++j)
+                {
+                    accumulated[j] = VectorMultiplyAdd(LoadLowResOffset(InLowResOffsets[j], col, Args.LastCol), weight, accumulated[j]);
+                }
+            }
+
+            for (int32 j = 0; j < N; ++j)
+            {
+                if constexpr (!std::is_same_v<TWeight, float>)
+                {
+                    accumulated[j] = VectorMultiply(accumulated[j], VectorSetFloat1(WeightDequantScale<TWeight>));
+                }
+                VectorStoreFloat3(accumulated[j], &OutHighResOffsets[j][row].X);
+            }
+        }
+    }
+
+    /**
+     * 批量映射：行区间按 MappingBatchTileRows 分块，每块内依次处理各组实例。
+     * 一块的矩阵数据从内存读入后被所有组复用，整个矩阵数组只从内存流过一次，与实例数无关
+     */
+    template <typename TIndex, typename TWeight>
+    void ApplyMappingRowsBatch(const FMappingKernelArgs& Args, const float* const* InLowResOffsets, FVector3f* const* OutHighResOffsets, int32 NumInstances, int32 RowBegin, int32 RowEnd)
+    {
+        // 只有一组时不需要分块
+        const int32 tileRows = NumInstances > MappingBatchGroupSize ? MappingBatchTileRows : RowEnd - RowBegin;
+        for (int32 tileBegin = RowBegin; tileBegin < RowEnd; tileBegin += tileRows)
+        {
+            const int32 tileEnd = FMath::Min(tileBegin + tileRows, RowEnd);
+            for (int32 first = 0; first < NumInstances; first += MappingBatchGroupSize)
+            {
+                const float* const* in = InLowResOffsets + first;
+                FVector3f* const* out = OutHighResOffsets + first;
+                switch (FMath::Min(NumInstances - first, MappingBatchGroupSize))
+                {
+                case 1: ApplyMappingRowsBatchKernel<TIndex, TWeight, 1>(Args, in, out, tileBegin, tileEnd); break;
+                case 2: ApplyMappingRowsBatchKernel<TIndex, TWeight, 2>(Args, in, out, tileBegin, tileEnd); break;
+                case 3: ApplyMappingRowsBatchKernel<TIndex, TWeight, 3>(Args, in, out, tileBegin, tileEnd); break;
+                default: ApplyMappingRowsBatchKernel<TIndex, TWeight, 4>(Args, in, out, tileBegin, tileEnd); break;
+                }
+            }
+        }
+    }
+
+    // 把 [0,1] 内的一行权重量化为 MaxQuantized 刻度，并把舍入误差补到最大权重上，保证行和不变
+    // (行和为 1 时，整体平移的低模偏移可以被精确映射)
+    template <typename TWeight>
+    void QuantizeRowWeights(const float* InWeights, int32 Width, TWeight* OutWeights)
+    {
+        constexpr int32 MaxQuantized = TNumericLimits<TWeight>::Max();
+
+        float rowSum = 0.0f;
+        int32 quantizedSum = 0;
+        int32 largestIdx = 0;
+        for (int32 k = 0; k < Width; ++k)
+        {
+            const int32 quantized = FMath::Clamp(FMath::RoundToInt(InWeights[k] * MaxQuantized), 0, MaxQuantized);
+            OutWeights[k] = static_cast<TWeight>(quantized);
+            rowSum += InWeights[k];
+            quantizedSum += quantized;
+            largestIdx = InWeights[k] > InWeights[largestIdx] ? k : largestIdx;
+        }
+
+        if (Width > 0)
+        {
+            const int32 residual = FMath::RoundToInt(rowSum * MaxQuantized) - quantizedSum;
+            OutWeights[largestIdx] = static_cast<TWeight>(FMath::Clamp(static_cast<int32>(OutWeights[largestIdx]) + residual, 0, MaxQuantized));
+        }
+    }
+}
 
 FTriplet::FTriplet(int32 InRow, int32 InCol, float InValue) : Row(InRow), Col(InCol), Value(InValue) { ; }
 
+FSparseRowBlock::FSparseRowBlock(int32 InFirstRow, int32 ReserveRows, int32 ReserveNonZeros) : FirstRow(InFirstRow)
+{
+    RowPtr.Reserve(ReserveRows + 1);
+    RowPtr.Add(0);
+    ColIndice.Reserve(ReserveNonZeros);
+    Value.Reserve(ReserveNonZeros);
+}
+
+void FSparseRowBlock::BeginRow(int32 Row)
+{
+    checkf(!bInRow, TEXT("BeginRow: 上一行尚未 EndRow"));
+    checkf(Row >= GetEndRow(), TEXT("BeginRow: 行号 %d 必须递增 (当前已到 %d)"), Row, GetEndRow());
+
+    while (GetEndRow() < Row)
+    {
+        RowPtr.Add(ColIndice.Num());
+    }
+    bInRow = true;
+}
+
+void FSparseRowBlock::AddEntry(int32 Col, float Weight)
+{
+    checkSlow(bInRow);
+    ColIndice.Add(Col);
+    Value.Add(Weight);
+}
+
+void FSparseRowBlock::EndRow()
+{
+    checkf(bInRow, TEXT("EndRow: 没有对应的 BeginRow"));
+    RowPtr.Add(ColIndice.Num());
+    bInRow = false;
+}
+
 FSparseMappingMatrix::FSparseMappingMatrix(int32 InRow, int32 InCol) : NumRow(InRow), NumCol(InCol)
 {
     ;
 }
 void FSparseMappingMatrix::SetFromTriplet(const TArray<FTriplet> &Triplets)
 {
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
     int32 numNonZeros = Triplets.Num();
 
     // 预分配空间
@@ -45,6 +303,304 @@ void FSparseMappingMatrix::SetFromTriplet(const TArray<FTriplet> &Triplets)
             Value[insertIndex] = triplet.Value;
         }
     }
+
+    FinishBuild();
+}
+
+void FSparseMappingMatrix::FinishBuild()
+{
+    SortRowColumns();
+    UpdateStorageLayout();
+    BuildTranspose();
+}
+
+void FSparseMappingMatrix::BeginBuild(int32 ReserveNonZeros)
+{
+    // 重新构建的是一个全新的矩阵，清除之前的布局、重排与压缩状态
+    FixedRowWidth = 0;
+    ColPermutation.Reset();
+    StorageMode = EMappingStorageMode::Full;
+    CompactColIndice.Empty();
+    CompactValue16.Empty();
+    CompactValue8.Empty();
+    QuantizationMaxWeightError = 0.0f;
+    QuantizationErrorBound = 0.0f;
+
+    RowPtr.Reset(NumRow + 1);
+    RowPtr.Add(0);
+    ColIndice.Reset(ReserveNonZeros);
+    Value.Reset(ReserveNonZeros);
+    BuildingRow = INDEX_NONE;
+}
+
+void FSparseMappingMatrix::BeginRow(int32 Row)
+{
+    checkf(BuildingRow == INDEX_NONE, TEXT("BeginRow: 上一行尚未 EndRow"));
+    checkf(Row >= RowPtr.Num() - 1 && Row < NumRow, TEXT("BeginRow: 行号 %d 必须递增且小于 NumRow %d"), Row, NumRow);
+
+    // 跳过的行 (如高模中已删除的顶点 ID) 记为空行
+    while (RowPtr.Num() - 1 < Row)
+    {
+        RowPtr.Add(ColIndice.Num());
+    }
+    BuildingRow = Row;
+}
+
+void FSparseMappingMatrix::AddEntry(int32 Col, float Weight)
+{
+    checkSlow(BuildingRow != INDEX_NONE && Col >= 0 && Col < NumCol);
+    ColIndice.Add(Col);
+    Value.Add(Weight);
+}
+
+void FSparseMappingMatrix::EndRow()
+{
+    checkf(BuildingRow != INDEX_NONE, TEXT("EndRow: 没有对应的 BeginRow"));
+    RowPtr.Add(ColIndice.Num());
+    BuildingRow = INDEX_NONE;
+}
+
+void FSparseMappingMatrix::EndBuild()
+{
+    checkf(BuildingRow == INDEX_NONE, TEXT("EndBuild: 最后一行尚未 EndRow"));
+    while (RowPtr.Num() < NumRow + 1)
+    {
+        RowPtr.Add(ColIndice.Num());
+    }
+    FinishBuild();
+}
+
+void FSparseMappingMatrix::SetFromRowBlocks(TArray<FSparseRowBlock> &&Blocks)
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
+    Algo::SortBy(Blocks, &FSparseRowBlock::FirstRow);
+
+    int32 numNonZeros = 0;
+    for (const FSparseRowBlock& block : Blocks)
+    {
+        numNonZeros += block.ColIndice.Num();
+    }
+
+    BeginBuild(numNonZeros);
+    for (FSparseRowBlock& block : Blocks)
+    {
+        checkf(block.FirstRow >= RowPtr.Num() - 1 && block.GetEndRow() <= NumRow, TEXT("SetFromRowBlocks: 行块 [%d, %d) 重叠或越界"), block.FirstRow, block.GetEndRow());
+        while (RowPtr.Num() - 1 < block.FirstRow)
+        {
+            RowPtr.Add(ColIndice.Num());
+        }
+
+        const int32 baseOffset = ColIndice.Num();
+        for (int32 i = 1; i < block.RowPtr.Num(); ++i)
+        {
+            RowPtr.Add(baseOffset + block.RowPtr[i]);
+        }
+        ColIndice.Append(block.ColIndice);
+        Value.Append(block.Value);
+
+        // 已拷贝的块立即释放，后续块合并时的占用随之下降
+        block.RowPtr.Empty();
+        block.ColIndice.Empty();
+        block.Value.Empty();
+    }
+    EndBuild();
+}
+
+int32 FSparseMappingMatrix::GetColIndex(int32 NonZeroIndex) const
+{
+    return StorageMode == EMappingStorageMode::Full ? ColIndice[NonZeroIndex] : static_cast<int32>(CompactColIndice[NonZeroIndex]);
+}
+
+void FSparseMappingMatrix::BuildTranspose()
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
+    ColPtr.Reset();
+    RowIndice.Reset();
+    if (RowPtr.Num() != NumRow + 1)
+    {
+        return;
+    }
+
+    // 与 SetFromTriplet 相同的计数 + 前缀和 + 填充，按行顺序填充保证每列内的行号有序
+    const int32 numNonZeros = RowPtr[NumRow];
+    ColPtr.Init(0, NumCol + 1);
+    for (int32 i = 0; i < numNonZeros; ++i)
+    {
+        ColPtr[GetColIndex(i) + 1]++;
+    }
+    for (int32 col = 0; col < NumCol; ++col)
+    {
+        ColPtr[col + 1] += ColPtr[col];
+    }
+
+    RowIndice.SetNumUninitialized(numNonZeros);
+    TArray<int32> currentColOffsets = ColPtr;
+    for (int32 row = 0; row < NumRow; ++row)
+    {
+        for (int32 i = RowPtr[row]; i < RowPtr[row + 1]; ++i)
+        {
+            RowIndice[currentColOffsets[GetColIndex(i)]++] = row;
+        }
+    }
+}
+
+void FSparseMappingMatrix::SortRowColumns()
+{
+    if (StorageMode != EMappingStorageMode::Full)
+    {
+        return;
+    }
+
+    TArray<TPair<int32, float>, TInlineAllocator<MaxFixedRowWidth>> entries;
+    for (int32 row = 0; row < NumRow; ++row)
+    {
+        const int32 startIdx = RowPtr[row];
+        const int32 endIdx = RowPtr[row + 1];
+
+        entries.Reset();
+        for (int32 i = startIdx; i < endIdx; ++i)
+        {
+            entries.Emplace(ColIndice[i], Value[i]);
+        }
+        entries.StableSort([](const TPair<int32, float>& A, const TPair<int32, float>& B) { return A.Key < B.Key; });
+
+        for (int32 i = startIdx; i < endIdx; ++i)
+        {
+            ColIndice[i] = entries[i - startIdx].Key;
+            Value[i] = entries[i - startIdx].Value;
+        }
+    }
+}
+
+void FSparseMappingMatrix::ReorderColumnsForLocality()
+{
+    if (StorageMode != EMappingStorageMode::Full)
+    {
+        UE_LOG(LogTemp, Error, TEXT("ReorderColumnsForLocality: 压缩存储不能重排，请在 Compress 之前调用"));
+        return;
+    }
+
+    // 已经重排过时，在现有顺序上继续重排并合并重排表
+    TArray<int32> previousPermutation = MoveTemp(ColPermutation);
+
+    // first-touch：按行扫描，列第一次出现时分配新编号
+    TArray<int32> newIndexOfOld;
+    newIndexOfOld.Init(INDEX_NONE, NumCol);
+    int32 nextIndex = 0;
+    for (int32 col : ColIndice)
+    {
+        if (newIndexOfOld[col] == INDEX_NONE)
+        {
+            newIndexOfOld[col] = nextIndex++;
+        }
+    }
+    // 没有被任何行引用的低模顶点排在最后
+    for (int32 col = 0; col < NumCol; ++col)
+    {
+        if (newIndexOfOld[col] == INDEX_NONE)
+        {
+            newIndexOfOld[col] = nextIndex++;
+        }
+    }
+
+    ColPermutation.SetNumUninitialized(NumCol);
+    for (int32 oldCol = 0; oldCol < NumCol; ++oldCol)
+    {
+        const int32 modelCol = previousPermutation.Num() == NumCol ? previousPermutation[oldCol] : oldCol;
+        ColPermutation[newIndexOfOld[oldCol]] = modelCol;
+    }
+
+    for (int32& col : ColIndice)
+    {
+        col = newIndexOfOld[col];
+    }
+    SortRowColumns();
+    BuildTranspose();
+}
+
+TConstArrayView<float> FSparseMappingMatrix::PermuteLowResOffsets(TConstArrayView<float> InModelOffsets, TArray<float>& Scratch) const
+{
+    if (ColPermutation.Num() != NumCol || InModelOffsets.Num() != NumCol * 3)
+    {
+        return InModelOffsets;
+    }
+
+    Scratch.SetNumUninitialized(NumCol * 3, EAllowShrinking::No);
+    const float* src = InModelOffsets.GetData();
+    float* dst = Scratch.GetData();
+    for (int32 col = 0; col < NumCol; ++col, dst += 3)
+    {
+        const float* vertex = src + ColPermutation[col] * 3;
+        dst[0] = vertex[0];
+        dst[1] = vertex[1];
+        dst[2] = vertex[2];
+    }
+    return Scratch;
+}
+
+void FSparseMappingMatrix::UpdateStorageLayout()
+{
+    // 压缩后原始数组已释放，布局在压缩时已经确定
+    if (StorageMode != EMappingStorageMode::Full)
+    {
+        return;
+    }
+
+    FixedRowWidth = 0;
+    if (NumRow <= 0 || RowPtr.Num() != NumRow + 1)
+    {
+        return;
+    }
+
+    int32 maxWidth = 0;
+    for (int32 row = 0; row < NumRow; ++row)
+    {
+        maxWidth = FMath::Max(maxWidth, RowPtr[row + 1] - RowPtr[row]);
+    }
+
+    const int64 numNonZeros = RowPtr[NumRow];
+    const int64 paddedNonZeros = static_cast<int64>(maxWidth) * NumRow;
+    if (maxWidth == 0 || maxWidth > MaxFixedRowWidth || paddedNonZeros * 4 > numNonZeros * 5)
+    {
+        return;
+    }
+
+    // 行宽不一致时补齐：补位重复本行最后一个列索引 (保持访存局部性)，权重为 0
+    if (paddedNonZeros != numNonZeros)
+    {
+        TArray<int32> paddedCols;
+        TArray<float> paddedValues;
+        paddedCols.SetNumUninitialized(static_cast<int32>(paddedNonZeros));
+        paddedValues.SetNumZeroed(static_cast<int32>(paddedNonZeros));
+
+        for (int32 row = 0; row < NumRow; ++row)
+        {
+            const int32 startIdx = RowPtr[row];
+            const int32 width = RowPtr[row + 1] - startIdx;
+            const int32 outIdx = row * maxWidth;
+            for (int32 k = 0; k < maxWidth; ++k)
+            {
+                if (k < width)
+                {
+                    paddedCols[outIdx + k] = ColIndice[startIdx + k];
+                    paddedValues[outIdx + k] = Value[startIdx + k];
+                }
+                else
+                {
+                    paddedCols[outIdx + k] = width > 0 ? ColIndice[startIdx + width - 1] : 0;
+                }
+            }
+        }
+
+        ColIndice = MoveTemp(paddedCols);
+        Value = MoveTemp(paddedValues);
+        for (int32 row = 0; row <= NumRow; ++row)
+        {
+            RowPtr[row] = row * maxWidth;
+        }
+    }
+
+    FixedRowWidth = maxWidth;
 }
 
 // 从低模映射到低模
@@ -56,6 +612,13 @@ bool FSparseMappingMatrix::ApplyMapping(const TArray<FVector>& InLowResOffsets,
         return false;
     }
 
+    // 双精度参考路径只读取完整精度数组
+    if (StorageMode != EMappingStorageMode::Full)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("ApplyMapping: 压缩存储只支持单精度路径"));
+        return false;
+    }
+
     // 2. 初始化输出数组：大小设为高模顶点数 (NumRow)，并全部填充为 0
     OutHighResOffsets.Init(FVector::ZeroVector, NumRow);
 
@@ -83,4 +646,313 @@ bool FSparseMappingMatrix::ApplyMapping(const TArray<FVector>& InLowResOffsets,
     }
 
     return true;
+}
+
+bool FSparseMappingMatrix::ApplyMapping(TConstArrayView<float> InLowResOffsets, TArrayView<FVector3f> OutHighResOffsets) const
+{
+    CLOTH_DEFORMER_SCOPE(Mapping);
+
+    // 输入为交错的 float3，长度必须精确等于 NumCol * 3
+    if (InLowResOffsets.Num() != NumCol * 3 || OutHighResOffsets.Num() != NumRow)
+    {
+        return false;
+    }
+
+    ApplyMappingRows(InLowResOffsets.GetData(), OutHighResOffsets.GetData(), 0, NumRow);
+    return true;
+}
+
+bool FSparseMappingMatrix::ApplyMappingParallel(TConstArrayView<float> InLowResOffsets, TArrayView<FVector3f> OutHighResOffsets, int32 MinRowsPerTask) const
+{
+    CLOTH_DEFORMER_SCOPE(Mapping);
+
+    if (InLowResOffsets.Num() != NumCol * 3 || OutHighResOffsets.Num() != NumRow)
+    {
+        return false;
+    }
+    // 空矩阵 (默认构造或尚未构建) 没有可写的行
+    if (NumRow == 0)
+    {
+        return true;
+    }
+
+    TArray<int32, TInlineAllocator<64>> rowBounds;
+    const int32 numTasks = ComputeRowPartition(MinRowsPerTask, rowBounds);
+    if (numTasks <= 1)
+    {
+        ApplyMappingRows(InLowResOffsets.GetData(), OutHighResOffsets.GetData(), 0, NumRow);
+        return true;
+    }
+
+    const float* inData = InLowResOffsets.GetData();
+    FVector3f* outData = OutHighResOffsets.GetData();
+    ParallelFor(numTasks, [this, inData, outData, &rowBounds](int32 task)
+        {
+            ApplyMappingRows(inData, outData, rowBounds[task], rowBounds[task + 1]);
+        });
+
+    return true;
+}
+
+int32 FSparseMappingMatrix::ComputeRowPartition(int32 MinRowsPerTask, TArray<int32, TInlineAllocator<64>>& OutRowBounds) const
+{
+    // 没有行或 RowPtr 未建立时无法按非零元切分，整体作为一个任务
+    if (NumRow == 0 || RowPtr.Num() != NumRow + 1)
+    {
+        OutRowBounds = { 0, NumRow };
+        return 1;
+    }
+
+    // 任务数：受最小行数和工作线程数 (+ 调用线程) 共同限制
+    const int32 maxTasks = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+    const int32 numTasks = FMath::Max(FMath::Min(NumRow / FMath::Max(MinRowsPerTask, 1), maxTasks), 1);
+
+    // 按非零元均分：第 k 个边界为 RowPtr 中首个 >= k * nnz / numTasks 的行
+    // KNN 每行宽度近似相同，但投影/混合策略下行宽差异很大，按行数均分会导致个别任务拖尾
+    OutRowBounds.SetNumUninitialized(numTasks + 1);
+    OutRowBounds[0] = 0;
+    OutRowBounds[numTasks] = NumRow;
+
+    const TConstArrayView<int32> rowPtrView(RowPtr.GetData(), NumRow + 1);
+    const int64 numNonZeros = RowPtr[NumRow];
+    for (int32 task = 1; task < numTasks; ++task)
+    {
+        const int32 target = static_cast<int32>(numNonZeros * task / numTasks);
+        const int32 row = Algo::LowerBound(rowPtrView, target);
+        OutRowBounds[task] = FMath::Clamp(row, OutRowBounds[task - 1], NumRow);
+    }
+    return numTasks;
+}
+
+bool FSparseMappingMatrix::ApplyMappingBatched(TConstArrayView<FMappingBatchItem> Items, int32 MinRowsPerTask) const
+{
+    CLOTH_DEFORMER_SCOPE(Mapping);
+
+    if (Items.Num() == 0)
+    {
+        return true;
+    }
+
+    TArray<const float*, TInlineAllocator<32>> inputs;
+    TArray<FVector3f*, TInlineAllocator<32>> outputs;
+    for (const FMappingBatchItem& item : Items)
+    {
+        if (item.LowResOffsets.Num() != NumCol * 3 || item.HighResOffsets.Num() != NumRow)
+        {
+            return false;
+        }
+        inputs.Add(item.LowResOffsets.GetData());
+        outputs.Add(item.HighResOffsets.GetData());
+    }
+    if (NumRow == 0)
+    {
+        return true;
+    }
+
+    FMappingKernelArgs args;
+    args.InLowResOffsets = nullptr;
+    args.OutHighResOffsets = nullptr;
+
+    // 实例越多每行的工作量越大，按总工作量决定任务数
+    TArray<int32, TInlineAllocator<64>> rowBounds;
+    const int32 numTasks = ComputeRowPartition(FMath::Max(MinRowsPerTask / Items.Num(), 1), rowBounds);
+    const int32 numInstances = Items.Num();
+
+    VisitStorage(*this, args, [&](auto IndexTag, auto WeightTag)
+        {
+            using TIndex = decltype(IndexTag);
+            using TWeight = decltype(WeightTag);
+            ParallelFor(numTasks, [&](int32 task)
+                {
+                    ApplyMappingRowsBatch<TIndex, TWeight>(args, inputs.GetData(), outputs.GetData(), numInstances, rowBounds[task], rowBounds[task + 1]);
+                }, numTasks <= 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+        });
+
+    return true;
+}
+
+void FSparseMappingMatrix::ApplyMappingRows(const float* InLowResOffsets, FVector3f* OutHighResOffsets, int32 RowBegin, int32 RowEnd) const
+{
+    FMappingKernelArgs args;
+    args.InLowResOffsets = InLowResOffsets;
+    args.OutHighResOffsets = OutHighResOffsets;
+
+    VisitStorage(*this, args, [&](auto IndexTag, auto WeightTag)
+        {
+            using TIndex = decltype(IndexTag);
+            using TWeight = decltype(WeightTag);
+            SelectMappingKernel<TIndex, TWeight>(FixedRowWidth)(args, RowBegin, RowEnd);
+        });
+}
+
+template <typename TWeight>
+void FSparseMappingMatrix::QuantizeWeights(TArray<TWeight>& OutWeights, float& OutMaxWeightError, float& OutErrorBound) const
+{
+    OutWeights.SetNumUninitialized(Value.Num());
+    OutMaxWeightError = 0.0f;
+    OutErrorBound = 0.0f;
+
+    TArray<float, TInlineAllocator<MaxFixedRowWidth>> clamped;
+    for (int32 row = 0; row < NumRow; ++row)
+    {
+        const int32 startIdx = RowPtr[row];
+        const int32 width = RowPtr[row + 1] - startIdx;
+
+        clamped.Reset();
+        for (int32 k = 0; k < width; ++k)
+        {
+            clamped.Add(FMath::Clamp(Value[startIdx + k], 0.0f, 1.0f));
+        }
+        QuantizeRowWeights<TWeight>(clamped.GetData(), width, &OutWeights[startIdx]);
+
+        // 单权重最大误差，以及 max_row Σ|w - q(w)|：任一高模顶点的偏移误差不超过它乘以低模偏移的最大长度
+        float rowError = 0.0f;
+        for (int32 k = 0; k < width; ++k)
+        {
+            const float error = FMath::Abs(Value[startIdx + k] - OutWeights[startIdx + k] * WeightDequantScale<TWeight>);
+            OutMaxWeightError = FMath::Max(OutMaxWeightError, error);
+            rowError += error;
+        }
+        OutErrorBound = FMath::Max(OutErrorBound, rowError);
+    }
+}
+
+bool FSparseMappingMatrix::Compress(EMappingStorageMode InMode)
+{
+    LLM_SCOPE_BYTAG(ClothDeformer_Mapping);
+    if (InMode == StorageMode)
+    {
+        return true;
+    }
+    if (StorageMode != EMappingStorageMode::Full)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Compress: 矩阵已经是压缩存储，请从完整精度重新烘焙"));
+        return false;
+    }
+
+    const int32 numNonZeros = Value.Num();
+    if (NumCol > TNumericLimits<uint16>::Max() + 1)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Compress: 低模顶点数 %d 超过 16 位列索引范围"), NumCol);
+        return false;
+    }
+
+    // 量化要求权重落在 [0,1]，投影重心坐标可能有极小的负值，允许少量容差
+    constexpr float weightTolerance = 1e-4f;
+    for (float weight : Value)
+    {
+        if (weight < -weightTolerance || weight > 1.0f + weightTolerance)
+        {
+            UE_LOG(LogTemp, Error, TEXT("Compress: 权重 %f 超出 [0,1]，无法量化"), weight);
+            return false;
+        }
+    }
+
+    TArray<uint16> compactCols;
+    compactCols.SetNumUninitialized(numNonZeros);
+    for (int32 i = 0; i < numNonZeros; ++i)
+    {
+        compactCols[i] = static_cast<uint16>(ColIndice[i]);
+    }
+
+    TArray<uint16> value16;
+    TArray<uint8> value8;
+    float maxWeightError = 0.0f;
+    float errorBound = 0.0f;
+    if (InMode == EMappingStorageMode::Compact16)
+    {
+        QuantizeWeights(value16, maxWeightError, errorBound);
+    }
+    else
+    {
+        QuantizeWeights(value8, maxWeightError, errorBound);
+    }
+
+    const int64 fullBytes = static_cast<int64>(numNonZeros) * (sizeof(int32) + sizeof(float));
+    const int64 compactBytes = static_cast<int64>(numNonZeros) * (sizeof(uint16) + (InMode == EMappingStorageMode::Compact16 ? sizeof(uint16) : sizeof(uint8)));
+
+    CompactColIndice = MoveTemp(compactCols);
+    CompactValue16 = MoveTemp(value16);
+    CompactValue8 = MoveTemp(value8);
+    ColIndice.Empty();
+    Value.Empty();
+    StorageMode = InMode;
+    QuantizationMaxWeightError = maxWeightError;
+    QuantizationErrorBound = errorBound;
+
+    UE_LOG(LogTemp, Log, TEXT("Compress: 非零元 %d, 列/权重存储 %lld -> %lld 字节, 单权重最大误差 %g, 行误差上界 %g (乘以低模偏移最大长度即为高模偏移误差上界)"),
+        numNonZeros, fullBytes, compactBytes, maxWeightError, errorBound);
+    return true;
+}
+
+
+int32 FSparseMappingMatrix::ApplyMappingIncremental(TConstArrayView<float> InLowResOffsets, TArray<float>& InOutAppliedLowResOffsets, float ChangeThreshold,
+                                                   TArrayView<FVector3f> InOutHighResOffsets, TBitArray<>& RowScratch) const
+{
+    CLOTH_DEFORMER_SCOPE(Mapping);
+
+    if (InLowResOffsets.Num() != NumCol * 3 || InOutHighResOffsets.Num() != NumRow)
+    {
+        return INDEX_NONE;
+    }
+
+    // 第一帧或转置索引缺失：完整映射
+    if (InOutAppliedLowResOffsets.Num() != NumCol * 3 || ColPtr.Num() != NumCol + 1)
+    {
+        InOutAppliedLowResOffsets.Reset();
+        InOutAppliedLowResOffsets.Append(InLowResOffsets.GetData(), InLowResOffsets.Num());
+        ApplyMappingRows(InOutAppliedLowResOffsets.GetData(), InOutHighResOffsets.GetData(), 0, NumRow);
+        return NumRow;
+    }
+
+    // 1. 找出变化的低模顶点，更新其参与计算的值，并标记引用它的行
+    RowScratch.Init(false, NumRow);
+    const float thresholdSquared = ChangeThreshold * ChangeThreshold;
+    const float* current = InLowResOffsets.GetData();
+    float* applied = InOutAppliedLowResOffsets.GetData();
+    for (int32 col = 0; col < NumCol; ++col)
+    {
+        const int32 base = col * 3;
+        const float dx = current[base + 0] - applied[base + 0];
+        const float dy = current[base + 1] - applied[base + 1];
+        const float dz = current[base + 2] - applied[base + 2];
+        if (dx * dx + dy * dy + dz * dz <= thresholdSquared)
+        {
+            continue;
+        }
+
+        applied[base + 0] = current[base + 0];
+        applied[base + 1] = current[base + 1];
+        applied[base + 2] = current[base + 2];
+        for (int32 i = ColPtr[col]; i < ColPtr[col + 1]; ++i)
+        {
+            RowScratch[RowIndice[i]] = true;
+        }
+    }
+
+    // 2. 按连续区间重算被标记的行，连续行仍走定宽/压缩等特化内核
+    int32 touchedRows = 0;
+    int32 runBegin = INDEX_NONE;
+    int32 runEnd = INDEX_NONE;
+    for (TConstSetBitIterator<> it(RowScratch); it; ++it)
+    {
+        const int32 row = it.GetIndex();
+        if (row != runEnd)
+        {
+            if (runBegin != INDEX_NONE)
+            {
+                ApplyMappingRows(applied, InOutHighResOffsets.GetData(), runBegin, runEnd);
+                touchedRows += runEnd - runBegin;
+            }
+            runBegin = row;
+        }
+        runEnd = row + 1;
+    }
+    if (runBegin != INDEX_NONE)
+    {
+        ApplyMappingRows(applied, InOutHighResOffsets.GetData(), runBegin, runEnd);
+        touchedRows += runEnd - runBegin;
+    }
+
+    return touchedRows;
 }
\ No newline at end of file
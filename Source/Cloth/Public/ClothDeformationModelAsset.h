@@ -6,6 +6,97 @@
 #include "Engine/DataAsset.h"
 #include "ClothDeformationModelAsset.generated.h"
 
+// 运行时使用的模型精度变体
+UENUM(BlueprintType)
+enum class EClothModelPrecision : uint8
+{
+	FP32,
+	// 半精度权重，输入输出可以是 float16 (由实例转换) 或保持 float32
+	FP16,
+	// 动态量化的 INT8 权重，输入输出仍为 float32
+	INT8,
+};
+
+// 执行推理的后端
+UENUM(BlueprintType)
+enum class EClothInferenceBackend : uint8
+{
+	// ONNX Runtime 会话 (支持任意算子与精度变体)
+	OnnxRuntime UMETA(DisplayName = "ONNX Runtime"),
+	// 内置的纯 C++ 实现，只支持小型 MLP / GRU / LSTM 模型的 float32 子集，没有 ONNX Runtime 的平台始终使用它
+	Native,
+};
+
+/**
+ * FModelVariantAccuracy
+ * 一个精度变体相对 FP32 模型在验证输入集上的误差与耗时
+ */
+USTRUCT(BlueprintType)
+struct CLOTH_API FModelVariantAccuracy
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Validation")
+	EClothModelPrecision Precision{EClothModelPrecision::FP32};
+
+	// 所有输出元素上的最大绝对误差与均方根误差
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Validation")
+	float MaxAbsError{0.0f};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Validation")
+	float RmsError{0.0f};
+
+	// 每个样本的平均推理耗时 (毫秒)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Validation")
+	float Fp32Milliseconds{0.0f};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Validation")
+	float VariantMilliseconds{0.0f};
+};
+
+/**
+ * FRecurrentStatePair
+ * 一对循环状态输入/输出：第 N 帧 OutputName 的结果作为第 N+1 帧 InputName 的值
+ */
+USTRUCT(BlueprintType)
+struct CLOTH_API FRecurrentStatePair
+{
+	GENERATED_BODY()
+
+	// 读取上一帧状态的模型输入
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recurrent State")
+	FString InputName;
+
+	// 产出下一帧状态的模型输出
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Recurrent State")
+	FString OutputName;
+};
+
+/**
+ * FOnnxThreadingOverrides
+ * 资产级的 ONNX Runtime 逐会话线程设置，只在项目设置未启用全局线程池时生效
+ */
+USTRUCT(BlueprintType)
+struct CLOTH_API FOnnxThreadingOverrides
+{
+	GENERATED_BODY()
+
+	// 是否用下面的值代替项目设置中的逐会话默认值
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Threading")
+	bool bOverride{false};
+
+	// intra-op 线程数，0 表示由 ORT 决定
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Threading", meta = (ClampMin = "0", EditCondition = "bOverride"))
+	int32 IntraOpThreads{1};
+
+	// inter-op 线程数，大于 1 时以并行模式执行
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Threading", meta = (ClampMin = "0", EditCondition = "bOverride"))
+	int32 InterOpThreads{1};
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Threading", meta = (EditCondition = "bOverride"))
+	bool bAllowSpinning{false};
+};
+
 /**
  * UClothDeformationModelAsset
  * 这个类代表了内容浏览器中的ONNX模型资产。
@@ -30,6 +121,27 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model")
 	TArray<uint8> modelData_;
 
+	// 运行时使用的精度变体，所选变体没有数据时回退到 FP32
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Precision")
+	EClothModelPrecision runtimePrecision_{EClothModelPrecision::FP32};
+
+	// FP16 / INT8 变体的模型数据。导入时从 .onnx 同目录的 <名字>.fp16.onnx 与 <名字>.int8.onnx 读取
+	UPROPERTY(VisibleAnywhere, Category = "Cloth Deformation Model|Precision")
+	TArray<uint8> fp16ModelData_;
+
+	UPROPERTY(VisibleAnywhere, Category = "Cloth Deformation Model|Precision")
+	TArray<uint8> int8ModelData_;
+
+	// 各变体在验证输入集上相对 FP32 的误差与耗时，导入或 ValidateModelVariants 时更新
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Precision")
+	TArray<FModelVariantAccuracy> variantAccuracy_;
+
+	// 指定精度的模型数据，没有该变体时为空
+	const TArray<uint8>& GetModelData(EClothModelPrecision Precision) const;
+
+	// 实际使用的精度：runtimePrecision_，其变体数据为空时回退到 FP32
+	EClothModelPrecision GetRuntimePrecision() const;
+
 	// 模型的输入节点名称。
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Metadata")
 	TArray<FString> inputNodeNames_;
@@ -38,7 +150,37 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Metadata")
 	TArray<FString> outputNodeNames_;
 
+	// 循环状态的输入/输出配对，可以声明多对 (如堆叠的 GRU)。导入模型时按名字预填，可手动修改
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Metadata")
+	TArray<FRecurrentStatePair> recurrentStatePairs_;
+
+	// 该模型会话的线程设置
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Runtime")
+	FOnnxThreadingOverrides threadingOverrides_;
+
+	// 推理后端。小模型用 Native 可以省去 ONNX Runtime 的调度开销，用 ClothInferenceConformance 命令行验证两者输出一致
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Cloth Deformation Model|Runtime")
+	EClothInferenceBackend inferenceBackend_{EClothInferenceBackend::OnnxRuntime};
+
+	// 实际使用的后端：没有 ONNX Runtime 的平台始终为 Native
+	EClothInferenceBackend GetInferenceBackend() const;
+
+	// 按名字 (state/hidden/hx) 猜测循环状态配对：带这些字眼的输入与输出按出现顺序一一配对
+	static TArray<FRecurrentStatePair> GuessRecurrentStatePairs(const TArray<FString>& InputNames, const TArray<FString>& OutputNames);
+
+	// 加载的模型数据计入 ClothDeformer/ModelData 的 LLM 标签
+	virtual void Serialize(FArchive& Ar) override;
+
 #if WITH_EDITOR
+	// 在固定种子生成的验证输入集上比较各精度变体与 FP32 的输出，结果写入 variantAccuracy_
+	UFUNCTION(CallInEditor, Category = "Actions")
+	void ValidateModelVariants();
+
+	// 为 FP32 模型数据生成专用的原生求值器源文件 (插件的 Source/Cloth/Private/Generated/)，重新编译后原生后端按模型 CRC 自动使用。
+	// 动态维度固定为 1，运行时输入尺寸不同时仍由解释执行
+	UFUNCTION(CallInEditor, Category = "Actions")
+	void GenerateNativeEvaluator();
+
 	// 当属性在编辑器中被修改后，这个函数会被调用。
 	virtual void PostEditChangeProperty(FPropertyChangedEvent &PropertyChangedEvent) override;
 #endif
@@ -55,6 +197,9 @@ private:
 	// 从文件路径加载二进制数据
 	static TArray<uint8> LoadModelBytes(const FString &FilePath);
 
+	// 读取与 FP32 模型同目录的精度变体 (<名字>.fp16.onnx / <名字>.int8.onnx)，不存在时清空
+	void LoadVariantModels(const FString& ModelFilePath);
+
 	// 解析内存中的元数据
 	static FOnnxMetadata ParseModelMetadata(const TArray<uint8> &InModelData);
 #endif
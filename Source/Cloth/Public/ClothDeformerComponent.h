@@ -8,13 +8,50 @@
 #include "OnnxModelInstance.h"
 #include "SparseMappingMatrix.h"
 #include "InputAdapterBase.h"
+#include "Tasks/Task.h"
+#include "RenderCommandFence.h"
+#include <atomic>
 #include "ClothDeformerComponent.generated.h"
 
 
+// 推理在哪个线程、哪个时刻执行
+UENUM(BlueprintType)
+enum class EClothInferenceMode : uint8
+{
+	// 在组件 Tick 中同步推理
+	Synchronous,
+	// Tick 只采集输入并在后台任务中推理，结果在下一帧 Tick 开始时取回 (一帧延迟)
+	AsyncNextFrame UMETA(DisplayName = "Async (Next Frame)"),
+	// 同样在后台任务中推理，但在本帧 TG_PostUpdateWork 中等待并取回结果 (无延迟)
+	AsyncSameFrame UMETA(DisplayName = "Async (Same Frame)"),
+};
+
+/**
+ * FClothInferenceCompleteTickFunction
+ * AsyncSameFrame 模式下在较晚的 Tick 组中等待后台推理并应用结果
+ */
+USTRUCT()
+struct FClothInferenceCompleteTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	class UClothDeformerComponent* Target{nullptr};
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FClothInferenceCompleteTickFunction> : public TStructOpsTypeTraitsBase2<FClothInferenceCompleteTickFunction>
+{
+	enum { WithCopy = false };
+};
+
 // Forward-declare our classes
 class UClothDeformationModelAsset;
 class FOnnxModelInstance;
 class UDynamicMeshComponent;
+struct FOnnxBatchItem;
 
 /**
  * UClothDeformerComponent
@@ -39,6 +76,12 @@ protected:
 
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
+	virtual void RegisterComponentTickFunctions(bool bRegister) override;
+
+	// 渲染命令持有本组件的指针，销毁前等待已提交的命令执行完
+	virtual void BeginDestroy() override;
+	virtual bool IsReadyForFinishDestroy() override;
+
 public:
 	// 使用当前指定的ModelAsset初始化推理引擎。
 	// 如果成功则返回true。可以调用此函数在运行时切换模型。
@@ -60,6 +103,18 @@ public:
 	FShaderResourceViewRHIRef GetOffsetBufferSRV() const { return OffsetBufferSRV; }
 	uint32 GetVertexCount() const;
 
+	// 子系统批量推理使用：收集本帧的模型输入视图 (整组推理结束前 OutInputViews 须保持有效)，组成批量推理项
+	FOnnxBatchItem MakeBatchInferenceItem(TArray<TConstArrayView<float>, TInlineAllocator<8>>& OutInputViews);
+	// 批量推理结束后应用结果，bBatched 为 false 时先以本组件的 IoBinding 单独推理
+	void CompleteBatchedInference(const FOnnxBatchItem& Item, bool bBatched);
+
+	// 子系统批量映射使用 (仅渲染线程)：锁定本组件的上传缓冲，交接缓冲中的低模偏移按矩阵列顺序重排后组成批量映射项
+	FMappingBatchItem BeginBatchedUpload_RenderThread(FRHICommandListImmediate& RHICmdList, const FSparseMappingMatrix& MappingData, int32 HandoffSlot);
+	// 批量映射结束后记录映射行数、解锁上传缓冲并归还交接缓冲，映射失败时先清零锁定的内存
+	void EndBatchedUpload_RenderThread(FRHICommandListImmediate& RHICmdList, const FMappingBatchItem& Item, int32 HandoffSlot, bool bMapped);
+	// 子系统丢弃已登记的映射时归还交接缓冲 (游戏线程)
+	void CancelQueuedMapping(int32 HandoffSlot);
+
 	// 该组件应用的 ONNX 模型资产
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Source")
 	UClothDeformationModelAsset *modelAsset_{nullptr};
@@ -68,6 +123,43 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Source")
 	class UMeshMappingAsset* MappingAsset{nullptr};
 
+	// 并行映射时每个任务至少处理的高模顶点数，高模顶点数不足两个任务时串行执行
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance", meta = (ClampMin = "1"))
+	int32 MappingMinRowsPerTask{FSparseMappingMatrix::DefaultMinRowsPerTask};
+
+	// 与其他使用同一映射资产的组件合并为一次批量映射 (由 UClothDeformerSubsystem 在 TG_PostUpdateWork 之前统一执行)。
+	// AsyncSameFrame 模式的结果在子系统 Tick 之后才取回，不参与合并，以免推迟到下一帧
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance")
+	bool bBatchMappingWithSharedAsset{true};
+
+	// 推理执行方式。异步模式下游戏线程只负责采集输入，推理在后台任务中进行，且不参与跨角色的 batch 合并
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance")
+	EClothInferenceMode InferenceMode{EClothInferenceMode::Synchronous};
+
+	// 与其他使用同一模型资产的组件沿 batch 维合并为一次推理 (由 UClothDeformerSubsystem 在 TG_PostUpdateWork 之前统一执行)，模型不支持 batch 维时自动逐个运行
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance")
+	bool bBatchInferenceWithSharedAsset{true};
+
+	// 增量映射：只重算受变化低模顶点影响的高模行，适合大面积近乎静止的服装
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance")
+	bool bIncrementalMapping{false};
+
+	// 增量映射时低模顶点位移变化不超过该值视为未变化
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Performance", meta = (ClampMin = "0.0", EditCondition = "bIncrementalMapping"))
+	float IncrementalChangeThreshold{0.01f};
+
+	// 最近一次映射实际计算的高模行数 (非增量模式下等于高模顶点数，映射失败时为 0)
+	UFUNCTION(BlueprintPure, Category = "Cloth Deformer|Performance")
+	int32 GetLastMappedRowCount() const { return LastMappedRowCount.load(std::memory_order_relaxed); }
+
+	// 推理与结果交接路径上实际测得的堆分配次数 (见 FOnnxModelInstance::GetAllocationCount)，预热后应保持不变
+	UFUNCTION(BlueprintPure, Category = "Cloth Deformer|Performance")
+	int64 GetInferenceAllocationCount() const;
+
+	// 从 BeginPlay 到第一次推理完成的耗时 (毫秒，包括会话创建)，尚未完成推理时为负
+	UFUNCTION(BlueprintPure, Category = "Cloth Deformer|Performance")
+	float GetFirstInferenceLatencyMs() const { return FirstInferenceLatencyMs; }
+
 	// --- Debug / Testing ---
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Cloth Deformer|Debug")
 	TArray<float> TestInputArray;
@@ -81,7 +173,9 @@ public:
 	
 
 private:
-	void UpdateMesh(USkeletalMeshComponent* targetMesh, const TArray<FVector>& HighResOffsets);
+	// 把低模偏移拷入交接缓冲交给渲染线程，在那里映射并直接写入 GPU 上传缓冲。
+	// bAllowBatchedMapping 为 false 时 (子系统本帧已 Tick) 不进子系统的批量映射队列，直接逐组件提交
+	void UpdateMesh(USkeletalMeshComponent* targetMesh, TConstArrayView<float> LowResOffsets, bool bAllowBatchedMapping);
 	
 	bool bIsInitialized{false};
 	// 执行实际推理的模型的运行时实例。
@@ -89,11 +183,81 @@ private:
 
 	TUniquePtr<FInputAdapterBase> InputAdapter;
 
-	TArray<float> CurrentHiddenState;
-	const int32 HiddenLayerSize = 256;
+	// 初始化时把模型输入输出绑定到适配器槽位，Tick 中只按索引取数据。有无法提供的输入时返回 false
+	bool BindModelSlots();
+
+	friend struct FClothInferenceCompleteTickFunction;
+
+	// 以当前的适配器输入发起后台推理
+	void LaunchAsyncInference();
+	// 等待进行中的后台推理并应用其结果，没有进行中的推理时直接返回。
+	// bAfterSubsystemTick 为 true 表示在 TG_PostUpdateWork 中调用，此时子系统本帧已 Tick
+	void CompleteAsyncInference(bool bAfterSubsystemTick = false);
+	// 只等待进行中的后台推理结束，不应用结果 (销毁模型实例前调用)
+	void WaitForAsyncInference();
+
+	// 进行中的后台推理，以及它使用的输入视图 (任务结束前适配器输入与 ModelOutputs 不得改动)
+	UE::Tasks::FTask InferenceTask;
+	TArray<TConstArrayView<float>, TInlineAllocator<8>> AsyncModelInputs;
+	bool bAsyncInferenceSucceeded{false};
+
+	FClothInferenceCompleteTickFunction InferenceCompleteTick;
+
+	// 按模型输入顺序收集本帧的输入视图，循环状态槽位为空视图
+	void GatherModelInputs(TArray<TConstArrayView<float>, TInlineAllocator<8>>& OutInputs) const;
+
+	// 推理完成后取出低模偏移并提交映射
+	void ApplyModelOutputs(bool bAllowBatchedMapping = true);
+
+	// BeginPlay 的时间戳与第一次推理的延迟
+	double BeginPlaySeconds{0.0};
+	float FirstInferenceLatencyMs{-1.0f};
+
+	// 第 i 个模型输入来自哪个适配器槽位，INDEX_NONE 表示循环状态 (由模型实例持有)
+	TArray<int32> ModelInputSources;
+	int32 OffsetOutputSlot{INDEX_NONE};
+
+	// 每帧复用的适配器输入与模型输出 (输出通过 IoBinding 绑定，不得重新分配或移走)
+	TArray<TArray<float>> AdapterInputs;
+	// 适配器各槽位直接写入的模型实例持久输入缓冲，bAdapterWritesModelBuffers 为 false 时改用 AdapterInputs
+	TArray<TArrayView<float>> AdapterInputViews;
+	bool bAdapterWritesModelBuffers{false};
+	TArray<TArray<float>> ModelOutputs;
+
+	// 交给渲染线程的低模偏移：几块持久缓冲轮流使用，渲染命令用完后归还，稳态下不再分配。
+	// 游戏线程最多领先渲染线程一帧，三块足够；渲染线程落后更多时丢弃该帧结果，下一帧的结果会覆盖它
+	struct FLowResHandoffSlot
+	{
+		TArray<float> Offsets;
+		std::atomic<bool> bInFlight{false};
+	};
+	static constexpr int32 NumLowResHandoffSlots = 3;
+	FLowResHandoffSlot LowResHandoffSlots[NumLowResHandoffSlots];
+	int32 NextLowResHandoffSlot{0};
+	// 交接缓冲重新分配的次数 (比较拷贝前后的缓冲地址)
+	int64 HandoffAllocationCount{0};
+
+	// 取下一块空闲的交接缓冲并拷入低模偏移，返回其索引；仍被渲染线程占用时返回 INDEX_NONE
+	int32 AcquireLowResHandoff(TConstArrayView<float> LowResOffsets);
+	// 渲染线程用完交接缓冲后归还
+	void ReleaseLowResHandoff(int32 HandoffSlot) { LowResHandoffSlots[HandoffSlot].bInFlight.store(false, std::memory_order_release); }
+
+	// 低模列重排的复用缓冲 (仅在渲染线程访问)
+	TArray<float> PermutedLowResOffsets;
+
+	// 增量映射状态 (仅在渲染线程访问)
+	TArray<FVector3f> IncrementalHighResOffsets;
+	TArray<float> AppliedLowResOffsets;
+	TBitArray<> IncrementalRowScratch;
+	std::atomic<int32> LastMappedRowCount{0};
 
 private:
+	// 按需 (重新) 创建 OffsetBuffer 并以 WriteOnly 锁定，返回可直接写入的高模偏移内存
+	FVector3f* LockOffsetBuffer_RenderThread(FRHICommandListImmediate& RHICmdList, int32 NumVertices);
+
 	FBufferRHIRef OffsetBuffer; //Buffer
 
+	FRenderCommandFence ReleaseFence;
+
 	FShaderResourceViewRHIRef OffsetBufferSRV; //BufferView
 };
\ No newline at end of file
@@ -0,0 +1,89 @@
+// ClothDeformerSettings.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "ClothDeformerSettings.generated.h"
+
+// ONNX Runtime 工作线程的优先级 (对应 EThreadPriority)
+UENUM()
+enum class EClothOrtThreadPriority : uint8
+{
+	Normal,
+	BelowNormal,
+	Lowest,
+	AboveNormal,
+};
+
+/**
+ * UClothDeformerSettings
+ * 项目设置 -> 插件 -> Cloth Deformer。
+ * 控制 ONNX Runtime 的线程：全局线程池 (所有会话共享) 或逐会话线程池的线程数、自旋，
+ * 以及是否通过 UE 的 FRunnableThread 创建工作线程，使其带有名字、优先级和亲和性并出现在 Insights 中。
+ * 全局线程池、线程创建方式与 ORT 内存设置在第一次创建 Env 时读取，修改后需重启；逐会话设置在创建会话时读取
+ */
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "Cloth Deformer"))
+class CLOTH_API UClothDeformerSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+
+	// 所有会话共享一组 ORT 线程池，而不是每个会话各建一组。开启后资产上的线程数覆盖不再生效
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Global Pools", meta = (ConfigRestartRequired = true))
+	bool bUseGlobalThreadPools{true};
+
+	// 全局 intra-op 线程数 (包括调用 Run 的线程)，0 表示由 ORT 按物理核数决定
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Global Pools", meta = (ClampMin = "0", EditCondition = "bUseGlobalThreadPools", ConfigRestartRequired = true))
+	int32 GlobalIntraOpThreads{1};
+
+	// 全局 inter-op 线程数，只在并行执行模式下使用，0 表示由 ORT 决定
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Global Pools", meta = (ClampMin = "0", EditCondition = "bUseGlobalThreadPools", ConfigRestartRequired = true))
+	int32 GlobalInterOpThreads{1};
+
+	// 全局线程池的工作线程空闲时是否自旋等待。关闭可避免与渲染线程和任务图线程抢占 CPU，代价是唤醒延迟
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Global Pools", meta = (EditCondition = "bUseGlobalThreadPools", ConfigRestartRequired = true))
+	bool bGlobalAllowSpinning{false};
+
+	// 未使用全局线程池、且资产没有覆盖时的逐会话 intra-op 线程数，0 表示由 ORT 决定
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Per Session", meta = (ClampMin = "0"))
+	int32 DefaultIntraOpThreads{1};
+
+	// 逐会话 inter-op 线程数，大于 1 时会话以并行模式执行相互独立的节点
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Per Session", meta = (ClampMin = "0"))
+	int32 DefaultInterOpThreads{1};
+
+	// 逐会话线程池是否自旋等待
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Per Session")
+	bool bDefaultAllowSpinning{false};
+
+	// 通过 FRunnableThread 创建 ORT 工作线程 (名为 OnnxWorker_N)，否则由 ORT 自己创建，UE 无法感知
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Worker Threads", meta = (ConfigRestartRequired = true))
+	bool bCreateWorkerThreadsThroughUE{true};
+
+	// UE 创建的 ORT 工作线程优先级
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Worker Threads", meta = (EditCondition = "bCreateWorkerThreadsThroughUE", ConfigRestartRequired = true))
+	EClothOrtThreadPriority WorkerThreadPriority{EClothOrtThreadPriority::BelowNormal};
+
+	// 把 ORT_ENABLE_ALL 优化后的模型以 ORT 格式缓存到 Saved/ClothDeformer/OptimizedModels，
+	// 之后创建会话时直接加载，跳过解析与图优化。缓存按模型 CRC、平台与 ORT 版本区分
+	UPROPERTY(Config, EditAnywhere, Category = "Optimized Model Cache")
+	bool bCacheOptimizedModels{true};
+
+	// UE 创建的 ORT 工作线程亲和性掩码，0 表示使用任务图后台线程的亲和性
+	UPROPERTY(Config, EditAnywhere, Category = "Threading|Worker Threads", meta = (EditCondition = "bCreateWorkerThreadsThroughUE", ConfigRestartRequired = true))
+	int64 WorkerThreadAffinityMask{0};
+
+	// ORT 的 CPU 分配经 FMemory 完成 (所有会话共享一个分配器，代替各自的 arena)，内存计入 ClothDeformer 的 LLM 标签。
+	// 设置了 OrtMemoryBudgetMB 时不生效
+	UPROPERTY(Config, EditAnywhere, Category = "Memory", meta = (EditCondition = "OrtMemoryBudgetMB == 0", ConfigRestartRequired = true))
+	bool bRouteOrtAllocationsThroughUE{true};
+
+	// ORT 的 CPU 内存上限 (MB)，0 表示不限制。不为 0 时所有会话共享一个以 OrtArenaCfg max_mem 限额的 ORT arena，
+	// 超出时会话创建或推理以 ORT 错误失败。arena 的增长每帧采样一次，计入 stat ClothDeformer 的 ORT Allocated
+	// 与 LLM 的 ClothDeformer/OrtArena (需要 ONNX Runtime 1.23 的分配器统计，更早的版本不报告)
+	UPROPERTY(Config, EditAnywhere, Category = "Memory", meta = (ClampMin = "0", ConfigRestartRequired = true))
+	int32 OrtMemoryBudgetMB{0};
+};
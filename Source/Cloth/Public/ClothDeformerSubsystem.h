@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "OnnxBatchRunner.h"
+#include "ClothDeformerSubsystem.generated.h"
+
+class UClothDeformerComponent;
+class UClothDeformationModelAsset;
+class UMeshMappingAsset;
+
+/**
+ * UClothDeformerSubsystem
+ * 汇总同一帧内所有 UClothDeformerComponent 的逐帧工作，并按它们共享的资产批量执行。
+ * 推理：共享同一 UClothDeformationModelAsset 的组件沿 batch 维打包为一次 Run (FOnnxBatchRunner)，结果再交给映射。
+ * 映射：共享同一 UMeshMappingAsset 的组件在一条渲染命令中通过 ApplyMappingBatched 一次完成，
+ * 映射矩阵只流过缓存一次。
+ * 作为 Tickable 对象，它在 TG_PostPhysics 之后、TG_PostUpdateWork 之前执行，默认 Tick 组的组件已在此之前 Tick 完毕。
+ * 在 TG_PostUpdateWork 中取回的结果 (AsyncSameFrame) 赶不上本帧的队列，组件直接逐个提交映射，不经过子系统。
+ */
+UCLASS()
+class CLOTH_API UClothDeformerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// 登记组件本帧的推理 (输入已由组件写入其适配器缓冲)，在本帧 Tick 时与同一模型资产的组件合并执行
+	void QueueInference(UClothDeformerComponent* Component);
+
+	// 登记组件本帧的低模偏移 (已拷入组件的第 HandoffSlot 块交接缓冲，长度已按 MappingAsset 校验)，在本帧 Tick 时统一映射。
+	// 映射使用登记时校验过的 MappingAsset，之后组件换用其他资产也不影响本帧
+	void QueueMapping(UClothDeformerComponent* Component, UMeshMappingAsset* MappingAsset, int32 HandoffSlot);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	virtual void Deinitialize() override;
+
+private:
+	// 按模型资产分组，每组一次批量推理；只有一个组件或打包失败时逐个运行
+	void FlushPendingInferences();
+
+	TArray<TWeakObjectPtr<UClothDeformerComponent>> PendingInferences;
+
+	// 每个模型资产一份打包缓冲，在帧间复用
+	TMap<TObjectKey<UClothDeformationModelAsset>, TUniquePtr<FOnnxBatchRunner>> BatchRunners;
+
+	// 按映射资产分组，每组提交一条渲染命令
+	void FlushPendingMappings();
+
+	struct FPendingMapping
+	{
+		TWeakObjectPtr<UClothDeformerComponent> Component;
+		TWeakObjectPtr<UMeshMappingAsset> MappingAsset;
+		int32 HandoffSlot{INDEX_NONE};
+	};
+	TArray<FPendingMapping> PendingMappings;
+};
@@ -0,0 +1,70 @@
+// ClothGeneratedEvaluator.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNativeClothModel;
+
+/**
+ * IClothGeneratedEvaluator
+ * 由 UClothDeformationModelAsset::GenerateNativeEvaluator 为某一份模型数据生成的专用求值器。
+ * 层的尺寸在生成时固定为常量、中间结果是定长成员数组；权重不复制进源码，Bind 时从同一份数据导入的 FNativeClothModel 取得。
+ * 每个实例独占一个求值器，可与其他实例并发运行
+ */
+class CLOTH_API IClothGeneratedEvaluator
+{
+public:
+	virtual ~IClothGeneratedEvaluator() = default;
+
+	// 取得权重指针，模型与生成时的结构不一致时返回 false
+	virtual bool Bind(const FNativeClothModel& Model) = 0;
+
+	// 生成时固定的各输入、输出元素数，输入尺寸不符时调用方应改用解释执行
+	virtual TConstArrayView<int64> GetInputSizes() const = 0;
+	virtual TConstArrayView<int64> GetOutputSizes() const = 0;
+
+	/**
+	 * @brief 执行一次推理，输入尺寸必须与 GetInputSizes 一致
+	 * @param Outputs 第 i 项接收第 i 个模型输出，尺寸不变时不重新分配
+	 */
+	virtual void Run(TConstArrayView<TConstArrayView<float>> Inputs, TConstArrayView<TArray<float>*> Outputs) = 0;
+
+protected:
+	// 取第 ValueIndex 个常量的数据并校验元素数
+	static bool BindConstant(const FNativeClothModel& Model, int32 ValueIndex, int64 ExpectedNum, const float*& OutData);
+};
+
+/**
+ * FClothGeneratedEvaluatorRegistry
+ * 按模型数据的 CRC 登记生成的求值器，原生后端创建实例时查询，存在时优先于解释执行。
+ * 生成的源文件通过 CLOTH_REGISTER_GENERATED_EVALUATOR 在模块加载时自动登记
+ */
+class CLOTH_API FClothGeneratedEvaluatorRegistry
+{
+public:
+	using FFactory = TUniquePtr<IClothGeneratedEvaluator> (*)();
+
+	static FClothGeneratedEvaluatorRegistry& Get();
+
+	void Register(uint32 ModelCrc, FFactory Factory);
+
+	// 没有为该模型数据生成求值器时返回空指针
+	TUniquePtr<IClothGeneratedEvaluator> Create(uint32 ModelCrc) const;
+
+private:
+	mutable FCriticalSection Mutex;
+	TMap<uint32, FFactory> Factories;
+};
+
+// 静态对象构造时登记，供生成的源文件使用
+struct FClothGeneratedEvaluatorRegistrar
+{
+	FClothGeneratedEvaluatorRegistrar(uint32 ModelCrc, FClothGeneratedEvaluatorRegistry::FFactory Factory)
+	{
+		FClothGeneratedEvaluatorRegistry::Get().Register(ModelCrc, Factory);
+	}
+};
+
+#define CLOTH_REGISTER_GENERATED_EVALUATOR(ModelCrc, EvaluatorType) \
+	static FClothGeneratedEvaluatorRegistrar GRegistrar_##EvaluatorType(ModelCrc, []() -> TUniquePtr<IClothGeneratedEvaluator> { return MakeUnique<EvaluatorType>(); })
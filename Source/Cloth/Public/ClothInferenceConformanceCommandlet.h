@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClothInferenceConformanceCommandlet.generated.h"
+
+/**
+ * UClothInferenceConformanceCommandlet
+ * 原生推理后端的一致性检查与基准测试，不依赖 RHI，可在构建机上无头运行：
+ *   UnrealEditor-Cmd <Project>.uproject -run=ClothInferenceConformance -nullrhi -Model=/Game/Path/Asset [-Sequences=8] [-Steps=16] [-Iterations=200] [-Tolerance=1e-4] [-Seed=1]
+ * 用固定种子生成的输入逐帧运行模型 (循环状态在帧间传递)，把原生后端每帧的输出与循环状态和 ONNX Runtime 对比，并输出两者每帧的耗时。
+ * 模型有生成的求值器 (GenerateNativeEvaluator) 时，它的输出同样逐帧与解释执行对比，并一起计时。
+ * 没有 ONNX Runtime 的平台只检查原生后端能否导入并稳定运行。任一输出超出容差时返回非 0
+ */
+UCLASS()
+class UClothInferenceConformanceCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UClothInferenceConformanceCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ClothMappingBenchmarkCommandlet.generated.h"
+
+/**
+ * UClothMappingBenchmarkCommandlet
+ * 映射内核的基准测试与一致性检查，不依赖 RHI，可在构建机上无头运行：
+ *   UnrealEditor-Cmd <Project>.uproject -run=ClothMappingBenchmark -nullrhi [-Rows=10000,50000,250000] [-Iterations=20] [-Seed=1]
+ * 用合成的 KNN / 重心坐标矩阵把每种内核与双精度参考路径对比，输出 ns/row、GB/s 和相对参考路径的加速比。
+ * 任一内核结果超出容差时返回非 0，便于逐提交跟踪回归
+ */
+UCLASS()
+class UClothMappingBenchmarkCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UClothMappingBenchmarkCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -12,5 +12,15 @@ public:
 
 	virtual TMap<FString, TArray<float>> ExtractInputs(float deltaTime) = 0;
 
+	// 适配器产出的输入名称，顺序即槽位索引。组件初始化时据此把模型输入绑定到槽位
+	virtual const TArray<FString>& GetInputNames() const = 0;
+
+	// 按槽位写入本帧输入 (OutInputs[i] 对应 GetInputNames()[i])，数组在调用间复用，不再每帧构建 TMap 与 FString
+	virtual bool ExtractInputs(float deltaTime, TArrayView<TArray<float>> OutInputs) = 0;
+
+	// 按槽位把本帧输入直接写入调用方提供的定长缓冲 (如模型实例的持久输入张量)，省去一次复制。
+	// 空视图表示该槽位不需要；缓冲尺寸与适配器产出不一致时返回 false
+	virtual bool WriteInputs(float deltaTime, TConstArrayView<TArrayView<float>> OutInputs) = 0;
+
 	virtual void Reset() = 0;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "RenderCommandFence.h"
 #include "SparseMappingMatrix.h" // 包含我们核心的数据结构
 #include "MeshMappingAsset.generated.h"
 
@@ -29,4 +30,20 @@ public:
      */
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Mapping Data")
     FSparseMappingMatrix MappingData{};
+
+    virtual void PostLoad() override;
+    // 映射矩阵的内存计入 ClothDeformer/Mapping 的 LLM 标签
+    virtual void Serialize(FArchive& Ar) override;
+
+    // 渲染命令直接引用 MappingData，销毁前等待已提交的命令执行完
+    virtual void BeginDestroy() override;
+    virtual bool IsReadyForFinishDestroy() override;
+
+#if WITH_EDITOR
+    // 撤销/重做等会原地改写 MappingData，改写前先让渲染线程用完旧数据
+    virtual void PreEditChange(FProperty* PropertyAboutToChange) override;
+#endif
+
+private:
+    FRenderCommandFence ReleaseFence;
 };
\ No newline at end of file
@@ -0,0 +1,136 @@
+// NativeClothModel.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <vector>
+
+/**
+ * FNativeTensorInfo
+ * 模型输入或输出的签名：名字、ONNX 元素类型 (TensorProto.DataType，1 = float) 与形状 (-1 为动态维度)
+ */
+struct FNativeTensorInfo
+{
+	FString Name;
+	int32 ElementType{0};
+	TArray<int64> Shape;
+	// 每个维度的符号名 (dim_param)，静态维度与匿名动态维度为空
+	TArray<FString> SymbolicDims;
+};
+
+/**
+ * FNativeClothRunContext
+ * 一次推理的中间结果与临时缓冲，属于调用方 (每个模型实例一份)，在调用间复用，尺寸不变时不重新分配
+ */
+struct FNativeClothRunContext
+{
+	struct FTensor
+	{
+		TArray<int64> Shape;
+		TArray<float> Data;
+	};
+	TArray<FTensor> Values;
+	TArray<float> Scratch[3];
+};
+
+/**
+ * FNativeClothModel
+ * 不依赖 ONNX Runtime 的纯 C++ 推理后端，面向 SnUG 一类由若干全连接层与 GRU 组成的小模型。
+ * 直接解析 ONNX (protobuf) 字节，只支持其中一个子集：Gemm / MatMul (常量权重)、Add / Sub / Mul / Div、
+ * Relu / LeakyRelu / Elu / Tanh / Sigmoid、Identity / Reshape / Flatten / Squeeze / Unsqueeze / Concat / Transpose、
+ * 以及单向的 GRU / LSTM。导入时把权重转置为 [K, N] 的紧凑布局，运行时用 SIMD 的乘加内核计算。
+ * 模型本身只读，可以被多个实例 (多线程) 共享；中间结果保存在调用方的 FNativeClothRunContext 中
+ */
+class CLOTH_API FNativeClothModel
+{
+public:
+	/**
+	 * @brief 获取模型数据对应的共享模型，同一份数据 (按 CRC) 只导入一次
+	 * @return 包含不支持的算子或数据格式时返回空指针，原因写入 OutError
+	 */
+	static TSharedPtr<const FNativeClothModel, ESPMode::ThreadSafe> Acquire(const TArray<uint8>& ModelData, FString& OutError);
+
+	// 只读取图的输入输出签名，不导入权重 (用于解析资产元数据)
+	static bool ReadGraphSignature(const TArray<uint8>& ModelData, TArray<FNativeTensorInfo>& OutInputs, TArray<FNativeTensorInfo>& OutOutputs, FString& OutError);
+
+	const TArray<FNativeTensorInfo>& GetInputs() const { return Inputs; }
+	const TArray<FNativeTensorInfo>& GetOutputs() const { return Outputs; }
+
+	// 模型数据的 CRC，同时是生成求值器的登记键
+	uint32 GetDataCrc() const { return DataCrc; }
+
+	// 第 ValueIndex 个值为常量时返回其数据 (导入后的布局)，否则为空
+	TConstArrayView<float> GetConstantData(int32 ValueIndex) const
+	{
+		return IsConstant.IsValidIndex(ValueIndex) && IsConstant[ValueIndex] ? TConstArrayView<float>(Constants[ValueIndex].Data) : TConstArrayView<float>();
+	}
+
+	/**
+	 * @brief 执行一次推理
+	 * @param InputData 第 i 项对应第 i 个模型输入
+	 * @param InputShapes 第 i 个输入已确定的形状 (动态维度已解析)
+	 * @param OutputData 第 i 项接收第 i 个模型输出，数组在调用间复用
+	 */
+	bool Run(FNativeClothRunContext& Context, TConstArrayView<TConstArrayView<float>> InputData, TConstArrayView<std::vector<int64_t>> InputShapes, TConstArrayView<TArray<float>*> OutputData) const;
+
+#if WITH_EDITOR
+	/**
+	 * @brief 按固定的输入形状生成该模型专用的 IClothGeneratedEvaluator 源文件 (见 ClothGeneratedEvaluator.h)
+	 * 先以这些形状运行一次得到每个中间结果的形状，再把各算子展开为常量尺寸的内核调用。
+	 * 逐元素二元运算只支持形状相同、一侧为标量或按行广播的情形
+	 * @param ClassName 生成的类名，必须是合法的 C++ 标识符
+	 * @param InputShapes 第 i 个输入的形状，不能有动态维度
+	 */
+	bool GenerateEvaluatorSource(const FString& ClassName, TConstArrayView<TArray<int64>> InputShapes, FString& OutSource, FString& OutError) const;
+#endif
+
+	// 导入后的算子
+	enum class EOp : uint8
+	{
+		Gemm, MatMul,
+		Add, Sub, Mul, Div,
+		Relu, LeakyRelu, Elu, Tanh, Sigmoid,
+		Identity, Reshape, Flatten, Squeeze, Unsqueeze, Concat, Transpose,
+		GRU, LSTM,
+	};
+
+	struct FNode
+	{
+		EOp Op{EOp::Identity};
+		// 值表中的索引，INDEX_NONE 表示省略的可选输入/输出
+		TArray<int32> Inputs;
+		TArray<int32> Outputs;
+		float Alpha{1.0f};
+		float Beta{1.0f};
+		int64 Axis{0};
+		// Reshape 的目标形状、Squeeze/Unsqueeze 的轴、Transpose 的排列
+		TArray<int64> Ints;
+		int32 HiddenSize{0};
+		bool bLinearBeforeReset{false};
+	};
+
+private:
+	friend class FNativeClothModelImporter;
+	friend class FNativeClothCodeGenerator;
+
+	uint32 DataCrc{0};
+
+	TArray<FNativeTensorInfo> Inputs;
+	TArray<FNativeTensorInfo> Outputs;
+	TArray<int32> InputValues;
+	TArray<int32> OutputValues;
+	TArray<FNode> Nodes;
+
+	// 值表：常量 (权重) 直接保存在模型中，其余的在 FNativeClothRunContext::Values 中
+	int32 NumValues{0};
+	TArray<FNativeClothRunContext::FTensor> Constants;
+	TBitArray<> IsConstant;
+
+	const FNativeClothRunContext::FTensor& GetValue(const FNativeClothRunContext& Context, int32 ValueIndex) const
+	{
+		return IsConstant[ValueIndex] ? Constants[ValueIndex] : Context.Values[ValueIndex];
+	}
+
+	bool RunNode(const FNode& Node, FNativeClothRunContext& Context) const;
+	bool RunRecurrent(const FNode& Node, FNativeClothRunContext& Context) const;
+};
@@ -0,0 +1,60 @@
+// OnnxBatchRunner.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 包含ONNX Runtime的实现头文件
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include "onnxruntime_cxx_api.h"
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+#include <vector>
+
+class FOnnxModelInstance;
+
+/**
+ * FOnnxBatchItem
+ * 批量推理中的一个角色：它的模型实例 (提供循环状态)、按槽位排列的输入，以及接收结果的输出数组
+ */
+struct FOnnxBatchItem
+{
+	FOnnxModelInstance* Instance{nullptr};
+	// 第 i 项对应第 i 个模型输入，循环状态槽位忽略 (由 Instance 提供)
+	TConstArrayView<TConstArrayView<float>> Inputs;
+	// 第 i 项接收第 i 个模型输出，循环状态槽位忽略 (写回 Instance)
+	TArrayView<TArray<float>> Outputs;
+};
+
+/**
+ * FOnnxBatchRunner
+ * 把共享同一会话的多个 FOnnxModelInstance 沿第 0 维 (batch) 打包为一次 Run：
+ * 各角色的输入与循环状态拼接进持久的打包缓冲，推理一次后把输出和新状态拆回各自的实例。
+ * 几十个角色的小 Run 调度开销因此合并为一次大矩阵运算。打包缓冲在调用间复用，角色数不变时不重新分配
+ */
+class CLOTH_API FOnnxBatchRunner
+{
+public:
+	// 模型的所有输入输出都只有第 0 维是动态维度时才能沿 batch 打包 (原生后端的实例逐个运行)
+	static bool SupportsBatching(const FOnnxModelInstance& Instance);
+
+	/**
+	 * @brief 打包执行一次推理并拆回结果
+	 * 所有 Items 必须来自同一共享会话；失败时各实例的输出与循环状态保持不变，调用方可以回退为逐个运行
+	 */
+	bool Run(TConstArrayView<FOnnxBatchItem> Items);
+
+private:
+	// 每个模型输入/输出一块打包缓冲与对应的形状
+	TArray<TArray<float>> packedInputs_;
+	TArray<TArray<float>> packedOutputs_;
+	std::vector<std::vector<int64_t>> inputShapes_;
+	std::vector<std::vector<int64_t>> outputShapes_;
+#if WITH_CLOTH_ORT
+	std::vector<Ort::Value> inputTensors_;
+	std::vector<Ort::Value> outputTensors_;
+#endif
+};
@@ -12,27 +12,75 @@
 #if PLATFORM_WINDOWS && PLATFORM_64BITS
 #include "Windows/HideWindowsPlatformTypes.h"
 #endif
+#include <vector>
+#include "NativeClothModel.h"
+
 // Forward-declare our asset class
 class UClothDeformationModelAsset;
+class IClothGeneratedEvaluator;
+struct FOnnxSharedSession;
+enum class EClothModelPrecision : uint8;
+enum class EClothInferenceBackend : uint8;
+
+/**
+ * FOnnxTensorSlot
+ * 一个模型输入或输出在构造时解析好的元数据，Run 时按槽位索引直接使用，不再每帧查询会话
+ */
+struct FOnnxTensorSlot
+{
+	FString Name;
+	// 传给 ONNX Runtime 的以 0 结尾的节点名，生命周期与实例相同
+	TArray<ANSICHAR> NameUtf8;
+	ONNXTensorElementDataType ElementType{ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED};
+	// 模型声明的形状，<= 0 表示动态维度
+	std::vector<int64_t> Shape;
+	// 静态维度的乘积
+	int64 StaticElementCount{1};
+	// 第一个动态维度的位置，INDEX_NONE 表示形状完全静态
+	int32 DynamicDimIndex{INDEX_NONE};
+	// 动态维度的个数
+	int32 NumDynamicDims{0};
+	// 每个维度对应的符号维度 (模型中的 dim_param) 在实例符号表中的索引，静态维度与匿名动态维度为 INDEX_NONE
+	TArray<int32> DimSymbols;
+	// 所属循环状态配对的索引，INDEX_NONE 表示普通输入/输出
+	int32 RecurrentPair{INDEX_NONE};
+};
 
 /**
  * FOnnxModelInstance
  * 一个非UObject的C++类，用于封装ONNX Runtime会话。
- * 这是核心逻辑层，负责创建Ort::Session、管理其生命周期并执行推理。它由UClothDeformationModelAsset创建。
+ * 这是核心逻辑层，从 FOnnxSessionRegistry 获取共享的 Ort::Session 并执行推理。它由UClothDeformationModelAsset创建。
+ * 会话由同一资产的所有实例共享，IoBinding、循环状态与输入输出缓冲等逐组件状态都保存在实例中，因此不同实例可以并发 Run。
+ * 资产选择 Native 后端 (或没有 ONNX Runtime 的平台) 时改由 FNativeClothModel 执行，槽位、符号维度与循环状态的接口不变。
  */
 class CLOTH_API FOnnxModelInstance
 {
 public:
-	// 构造函数：从给定的资产创建实例。
+	// 构造函数：从给定的资产创建实例，使用资产的运行时精度变体。
 	FOnnxModelInstance(UClothDeformationModelAsset* InModelAsset);
 
-	// 析构函数：清理Ort::Session和Ort::Env。
+	// 使用资产的指定精度变体创建实例 (如验证变体精度时)
+	FOnnxModelInstance(UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision);
+
+	// 使用指定的推理后端创建实例 (如比较两个后端的输出时)
+	FOnnxModelInstance(UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision, EClothInferenceBackend InBackend);
+
+	// 析构函数：释放对共享会话的引用。
 	~FOnnxModelInstance();
 
 	
 	// 检查底层的Ort::Session是否已成功初始化。
 	bool IsInitialized() const;
 
+	// 是否由原生后端执行推理
+	bool IsNative() const { return nativeModel_.IsValid(); }
+
+	// 原生后端是否有为该模型数据生成的求值器 (见 UClothDeformationModelAsset::GenerateNativeEvaluator)
+	bool HasGeneratedEvaluator() const { return generatedEvaluator_.IsValid(); }
+
+	// 是否在输入尺寸与生成时一致时使用生成的求值器，默认开启；关闭后始终解释执行 (如比较两者时)
+	void SetUseGeneratedEvaluator(bool bEnabled) { bUseGeneratedEvaluator_ = bEnabled; }
+
 	// 对提供的输入数据运行推理。
 	// 注意：为简单起见，此示例假定单个浮点张量输入/输出。
 	// 在实际使用中，您需要将其扩展以使其更通用。
@@ -40,51 +88,251 @@ public:
 
 	bool Run(const TMap<FString, TArray<float>>& Inputs, TArray<float>& HiddenState, TMap<FString, TArray<float>>& Outputs);
 
+	/**
+	 * @brief 按预先解析好的槽位运行推理，不做任何名字查找
+	 * @param Inputs 第 i 项对应第 i 个模型输入 (GetInputSlots 的顺序)
+	 * @param Outputs 第 i 项接收第 i 个模型输出，数组在调用间复用
+	 */
+	bool Run(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs);
+
+	/**
+	 * @brief IoBinding 路径：输出直接写入调用方持有的持久缓冲，稳态下推理路径不做任何堆分配
+	 * 输入/输出缓冲的地址与尺寸不变时沿用已有绑定，变化时重新绑定。
+	 * 静态形状的输出在第一次运行前按形状分配；动态形状的输出第一次由 ORT 分配以得到形状，之后改为绑定到 Outputs
+	 * 循环状态由实例自己持有并在两套绑定间轮换，对应槽位的 Inputs/Outputs 会被忽略
+	 * @param Inputs 第 i 项对应第 i 个模型输入，调用方应在帧间保持其地址不变
+	 * @param Outputs 第 i 项接收第 i 个模型输出，调用方不得在帧间重新分配或移走这些数组
+	 */
+	bool RunWithBinding(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs);
+
+	/**
+	 * @brief 第 InputSlot 个输入的持久缓冲 (64 字节对齐)，输入适配器可以直接写入。
+	 * RunWithBinding 收到指向它的视图时，张量只在第一次运行时包装与绑定，之后每帧都沿用
+	 * 尺寸按模型形状与当前的符号绑定确定；仍有未绑定的动态维度或是循环状态槽位时返回空视图。符号绑定变化后需要重新获取
+	 */
+	TArrayView<float> GetInputBuffer(int32 InputSlot);
+
+	/**
+	 * RunWithBinding 中实际测得的堆分配次数，稳态下应保持不变。
+	 * 每次推理前后比较两项：进程内经 FOrtUEAllocator 的 ORT 分配次数 (含 intra-op 工作线程；ORT 未使用 UE 分配器时这部分不可见，
+	 * 同一时段其他实例在异步任务中的推理也会计入，因此只在没有并发推理时精确)，
+	 * 以及输出、持久输入、float16 转换、循环状态与原生后端中间结果各缓冲的地址和容量 (任一变化计一次)
+	 */
+	uint64 GetAllocationCount() const { return allocationCount_; }
+
+	// 循环状态配对数，以及第 PairIndex 对下一帧将要读取的状态 (即最近一次写出的结果)
+	int32 GetNumRecurrentStates() const { return recurrentStates_.Num(); }
+	TConstArrayView<float> GetRecurrentState(int32 PairIndex) const;
+
+	// 把所有循环状态清零 (如角色瞬移后)，不重新分配
+	void ResetRecurrentState();
+
+	const TArray<FOnnxTensorSlot>& GetInputSlots() const { return inputSlots_; }
+	const TArray<FOnnxTensorSlot>& GetOutputSlots() const { return outputSlots_; }
+	int32 FindInputSlot(const FString& Name) const;
+	int32 FindOutputSlot(const FString& Name) const;
+
+	// 模型中出现的具名符号维度 (如 batch、seq_len)，同名维度在所有输入输出间共享
+	const TArray<FString>& GetDimSymbols() const { return dimSymbols_; }
+	int32 FindDimSymbol(const FString& Name) const;
+
+	/**
+	 * @brief 为符号维度绑定具体的值，之后所有用到它的输入输出都按该值确定形状
+	 * 每个输入最多留一个未绑定的动态维度，由数据长度推算；有多个时必须先绑定其余的。
+	 * 形状按绑定缓存，值不变时重复调用不会使已缓存的形状与 IoBinding 失效
+	 * @param Value 大于 0 的维度值，INDEX_NONE 表示取消绑定
+	 */
+	bool BindDimSymbol(const FString& Name, int64 Value);
+	void BindDimSymbol(int32 SymbolIndex, int64 Value);
+
+	// 取消所有符号维度的绑定
+	void ResetDimSymbols();
+
+	/**
+	 * @brief 按模型声明的形状推算输入元素个数，动态维度取 1
+	 * 用于第一帧初始化隐藏状态等没有外部数据来源的输入
+	 */
+	int64 GetDefaultElementCount(int32 InputSlot) const;
+
 private:
+	// 批量推理直接使用会话、槽位元数据与循环状态缓冲
+	friend class FOnnxBatchRunner;
 	
 	// 禁用复制以防止TUniquePtr的所有权问题。
 	FOnnxModelInstance(const FOnnxModelInstance&) = delete;
 	FOnnxModelInstance& operator=(const FOnnxModelInstance&) = delete;
 	
-	// ONNX运行时环境。
-	TUniquePtr<Ort::Env> env_{nullptr};
+#if WITH_CLOTH_ORT
+	// 同一资产的所有实例共享的会话 (Env 由 FOnnxSessionRegistry 持有)，持有它即持有一份引用
+	TSharedPtr<FOnnxSharedSession, ESPMode::ThreadSafe> sharedSession_;
+#endif
+
+	// ONNX运行时会话，代表加载的模型，指向 sharedSession_ 中的会话。原生后端时为空
+	Ort::Session* session_{nullptr};
+
+	// 原生后端：同一模型数据共享的只读模型，以及本实例的中间结果
+	TSharedPtr<const FNativeClothModel, ESPMode::ThreadSafe> nativeModel_;
+	FNativeClothRunContext nativeContext_;
+	TArray<TConstArrayView<float>> nativeInputs_;
+	TArray<TArray<float>*> nativeOutputs_;
+	// 按模型数据 CRC 找到的生成求值器，没有时为空
+	TUniquePtr<IClothGeneratedEvaluator> generatedEvaluator_;
+	bool bUseGeneratedEvaluator_{true};
 
-	// ONNX运行时会话，代表加载的模型。
-	TUniquePtr<Ort::Session> session_{nullptr};
+	// 构造时缓存的模型输入输出元数据，以便快速访问。
+	TArray<FOnnxTensorSlot> inputSlots_;
+	TArray<FOnnxTensorSlot> outputSlots_;
+	std::vector<const char*> inputNames_;
+	std::vector<const char*> outputNames_;
 
-	// 从资产中缓存的模型元数据，以便快速访问。
-	FString inputNodeName_;
-	FString outputNodeName_;
-	TArray<int64> inputNodeDims_; // Changed to TArray<int64> for UE types
-	TArray<int64> outputNodeDims_; // Store output dims if needed for future validation or reshaping
+	// Run 之间复用的张量与形状缓冲，避免每帧分配
+#if WITH_CLOTH_ORT
+	Ort::MemoryInfo memoryInfo_{nullptr};
+	std::vector<Ort::Value> inputTensors_;
+#endif
+	std::vector<std::vector<int64_t>> inputShapes_;
+
+	// GetInputBuffer 返回的持久输入缓冲，按槽位索引
+	TArray<TArray<float, TAlignedHeapAllocator<64>>> inputBuffers_;
+
+	// 符号表与当前绑定的值 (INDEX_NONE 为未绑定)，任一值变化时 shapeGeneration_ 递增
+	TArray<FString> dimSymbols_;
+	TArray<int64> dimSymbolValues_;
+	uint32 shapeGeneration_{1};
+
+	// inputShapes_[i] 是按哪个数据长度与哪一代符号绑定算出的，二者都没变时不再计算形状
+	struct FInputShapeKey
+	{
+		int32 Num{INDEX_NONE};
+		uint32 Generation{0};
+	};
+	TArray<FInputShapeKey> inputShapeKeys_;
+
+	// float16 输入输出 (FP16 变体) 的转换缓冲，按槽位索引，float 槽位不使用
+	TArray<TArray<Ort::Float16_t>> halfInputs_;
+	TArray<TArray<Ort::Float16_t>> halfOutputs_;
+
+#if WITH_CLOTH_ORT
+	// IoBinding 路径的持久绑定：记录绑定时的缓冲地址与尺寸，未变化时不再创建张量
+	struct FBoundTensor
+	{
+		// 绑定的内存：float 槽位是调用方的缓冲，float16 槽位是实例的转换缓冲
+		const void* Data{nullptr};
+		int32 Num{0};
+		// 绑定时的符号绑定代数，形状可能随符号变化而数据长度不变
+		uint32 ShapeGeneration{0};
+		Ort::Value Value{nullptr};
+	};
+	Ort::RunOptions runOptions_{nullptr};
+
+	// 一套 IoBinding 及其已绑定的张量
+	struct FBindingSet
+	{
+		TUniquePtr<Ort::IoBinding> Binding;
+		TArray<FBoundTensor> Inputs;
+		TArray<FBoundTensor> Outputs;
+	};
+	// 有循环状态时使用两套绑定：第 k 套从 Buffers[k] 读状态、向 Buffers[1-k] 写状态，每帧轮换，状态不做拷贝
+	FBindingSet bindingSets_[2];
+#endif
+	int32 stateReadIndex_{0};
+
+	// 一对循环状态的两块预分配缓冲
+	struct FRecurrentState
+	{
+		int32 InputSlot{INDEX_NONE};
+		int32 OutputSlot{INDEX_NONE};
+		std::vector<int64_t> Shape;
+		TArray<float> Buffers[2];
+	};
+	TArray<FRecurrentState> recurrentStates_;
+
+	// 按资产声明 (或名字启发式) 建立循环状态配对并分配缓冲
+	void ResolveRecurrentStates(const UClothDeformationModelAsset* InModelAsset);
+#if WITH_CLOTH_ORT
+	// 从共享会话解析槽位并创建 IoBinding
+	bool InitializeOrt(UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision);
+	// 创建绑定集合，并把循环状态缓冲固定绑定进去
+	void CreateBindingSets();
+#endif
+	// 导入原生模型并按其签名建立槽位
+	bool InitializeNative(UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision);
+	// 两个后端共用的初始化收尾：形状缓存、符号表、循环状态
+	void FinishSlotSetup(const UClothDeformationModelAsset* InModelAsset);
+	// 原生后端的推理，bRecurrent 为 true 时循环状态槽位从实例的缓冲读写并轮换
+	bool RunNative(TConstArrayView<TConstArrayView<float>> Inputs, TArrayView<TArray<float>> Outputs, bool bRecurrent);
+	// 输出的实际形状与元素数，动态形状在第一次运行后得到，元素数为 INDEX_NONE 表示尚未知道
+	std::vector<std::vector<int64_t>> outputShapes_;
+	TArray<int64> outputElementCounts_;
+	uint32 outputShapeGeneration_{0};
+	// 按当前符号绑定重新推算输出形状，仍有未知维度的输出留到运行后得到
+	void ResolveOutputShapes();
+
+	// 测量一次推理的堆分配，析构时计入 allocationCount_
+	struct FAllocationProbe
+	{
+		FAllocationProbe(FOnnxModelInstance& InInstance, TConstArrayView<TArray<float>> InOutputs);
+		~FAllocationProbe();
+
+		FOnnxModelInstance& Instance;
+		TConstArrayView<TArray<float>> Outputs;
+		uint64 BufferSignature;
+		uint64 OrtAllocations;
+	};
+	// 推理路径上各持久缓冲的地址与容量签名
+	uint64 GetBufferSignature(TConstArrayView<TArray<float>> Outputs) const;
+	uint64 allocationCount_{0};
 
 	// 用于指示初始化是否成功的标志。
 	bool bIsInitialized_ = false;
 
     // --- Private Helper Functions for Run ---
     /**
-     * @brief Calculates the concrete input dimensions for the ONNX tensor based on model metadata and actual input data size.
+     * @brief Builds a slot from the name, element type, declared shape (<= 0 for dynamic) and symbolic dimension names of one model input/output.
+     * @param InOutDimSymbols The instance's symbol table, new dimension names are appended.
+     */
+    static FOnnxTensorSlot MakeTensorSlot(const FString& InName, ONNXTensorElementDataType InElementType, TConstArrayView<int64> InShape, TConstArrayView<FString> InSymbolicDims, TArray<FString>& InOutDimSymbols);
+
+#if WITH_CLOTH_ORT
+    /**
+     * @brief Reads name, element type, shape and symbolic dimensions of one session input/output into a slot.
+     */
+    static FOnnxTensorSlot MakeTensorSlot(const Ort::AllocatedStringPtr& InName, const Ort::TypeInfo& InTypeInfo, TArray<FString>& InOutDimSymbols);
+#endif
+
+    /**
+     * @brief Calculates the concrete input dimensions from model metadata, bound symbolic dimensions and the actual input data size.
+     * @param InSlot The cached input slot.
      * @param InInputDataSize The actual number of elements in the input data.
-     * @param OutActualDims The calculated dimensions for the ONNX tensor.
+     * @param OutActualDims The calculated dimensions for the ONNX tensor (reused between calls).
      * @return True if dimensions are successfully calculated, false otherwise.
      */
-    bool CalculateInputTensorDimensions(int32 InInputDataSize, std::vector<int64_t>& OutActualDims) const;
+    bool CalculateInputTensorDimensions(const FOnnxTensorSlot& InSlot, int32 InInputDataSize, std::vector<int64_t>& OutActualDims) const;
+
+    /**
+     * @brief Resolves inputShapes_[InputSlot] for the given data size, reusing the cached shape when neither the size nor the symbol bindings changed.
+     */
+    bool ResolveInputShape(int32 InputSlot, int32 InInputDataSize);
 
+#if WITH_CLOTH_ORT
     /**
      * @brief Creates an ONNX Runtime input tensor from the provided data and dimensions.
+     * Float16 inputs are converted into the slot's conversion buffer and the tensor wraps that buffer.
+     * @param InputSlot The model input the tensor is created for.
      * @param InInputData The raw input float array.
      * @param InActualDims The calculated dimensions for the tensor.
      * @param OutInputTensor The created Ort::Value (input tensor).
      * @return True if the tensor is successfully created, false otherwise.
      */
-    bool CreateInputTensor(const TArray<float>& InInputData, const std::vector<int64_t>& InActualDims, Ort::Value& OutInputTensor) const;
+    bool CreateInputTensor(int32 InputSlot, TConstArrayView<float> InInputData, const std::vector<int64_t>& InActualDims, Ort::Value& OutInputTensor);
 
     /**
-     * @brief Extracts data from the ONNX Runtime output tensor into a TArray<float>.
+     * @brief Extracts data from the ONNX Runtime output tensor (float or float16) into a TArray<float>.
      * @param InOutputTensor The Ort::Value (output tensor).
      * @param OutOutputData The TArray<float> to fill with output data.
      * @return True if data is successfully extracted, false otherwise.
      */
     bool ExtractOutputTensorData(Ort::Value& InOutputTensor, TArray<float>& OutOutputData) const;
+#endif
 
 };
\ No newline at end of file
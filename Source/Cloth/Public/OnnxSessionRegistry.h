@@ -0,0 +1,103 @@
+// OnnxSessionRegistry.h
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+// 包含ONNX Runtime的实现头文件
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#endif
+#include "onnxruntime_cxx_api.h"
+#if PLATFORM_WINDOWS && PLATFORM_64BITS
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+// 只有带 ONNX Runtime 的平台 (WITH_CLOTH_ORT) 才有会话注册表，其他平台由原生后端推理
+#if WITH_CLOTH_ORT
+
+// OrtApi::AllocatorGetStats (Ort::Allocator::GetStats) 从 ONNX Runtime 1.23 起提供
+#define CLOTH_ORT_HAS_ALLOCATOR_STATS (ORT_API_VERSION >= 23)
+
+class UClothDeformationModelAsset;
+enum class EClothModelPrecision : uint8;
+
+/**
+ * FOnnxSharedSession
+ * 同一模型资产的所有实例共享的 Ort::Session。
+ * Session::Run 可以被多个线程同时调用，绑定、循环状态与输入输出缓冲等逐组件状态都保存在 FOnnxModelInstance 中，不放在这里
+ */
+struct CLOTH_API FOnnxSharedSession
+{
+	TUniquePtr<Ort::Session> Session;
+
+	// 创建会话时模型数据的 CRC，资产重新导入后不再复用旧会话
+	uint32 ModelDataCrc{0};
+
+	// 创建会话的耗时，以及是否从优化模型缓存加载
+	double CreationSeconds{0.0};
+	bool bLoadedFromOptimizedCache{false};
+};
+
+/**
+ * FOnnxSessionRegistry
+ * 进程内唯一的 Ort::Env，以及按模型资产引用计数的共享会话。
+ * 会话创建耗时与常驻内存因此随资产数而不是角色数增长。
+ * 线程配置来自 UClothDeformerSettings 与资产的 threadingOverrides_，ORT 工作线程可由 UE 创建
+ */
+class CLOTH_API FOnnxSessionRegistry
+{
+public:
+	static FOnnxSessionRegistry& Get();
+
+	// 进程内共享的 ONNX Runtime 环境，第一次使用时创建 (按项目设置决定是否带全局线程池)
+	Ort::Env& GetEnv();
+
+	// 按项目设置与资产覆盖填写会话的线程选项
+	void ApplyThreadingOptions(Ort::SessionOptions& OutOptions, const UClothDeformationModelAsset* InModelAsset) const;
+
+	/**
+	 * @brief 获取资产指定精度变体的共享会话，不存在 (或资产数据已变化) 时创建
+	 * 返回的指针即一份引用，最后一个持有者释放时会话随之销毁
+	 * @return 资产没有模型数据或创建失败时返回空指针
+	 */
+	TSharedPtr<FOnnxSharedSession, ESPMode::ThreadSafe> Acquire(const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision);
+
+	/**
+	 * @brief 资产优化模型缓存的路径 (Saved/ClothDeformer/OptimizedModels 下)
+	 * 文件名包含资产名、精度、模型数据 CRC、平台与 ORT 版本，任一变化都会得到新的缓存
+	 */
+	static FString GetOptimizedModelCachePath(const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision, uint32 ModelDataCrc);
+
+	// 缓存不存在时优化一次模型 (资产的运行时精度) 并写入缓存 (导入模型时调用)，返回缓存是否可用
+	bool WarmOptimizedModelCache(const UClothDeformationModelAsset* InModelAsset);
+
+	// 当前存活的共享会话数
+	int32 GetNumLiveSessions() const;
+
+	// 模块卸载时调用：没有存活会话时释放 Env
+	void Shutdown();
+
+	// 每帧调用一次：采样限额 arena 的 TotalAllocated，发布到 stat (ORT Allocated) 并把变化量计入 LLM 的 ClothDeformer/OrtArena
+	void PublishArenaUsage();
+
+private:
+	// 优先从优化模型缓存创建会话，缓存缺失或失效时优化原始模型并写入缓存
+	TUniquePtr<Ort::Session> CreateSession(Ort::Env& InEnv, const UClothDeformationModelAsset* InModelAsset, EClothModelPrecision InPrecision, uint32 ModelDataCrc, bool& bOutFromCache) const;
+
+	mutable FCriticalSection Mutex;
+	TUniquePtr<Ort::Env> Env;
+	// Env 是否带全局线程池，创建会话时据此关闭逐会话线程池
+	bool bEnvHasGlobalThreadPools{false};
+	// Env 是否注册了共享的 CPU 分配器 (UE 分配器或限额 arena)，创建会话时据此改用它
+	bool bEnvHasSharedAllocator{false};
+	bool bEnvHasCappedArena{false};
+	// 经第一个会话取得的限额 arena (与 Env 中注册的是同一个)，以及上次报告给 stat 与 LLM 的字节数
+	TUniquePtr<Ort::Allocator> ArenaAllocator;
+	int64 ReportedArenaBytes{0};
+	// 按 (资产, 精度) 索引，同一资产的不同精度变体各有一个会话
+	TMap<TPair<TObjectKey<UClothDeformationModelAsset>, EClothModelPrecision>, TWeakPtr<FOnnxSharedSession, ESPMode::ThreadSafe>> Sessions;
+};
+
+#endif // WITH_CLOTH_ORT
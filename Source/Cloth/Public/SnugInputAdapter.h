@@ -17,6 +17,9 @@ public:
     FSnugInputAdapter();
     virtual void Initialize(USkeletalMeshComponent* InSkelMeshComp) override;
     virtual TMap<FString, TArray<float>> ExtractInputs(float DeltaTime) override;
+    virtual const TArray<FString>& GetInputNames() const override { return InputNames; }
+    virtual bool ExtractInputs(float DeltaTime, TArrayView<TArray<float>> OutInputs) override;
+    virtual bool WriteInputs(float DeltaTime, TConstArrayView<TArrayView<float>> OutInputs) override;
     virtual void Reset() override;
 
 private:
@@ -34,6 +37,21 @@ private:
     FVector PreviousRootLocation{ FVector::ZeroVector };
     bool bFirstFrame_{true};
 
+    // 输入槽位，顺序与 InputNames 一致
+    enum EInputSlot : int32
+    {
+        PoseSlot,
+        BetasSlot,
+        TransSlot,
+        NumInputSlots
+    };
+    // 各槽位的元素数: pose 24 * 3, betas 10, trans 3
+    static constexpr int32 InputSizes[NumInputSlots] = { 72, 10, 3 };
+    TArray<FString> InputNames{};
+
+    // 体型参数对应的 Morph Target 名称 (Shape_000 ...)
+    TArray<FName> BetaCurveNames{};
+
     // 模型需要的骨骼名称列表 (顺序必须严格对应 Python 训练时的顺序)
     TArray<FName> TargetBoneNames{};
 };
\ No newline at end of file
@@ -3,6 +3,18 @@
 #include "CoreMinimal.h"
 #include "SparseMappingMatrix.generated.h" // 假设文件名
 
+// 映射矩阵的列索引/权重存储格式
+UENUM(BlueprintType)
+enum class EMappingStorageMode : uint8
+{
+    // int32 列索引 + float 权重
+    Full UMETA(DisplayName = "Full (int32 + float)"),
+    // uint16 列索引 + 16 位归一化权重，要求低模顶点数 <= 65536 且权重在 [0,1]
+    Compact16 UMETA(DisplayName = "Compact (uint16 + unorm16)"),
+    // uint16 列索引 + 8 位归一化权重
+    Compact8 UMETA(DisplayName = "Compact (uint16 + unorm8)"),
+};
+
 struct CLOTH_API FTriplet
 {
     int32 Row{}; // 高模顶点索引
@@ -11,6 +23,38 @@ struct CLOTH_API FTriplet
     FTriplet(int32 InRow, int32 IntCol, float InValue);
 };
 
+// 批量映射中的一个实例：低模偏移 (矩阵列顺序) 与其高模输出
+struct FMappingBatchItem
+{
+    TConstArrayView<float> LowResOffsets;
+    TArrayView<FVector3f> HighResOffsets;
+};
+
+/**
+ * 一段连续行的 CSR 数据，由 BeginRow / AddEntry / EndRow 按行号递增逐行追加
+ * 并行构建时每个任务填充自己的行块，最后由 FSparseMappingMatrix::SetFromRowBlocks 按顺序拼接
+ */
+struct CLOTH_API FSparseRowBlock
+{
+    int32 FirstRow{0};
+    TArray<int32> RowPtr; // 块内行指针，相对本块的非零元 (大小: 块内行数 + 1)
+    TArray<int32> ColIndice;
+    TArray<float> Value;
+
+    explicit FSparseRowBlock(int32 InFirstRow = 0, int32 ReserveRows = 0, int32 ReserveNonZeros = 0);
+
+    // 开始第 Row 行，Row 不得小于已结束的行，中间跳过的行记为空行
+    void BeginRow(int32 Row);
+    void AddEntry(int32 Col, float Weight);
+    void EndRow();
+
+    // 已结束的最后一行之后的行号
+    int32 GetEndRow() const { return FirstRow + RowPtr.Num() - 1; }
+
+private:
+    bool bInRow{false};
+};
+
 USTRUCT(BlueprintType)
 struct CLOTH_API FSparseMappingMatrix
 {
@@ -29,6 +73,43 @@ struct CLOTH_API FSparseMappingMatrix
     UPROPERTY(VisibleAnywhere, Category = "SparseMatrix")
     TArray<float> Value; // 权重值 (大小: NumNonZeros)
 
+    // 定宽 (ELL) 布局的行宽，0 表示普通 CSR。非 0 时 RowPtr[row] == row * FixedRowWidth
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix")
+    int32 FixedRowWidth{0};
+
+    // 转置 (CSC) 索引：第 c 列被哪些行引用，RowIndice[ColPtr[c] .. ColPtr[c+1]) (大小: NumCol + 1 / NumNonZeros)
+    // 供增量映射从变化的低模顶点反查受影响的高模行
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix")
+    TArray<int32> ColPtr;
+
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix")
+    TArray<int32> RowIndice;
+
+    // 列重排表：重排后第 i 列对应模型输出中的第 ColPermutation[i] 个低模顶点，为空表示未重排
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix")
+    TArray<int32> ColPermutation;
+
+    // 当前存储格式，非 Full 时 ColIndice/Value 为空，数据在下面的压缩数组中
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    EMappingStorageMode StorageMode{EMappingStorageMode::Full};
+
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    TArray<uint16> CompactColIndice;
+
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    TArray<uint16> CompactValue16;
+
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    TArray<uint8> CompactValue8;
+
+    // 压缩时测得的单个权重最大绝对误差
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    float QuantizationMaxWeightError{0.0f};
+
+    // 压缩时测得的 max_row Σ|w - q(w)|，高模偏移误差 <= 该值 * 低模偏移最大长度
+    UPROPERTY(VisibleAnywhere, Category = "SparseMatrix|Compression")
+    float QuantizationErrorBound{0.0f};
+
 
     /*
     CSR, 三个数组, 对缓存友好
@@ -46,6 +127,121 @@ public:
      */
     void SetFromTriplet(const TArray<FTriplet> &Triplets);
 
+    /**
+     * @brief 流式构建：按行号递增逐行追加，直接写入 CSR 数组，不生成中间三元组列表
+     * BeginBuild 清空现有数据 (保留 NumRow/NumCol)，EndBuild 补齐剩余空行并完成与 SetFromTriplet 相同的收尾
+     * @param ReserveNonZeros 预估的非零元数量，用于一次性分配
+     */
+    void BeginBuild(int32 ReserveNonZeros = 0);
+    void BeginRow(int32 Row);
+    void AddEntry(int32 Col, float Weight);
+    void EndRow();
+    void EndBuild();
+
+    /**
+     * @brief 并行构建的合并步骤：把各任务填充的行块按 FirstRow 顺序拼接为完整矩阵
+     * 行块之间不得重叠，块间缺失的行记为空行。
+     * 目标数组按总非零元数一次性预留，此时所有块仍然存活，合并开始时的峰值约为矩阵本身的两倍；
+     * 每个块拷贝后立即释放，占用随合并进行回落 (逐块增长目标数组同样要在扩容时拷贝，峰值并不更低)
+     */
+    void SetFromRowBlocks(TArray<FSparseRowBlock> &&Blocks);
+
+    // 由 CSR 构建列到行的转置索引 (ColPtr/RowIndice)，列编号变化后需要重新构建
+    void BuildTranspose();
+
+    // 将每一行内的列按升序排列，使一行内的 gather 地址单调递增
+    void SortRowColumns();
+
+    /**
+     * @brief 烘焙时重排低模列以提升缓存局部性 (须在 Compress 之前调用)
+     * 按行顺序扫描，以列第一次被访问的先后作为新编号 (first-touch)，相邻高模行因此会从相邻的低模偏移中读取，
+     * 重排表记录在 ColPermutation 中，运行时通过 PermuteLowResOffsets 每帧把模型输出重排一次
+     */
+    void ReorderColumnsForLocality();
+
+    /**
+     * @brief 把模型输出的低模偏移按 ColPermutation 重排为矩阵列顺序
+     * @param Scratch 调用方持有的复用缓冲
+     * @return 未重排时直接返回输入，否则返回 Scratch
+     */
+    TConstArrayView<float> PermuteLowResOffsets(TConstArrayView<float> InModelOffsets, TArray<float> &Scratch) const;
+
+    // 定宽布局支持的最大行宽 (对应 K=1..8 的特化内核)
+    static constexpr int32 MaxFixedRowWidth = 8;
+
+    /**
+     * @brief 根据行宽分布选择存储布局
+     * 所有行宽都不超过 MaxFixedRowWidth，且补齐到最大行宽的零权重不超过原非零元的 1/4 时，
+     * 将 ColIndice/Value 补齐为定宽行 (ELL) 并记录 FixedRowWidth，映射时走编译期展开的特化内核。
+     * 补齐后的数组仍是合法的 CSR，其他读取 RowPtr 的代码不受影响。
+     */
+    void UpdateStorageLayout();
+
+    /**
+     * @brief 转换为压缩存储 (在 UpdateStorageLayout 之后调用)
+     * 量化时保持每行权重和不变，并把测得的误差写入 QuantizationMaxWeightError / QuantizationErrorBound
+     * @return 列数超过 16 位范围或权重不在 [0,1] 时返回 false，矩阵保持不变
+     */
+    bool Compress(EMappingStorageMode InMode);
+
     // 从低模映射到高模
     bool ApplyMapping(const TArray<FVector> &InLowResOffsets, TArray<FVector> &OutHighResOffsets) const;
+
+    /**
+     * @brief 单精度快速路径：直接消费模型输出的交错 float 缓冲 (x0,y0,z0,x1,...)，输出 float3
+     * 全程不做 double 转换，内层使用 VectorRegister (SSE/AVX/NEON) 做乘加
+     * @param InLowResOffsets 低模偏移，长度必须为 NumCol * 3
+     * @param OutHighResOffsets 高模偏移，调用方预先分配，长度必须为 NumRow
+     */
+    bool ApplyMapping(TConstArrayView<float> InLowResOffsets, TArrayView<FVector3f> OutHighResOffsets) const;
+
+    // 并行映射时每个任务默认至少处理的行数
+    static constexpr int32 DefaultMinRowsPerTask = 4096;
+
+    /**
+     * @brief 单精度快速路径的多线程版本
+     * 利用 RowPtr 前缀和按非零元数量均衡切分行区间，在 UE 任务系统 (ParallelFor) 上执行
+     * @param MinRowsPerTask 每个任务至少处理的行数，行数不足两个任务时直接串行，小服装不付调度开销
+     */
+    bool ApplyMappingParallel(TConstArrayView<float> InLowResOffsets, TArrayView<FVector3f> OutHighResOffsets, int32 MinRowsPerTask = DefaultMinRowsPerTask) const;
+
+    /**
+     * @brief 批量映射：多个共享同一映射资产的实例一次完成
+     * 矩阵数组 (RowPtr/ColIndice/Value) 按行分块只从内存流过一次，每块在缓存中被所有实例复用，每个非零元的索引和权重在各实例间共享
+     * @return 任一实例的输入输出尺寸不合法时返回 false，且不写入任何输出
+     */
+    bool ApplyMappingBatched(TConstArrayView<FMappingBatchItem> Items, int32 MinRowsPerTask = DefaultMinRowsPerTask) const;
+
+    /**
+     * @brief 增量映射：只重算受变化低模顶点影响的高模行
+     * 低模顶点相对 InOutAppliedLowResOffsets 的位移超过 ChangeThreshold 时视为变化，经转置索引找到引用它的行并只重算这些行。
+     * 未变化顶点沿用上次参与计算的值，因此高模误差不超过 ChangeThreshold * 行权重和，且不会随帧累积
+     * @param InLowResOffsets 本帧低模偏移 (矩阵列顺序)，长度 NumCol * 3
+     * @param InOutAppliedLowResOffsets 上次参与计算的低模偏移，变化的顶点会被更新为本帧值；长度不符 (如第一帧) 时执行完整映射并整体初始化
+     * @param InOutHighResOffsets 上一次的高模结果，只有受影响的行会被改写
+     * @param RowScratch 调用方持有的复用位图
+     * @return 本次重算的行数，输入非法时返回 INDEX_NONE
+     */
+    int32 ApplyMappingIncremental(TConstArrayView<float> InLowResOffsets, TArray<float> &InOutAppliedLowResOffsets, float ChangeThreshold,
+                                  TArrayView<FVector3f> InOutHighResOffsets, TBitArray<> &RowScratch) const;
+
+private:
+    // 构建完成后的收尾：行内列排序、选择存储布局、构建转置索引
+    void FinishBuild();
+
+    // 流式构建中的当前行，INDEX_NONE 表示不在行内
+    int32 BuildingRow{INDEX_NONE};
+
+    // 按非零元数量把行切分为若干任务区间，返回任务数 (>= 1)，OutRowBounds 大小为任务数 + 1
+    int32 ComputeRowPartition(int32 MinRowsPerTask, TArray<int32, TInlineAllocator<64>> &OutRowBounds) const;
+
+    // 第 i 个非零元的列索引，与存储格式无关
+    int32 GetColIndex(int32 NonZeroIndex) const;
+
+    // 计算 [RowBegin, RowEnd) 范围内的行，调用方保证输入输出尺寸合法
+    void ApplyMappingRows(const float *InLowResOffsets, FVector3f *OutHighResOffsets, int32 RowBegin, int32 RowEnd) const;
+
+    // 逐行量化完整精度权重，并测量单权重最大误差与行误差上界
+    template <typename TWeight>
+    void QuantizeWeights(TArray<TWeight> &OutWeights, float &OutMaxWeightError, float &OutErrorBound) const;
 };
\ No newline at end of file
@@ -31,6 +31,7 @@ public class ClothEditor : ModuleRules
                 "EditorStyle",     // 用于编辑器图标和样式
                 "PropertyEditor",  // 用于 SObjectPropertyEntryBox
                 "GeometryCore",    // 用于几何计算 (DynamicMesh)
+                "RenderCore",      // 覆盖映射数据前 FlushRenderingCommands
                 "WorkspaceMenuStructure",// 顶部菜单栏
                 "MeshConversion"
             }
@@ -1,11 +1,13 @@
 #include "KnnMeshMapping.h"
 
-#include "SparseMappingMatrix.h" // FTriplet, FSparseMappingMatrix
+#include "SparseMappingMatrix.h" // FSparseRowBlock, FSparseMappingMatrix
 #include "DynamicMesh/DynamicMesh3.h"
 #include "Widgets/Input/SSpinBox.h"
 #include "MeshDescriptionToDynamicMesh.h"
 #include "Spatial/PointHashGrid3.h"
 #include "MeshMappingAsset.h"
+#include "Async/ParallelFor.h"
+#include "RenderingThread.h"
 
 FKnnMappingStrategy::FKnnMappingStrategy(int32 k)
     : k_(k), kEpsilon_(1e-8f)
@@ -21,8 +23,6 @@ FSparseMappingMatrix FKnnMappingStrategy::BuildMappingMatrix(const UE::Geometry:
 {
     // [修正] Row 必须是高模顶点数，Col 必须是低模顶点数
     FSparseMappingMatrix mappingMatrix(HighPolyMesh->MaxVertexID(), LowPolyMesh->MaxVertexID());
-    TArray<FTriplet> triplets;
-    triplets.Reserve(HighPolyMesh->VertexCount() * k_);
 
     // --- Step 1. 在【低模】上建立空间索引 (我们要去低模里找点) ---
     FBox bounds = FBox(EForceInit::ForceInit);
@@ -43,61 +43,80 @@ FSparseMappingMatrix FKnnMappingStrategy::BuildMappingMatrix(const UE::Geometry:
         grid.InsertPointUnsafe(vtxId, pos);
     }
 
-    // --- Step 2. 遍历【高模】查询K近邻并计算权重 ---
-    for (int32 highId : HighPolyMesh->VertexIndicesItr())
-    {
-        FVector3d queryPos = HighPolyMesh->GetVertex(highId);
-
-        TArray<int32> neighbors;
-        TArray<double> distSq;
-        neighbors.Reserve(k_);
-
-        double radius = cellSize;
-        while (neighbors.Num() < k_ && radius < diagonal)
-        {
-            grid.EnumeratePointsInBall(queryPos, radius,
-                [&](int32 lowId) {
-                    return (queryPos - (FVector3d)LowPolyMesh->GetVertex(lowId)).SquaredLength();
-                },
-                [&](int32 lowId, double d2) {
-                    if (neighbors.Num() < k_)
-                    {
-                        neighbors.Add(lowId);
-                        distSq.Add(d2);
-                        return true; // continue
-                    }
-                    return false;
-                });
-            radius *= 2.0;
-        }
-
-        if (neighbors.Num() == 0)
-        {
-            continue;
-        }
-
-        // --- Step 3. 计算归一化权重 ---
-        double sumW = 0;
-        TArray<double> weights;
-        weights.Reserve(neighbors.Num());
+    // --- Step 2. 按高模行区间并行查询K近邻，每个任务把结果逐行追加到自己的行块 ---
+    // 行按顺序产生，直接写成 CSR 行块，不再生成 VertexCount * K 个三元组
+    const int32 numHighVert = HighPolyMesh->MaxVertexID();
+    const int32 numBlocks = FMath::DivideAndRoundUp(numHighVert, kRowsPerBlock);
+    TArray<FSparseRowBlock> blocks;
+    blocks.SetNum(numBlocks);
 
-        for (double d2 : distSq)
+    ParallelFor(numBlocks, [&](int32 blockIndex)
         {
-            double w = 1.0 / (d2 + kEpsilon_);
-            weights.Add(w);
-            sumW += w;
-        }
-
-        for (int32 j = 0; j < neighbors.Num(); ++j)
-        {
-            float normalized = static_cast<float>(weights[j] / sumW);
-            // [修正] Row = 高模索引, Col = 低模索引, Value = 权重
-            triplets.Emplace(highId, neighbors[j], normalized);
-        }
-    }
-
-    // --- Step 4. 构建CSR矩阵 ---
-    mappingMatrix.SetFromTriplet(triplets);
+            const int32 rowBegin = blockIndex * kRowsPerBlock;
+            const int32 rowEnd = FMath::Min(rowBegin + kRowsPerBlock, numHighVert);
+            FSparseRowBlock& block = blocks[blockIndex];
+            block = FSparseRowBlock(rowBegin, rowEnd - rowBegin, (rowEnd - rowBegin) * k_);
+
+            TArray<int32> neighbors;
+            TArray<double> distSq;
+            neighbors.Reserve(k_);
+            distSq.Reserve(k_);
+
+            for (int32 highId = rowBegin; highId < rowEnd; ++highId)
+            {
+                if (!HighPolyMesh->IsVertex(highId))
+                {
+                    continue;
+                }
+                FVector3d queryPos = HighPolyMesh->GetVertex(highId);
+
+                neighbors.Reset();
+                distSq.Reset();
+
+                double radius = cellSize;
+                while (neighbors.Num() < k_ && radius < diagonal)
+                {
+                    grid.EnumeratePointsInBall(queryPos, radius,
+                        [&](int32 lowId) {
+                            return (queryPos - (FVector3d)LowPolyMesh->GetVertex(lowId)).SquaredLength();
+                        },
+                        [&](int32 lowId, double d2) {
+                            if (neighbors.Num() < k_)
+                            {
+                                neighbors.Add(lowId);
+                                distSq.Add(d2);
+                                return true; // continue
+                            }
+                            return false;
+                        });
+                    radius *= 2.0;
+                }
+
+                if (neighbors.Num() == 0)
+                {
+                    continue;
+                }
+
+                // --- Step 3. 计算归一化权重 ---
+                double sumW = 0;
+                for (double d2 : distSq)
+                {
+                    sumW += 1.0 / (d2 + kEpsilon_);
+                }
+
+                // [修正] Row = 高模索引, Col = 低模索引, Value = 权重
+                block.BeginRow(highId);
+                for (int32 j = 0; j < neighbors.Num(); ++j)
+                {
+                    const double w = 1.0 / (distSq[j] + kEpsilon_);
+                    block.AddEntry(neighbors[j], static_cast<float>(w / sumW));
+                }
+                block.EndRow();
+            }
+        });
+
+    // --- Step 4. 按顺序拼接行块，构建CSR矩阵 ---
+    mappingMatrix.SetFromRowBlocks(MoveTemp(blocks));
     return mappingMatrix;
 }
 
@@ -136,7 +155,9 @@ bool FKnnMappingStrategy::GenerateMapping(
     FSparseMappingMatrix computedMatrix = BuildMappingMatrix(&highDynMesh, &lowDynMesh);
 
     // 5. 将结果写入资产，并标记为“已修改”(带上星号)，提示用户保存
-    OutAsset->MappingData = computedMatrix;
+    // 资产可能正被组件使用，渲染线程上的映射命令直接引用 MappingData，覆盖前先等它们执行完
+    FlushRenderingCommands();
+    OutAsset->MappingData = MoveTemp(computedMatrix);
     OutAsset->MarkPackageDirty();
 
     return true;
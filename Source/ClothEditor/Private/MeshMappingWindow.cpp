@@ -4,6 +4,7 @@
 #include "Widgets/Layout/SBox.h"
 #include "Widgets/Input/SButton.h"
 #include "Widgets/Input/SEditableTextBox.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "Widgets/Text/STextBlock.h"
 #include "PropertyCustomizationHelpers.h" // 包含 SObjectPropertyEntryBox
 #include "AssetToolsModule.h"
@@ -19,6 +20,12 @@ void SMeshMappingWindow::Construct(const FArguments &InArgs)
     AvailableStrategies.Add(MakeShared<FKnnMappingStrategy>(3)); // K=3
     CurrentStrategy = AvailableStrategies[0];
 
+    // 存储格式选项，默认完整精度
+    StorageModeOptions.Add(MakeShared<EMappingStorageMode>(EMappingStorageMode::Full));
+    StorageModeOptions.Add(MakeShared<EMappingStorageMode>(EMappingStorageMode::Compact16));
+    StorageModeOptions.Add(MakeShared<EMappingStorageMode>(EMappingStorageMode::Compact8));
+    CurrentStorageMode = StorageModeOptions[0];
+
     // 2. 初始化默认路径
     SaveFolderPath = TEXT("/Game/ClothData");
     SaveFileName = TEXT("NewMappingAsset");
@@ -55,6 +62,18 @@ void SMeshMappingWindow::Construct(const FArguments &InArgs)
          + SVerticalBox::Slot().AutoHeight().Padding(5)
                [SAssignNew(DynamicSettingsContainer, SBox)]
 
+         // --- 存储格式 ---
+         + SVerticalBox::Slot().AutoHeight().Padding(5)
+               [SNew(SHorizontalBox) + SHorizontalBox::Slot().AutoWidth().Padding(0, 5, 10, 0).VAlign(VAlign_Center)[SNew(STextBlock).Text(LOCTEXT("StorageMode", "Storage Format:"))] + SHorizontalBox::Slot().FillWidth(1.0f)[SNew(SComboBox<TSharedPtr<EMappingStorageMode>>).OptionsSource(&StorageModeOptions).OnGenerateWidget(this, &SMeshMappingWindow::GenerateStorageModeComboItem).OnSelectionChanged(this, &SMeshMappingWindow::OnStorageModeChanged).ToolTipText(LOCTEXT("StorageModeTip", "Compact formats quantize weights; the measured error bound is logged and shown on the asset"))[SNew(STextBlock).Text(this, &SMeshMappingWindow::GetCurrentStorageModeLabel)]]]
+
+         // --- 列重排 ---
+         + SVerticalBox::Slot().AutoHeight().Padding(5)
+               [SNew(SCheckBox)
+                    .IsChecked_Lambda([this]() { return bReorderColumns ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+                    .OnCheckStateChanged_Lambda([this](ECheckBoxState NewState) { bReorderColumns = NewState == ECheckBoxState::Checked; })
+                    .ToolTipText(LOCTEXT("ReorderTip", "Renumber low poly vertices in first-use order so neighbouring high poly vertices gather from neighbouring memory"))
+                    [SNew(STextBlock).Text(LOCTEXT("Reorder", "Reorder for cache locality"))]]
+
          // --- 分割线 ---
          + SVerticalBox::Slot().AutoHeight().Padding(0, 10)
                [SNew(SSeparator)]
@@ -123,6 +142,24 @@ FText SMeshMappingWindow::GetCurrentStrategyLabel() const
     return CurrentStrategy.IsValid() ? FText::FromString(CurrentStrategy->GetStrategyName()) : FText::FromString("None");
 }
 
+void SMeshMappingWindow::OnStorageModeChanged(TSharedPtr<EMappingStorageMode> NewItem, ESelectInfo::Type SelectInfo)
+{
+    if (NewItem.IsValid())
+    {
+        CurrentStorageMode = NewItem;
+    }
+}
+
+TSharedRef<SWidget> SMeshMappingWindow::GenerateStorageModeComboItem(TSharedPtr<EMappingStorageMode> InItem)
+{
+    return SNew(STextBlock).Text(StaticEnum<EMappingStorageMode>()->GetDisplayNameTextByValue(static_cast<int64>(*InItem)));
+}
+
+FText SMeshMappingWindow::GetCurrentStorageModeLabel() const
+{
+    return CurrentStorageMode.IsValid() ? StaticEnum<EMappingStorageMode>()->GetDisplayNameTextByValue(static_cast<int64>(*CurrentStorageMode)) : FText::FromString("None");
+}
+
 // --------------------------------------------------------
 // 输出设置回调
 // --------------------------------------------------------
@@ -178,6 +215,18 @@ FReply SMeshMappingWindow::OnBakeClicked()
 
         if (bSuccess)
         {
+            // 重排必须在压缩之前
+            if (bReorderColumns)
+            {
+                NewAsset->MappingData.ReorderColumnsForLocality();
+            }
+
+            // 按选择的格式压缩映射矩阵，测得的误差上界会写入日志和资产 Details 面板
+            if (CurrentStorageMode.IsValid() && !NewAsset->MappingData.Compress(*CurrentStorageMode))
+            {
+                UE_LOG(LogTemp, Warning, TEXT("Bake: 映射矩阵压缩失败，保留完整精度存储"));
+            }
+
             // 6. 标记脏位并通知编辑器
             NewAsset->MarkPackageDirty();
             FAssetRegistryModule::AssetCreated(NewAsset);
@@ -1,7 +1,7 @@
 #include "SurfaceProjection.h"
 
 // --- 包含实现所需的UE模块 ---
-#include "SparseMappingMatrix.h" // 用于 FTriplet 和 FSparseMappingMatrix
+#include "SparseMappingMatrix.h" // 用于 FSparseMappingMatrix
 #include "DynamicMesh/DynamicMesh3.h"
 #include "DynamicMesh/DynamicMeshAABBTree3.h"
 #include "VectorTypes.h" // FVector3d, FIntVector3
@@ -20,8 +20,9 @@ FSparseMappingMatrix FSurfaceProjection::BuildMappingMatrix(const FDynamicMesh3
     const int32 NumLowVert = LowPolyMesh->MaxVertexID();
     const int32 NumHighVert = HighPolyMesh->MaxVertexID();
 
-    TArray<FTriplet> Triplets;
-    Triplets.Reserve(NumLowVert * 3);
+    // 行按低模顶点顺序产生，直接流式写入 CSR，不生成中间三元组列表
+    FSparseMappingMatrix ResultMatrix{NumLowVert, NumHighVert};
+    ResultMatrix.BeginBuild(NumLowVert * 3);
 
     for (int32 VertexIndex = 0; VertexIndex < NumLowVert; ++VertexIndex)
     {
@@ -49,13 +50,14 @@ FSparseMappingMatrix FSurfaceProjection::BuildMappingMatrix(const FDynamicMesh3
 
             const FIndex3i HighTriIndices = HighPolyMesh->GetTriangle(NearestTriID);
 
-            Triplets.Add(FTriplet(VertexIndex, HighTriIndices.A, (float)BaryCoord.X));
-            Triplets.Add(FTriplet(VertexIndex, HighTriIndices.B, (float)BaryCoord.Y));
-            Triplets.Add(FTriplet(VertexIndex, HighTriIndices.C, (float)BaryCoord.Z));
+            ResultMatrix.BeginRow(VertexIndex);
+            ResultMatrix.AddEntry(HighTriIndices.A, (float)BaryCoord.X);
+            ResultMatrix.AddEntry(HighTriIndices.B, (float)BaryCoord.Y);
+            ResultMatrix.AddEntry(HighTriIndices.C, (float)BaryCoord.Z);
+            ResultMatrix.EndRow();
         }
     }
-    FSparseMappingMatrix ResultMatrix{NumLowVert, NumHighVert};
-    ResultMatrix.SetFromTriplet(Triplets);
+    ResultMatrix.EndBuild();
     return ResultMatrix;
 }
 
@@ -23,4 +23,6 @@ public:
 private:
     int32 k_;
     const float kEpsilon_;
+    // 并行构建时每个行块包含的高模顶点数
+    static constexpr int32 kRowsPerBlock = 4096;
 };
\ No newline at end of file
@@ -8,6 +8,7 @@
 
 class USkeletalMesh;
 class SEditableTextBox;
+enum class EMappingStorageMode : uint8;
 
 /**
  * SMeshMappingWindow
@@ -38,6 +39,11 @@ private:
     TSharedRef<SWidget> GenerateStrategyComboItem(TSharedPtr<IMeshMappingStrategy> InItem);
     FText GetCurrentStrategyLabel() const;
 
+    // 存储格式选择回调
+    void OnStorageModeChanged(TSharedPtr<EMappingStorageMode> NewItem, ESelectInfo::Type SelectInfo);
+    TSharedRef<SWidget> GenerateStorageModeComboItem(TSharedPtr<EMappingStorageMode> InItem);
+    FText GetCurrentStorageModeLabel() const;
+
     // 文本框回调
     void OnOutputPathChanged(const FText& NewText);
     void OnOutputNameChanged(const FText& NewText);
@@ -65,4 +71,11 @@ private:
     // 策略数据源
     TArray<TSharedPtr<IMeshMappingStrategy>> AvailableStrategies;
     TSharedPtr<IMeshMappingStrategy> CurrentStrategy;
+
+    // 存储格式数据源
+    TArray<TSharedPtr<EMappingStorageMode>> StorageModeOptions;
+    TSharedPtr<EMappingStorageMode> CurrentStorageMode;
+
+    // 是否在烘焙时重排低模列以提升缓存局部性 (可选，默认关闭)
+    bool bReorderColumns{false};
 };
\ No newline at end of file